@@ -0,0 +1,102 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+// Steps and rejections of each step size controller, on problems where the
+// elementary controller oscillates between accepting and rejecting
+
+typedef vZ::EquationSystem<2> Y;
+typedef Y (*F)(double, const Y&);
+
+// y'' = -100*y, whose relative tolerance swings with |y|
+Y
+oscillator(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = -100.0*y[0];
+  return dydx;
+}
+
+// Van der Pol, mu == 5
+Y
+vanDerPol(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = 5.0*(1.0 - y[0]*y[0])*y[1] - y[0];
+  return dydx;
+}
+
+// y' = -500*(y - cos(x)) - sin(x), where the step size is limited by
+// stability rather than accuracy
+Y
+stiff(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = -500.0*(y[0] - std::cos(x)) - std::sin(x);
+  dydx[1] = 0.0;
+  return dydx;
+}
+
+template <typename Integrator>
+void
+run(const char* name, F f, double y0, double x_final, double tol)
+{
+  static const char* names[] = { "Elementary", "PI", "H211b", "H312b" };
+  const vZ::StepController controllers[] = {
+    vZ::StepController::elementary(),
+    vZ::StepController::pi(),
+    vZ::StepController::h211(),
+    vZ::StepController::h312(),
+  };
+
+  Y y;
+  y[0] = y0;
+  y[1] = 0.0;
+
+  std::cout << name << ":" << std::endl;
+  for (unsigned int i = 0; i < 4; ++i) {
+    Integrator integrator(f);
+    integrator.controller(controllers[i]).tol(tol).y(y).x(0.0).h(0.01);
+    integrator.integrate(x_final);
+
+    std::cout << "  " << std::left << std::setw(12) << names[i]
+              << std::right << std::setw(6) << integrator.iterations()
+              << " steps, " << std::setw(4) << integrator.rejections()
+              << " rejections" << std::endl;
+  }
+}
+
+int
+main()
+{
+  typedef vZ::GenericDP45Integrator<Y, F> DP45;
+  typedef vZ::GenericBS23Integrator<Y, F> BS23;
+
+  run<DP45>("DP45, oscillator", oscillator, 1.0, 20.0, 1e-8);
+  run<DP45>("DP45, Van der Pol", vanDerPol, 2.0, 20.0, 1e-6);
+  run<DP45>("DP45, stiff", stiff, 1.0, 10.0, 1e-6);
+  run<BS23>("BS23, stiff", stiff, 1.0, 10.0, 1e-4);
+  return EXIT_SUCCESS;
+}
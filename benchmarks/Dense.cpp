@@ -0,0 +1,118 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+// Time to produce the solution of the Lorenz system at many output points,
+// by integrating to each of them vs. interpolating
+
+typedef vZ::EquationSystem<3> Y;
+
+Y
+lorenz(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = 10.0*(y[1] - y[0]);
+  dydx[1] = y[0]*(28.0 - y[2]) - y[1];
+  dydx[2] = y[0]*y[1] - 8.0/3.0*y[2];
+  return dydx;
+}
+
+typedef vZ::GenericDP45Integrator<Y, Y (*)(double, const Y&)> DP45;
+
+static const std::size_t outputs = 10000;
+static const double tol = 1e-8, x_final = 20.0;
+
+// Sums the outputs of the grid integrate()
+class Sum
+{
+public:
+  explicit Sum(double& sum) : m_sum(sum) { }
+
+  void operator()(double, const Y& y) { m_sum += y[0]; }
+
+private:
+  double& m_sum;
+};
+
+double
+seconds(std::clock_t start)
+{
+  return double(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+int
+main()
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 1.0;
+  y0[2] = 1.0;
+
+  // Sum the outputs, so neither loop can be optimized away
+  double integrated = 0.0, interpolated = 0.0, observed = 0.0;
+
+  std::clock_t start = std::clock();
+  DP45 clipped(lorenz);
+  clipped.tol(tol).y(y0).x(0.0).h(0.01);
+  for (std::size_t i = 1; i <= outputs; ++i) {
+    clipped.integrate(x_final*i/outputs);
+    integrated += clipped.y()[0];
+  }
+  double clippedTime = seconds(start);
+
+  start = std::clock();
+  DP45 dense(lorenz);
+  dense.tol(tol).y(y0).x(0.0).h(0.01);
+  Y y;
+  for (std::size_t i = 1; i <= outputs; ++i) {
+    double x = x_final*i/outputs;
+    while (dense.x() < x) {
+      dense.advance(x_final);
+    }
+    dense.interpolate(x, y);
+    interpolated += y[0];
+  }
+  double denseTime = seconds(start);
+
+  start = std::clock();
+  DP45 grid(lorenz);
+  grid.tol(tol).y(y0).x(0.0).h(0.01);
+  unsigned int saved = grid.integrate(x_final, x_final/outputs,
+                                      Sum(observed));
+  double gridTime = seconds(start);
+
+  std::cout << std::setprecision(4)
+            << outputs << " outputs:" << std::endl
+            << "  integrate(x):   " << clipped.iterations() << " steps, "
+            << clippedTime << " s" << std::endl
+            << "  interpolate(x): " << dense.iterations() << " steps, "
+            << denseTime << " s" << std::endl
+            << "  Output grid:    " << grid.iterations() << " steps, "
+            << gridTime << " s (" << saved << " steps saved)" << std::endl
+            << "  Mean outputs:   " << integrated/outputs << ", "
+            << interpolated/outputs << ", " << observed/outputs << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,126 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Time to integrate an ensemble of Lorenz systems, each with a different
+// rho, one trajectory at a time vs. in SIMD lanes
+
+typedef vZ::EquationSystem<3> Y;
+
+class Lorenz
+{
+public:
+  explicit Lorenz(const std::vector<double>& rho) : m_rho(rho), m_i(0) { }
+
+  // One trajectory
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    evaluate(m_rho[m_i], y, dydx);
+    return dydx;
+  }
+
+  // A block of trajectories, starting with i
+  template <typename X, typename Block>
+  void
+  operator()(const X& x, const Block& y, Block& dydx, std::size_t i) const
+  {
+    evaluate(X::load(&m_rho[i]), y, dydx);
+  }
+
+  Lorenz& trajectory(std::size_t i) { m_i = i; return *this; }
+
+private:
+  std::vector<double> m_rho;
+  std::size_t m_i;
+
+  template <typename Rho, typename State>
+  static void
+  evaluate(const Rho& rho, const State& y, State& dydx)
+  {
+    dydx[0] = Rho(10.0)*(y[1] - y[0]);
+    dydx[1] = y[0]*(rho - y[2]) - y[1];
+    dydx[2] = y[0]*y[1] - Rho(8.0/3.0)*y[2];
+  }
+};
+
+static const std::size_t size = 4096;
+static const double tol = 1e-8, x_final = 10.0;
+
+double
+seconds(std::clock_t start)
+{
+  return double(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+int
+main()
+{
+  std::vector<double> rho(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    rho[i] = 20.0 + 10.0*i/size;
+  }
+  Lorenz f(rho);
+
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 1.0;
+  y0[2] = 1.0;
+
+  // One integrator per trajectory
+  unsigned long steps = 0;
+  std::clock_t start = std::clock();
+  for (std::size_t i = 0; i < size; ++i) {
+    f.trajectory(i);
+    vZ::GenericDP45Integrator<Y, Lorenz> single(f);
+    single.tol(tol).y(y0).x(0.0).h(0.01);
+    single.integrate(x_final);
+    steps += single.iterations();
+  }
+  double singleTime = seconds(start);
+
+  // The whole ensemble
+  typedef vZ::GenericEnsembleIntegrator<Y, vZ::DP45Tableau<Y>, Lorenz>
+    Ensemble;
+  Ensemble ensemble(f, size);
+  ensemble.tol(tol).xAll(0.0).hAll(0.01);
+  for (std::size_t i = 0; i < size; ++i) {
+    ensemble.y(i, y0);
+  }
+
+  start = std::clock();
+  ensemble.integrate(x_final);
+  double ensembleTime = seconds(start);
+
+  std::cout << std::setprecision(4)
+            << size << " trajectories, " << steps << " steps, "
+            << Ensemble::s_lanes << " lanes:" << std::endl
+            << "  One at a time: " << singleTime << " s" << std::endl
+            << "  Ensemble:      " << ensembleTime << " s" << std::endl
+            << "  Speedup:       " << singleTime/ensembleTime << std::endl;
+  return EXIT_SUCCESS;
+}
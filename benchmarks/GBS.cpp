@@ -0,0 +1,129 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#if __cplusplus >= 201103L
+#  include <chrono>
+#endif
+
+// Evaluations and wall-clock time for GBS extrapolation at tight
+// tolerances, against DP45 and DOP853, and with its rows computed on a
+// thread pool, on a gravitational N-body problem whose f is expensive
+// enough to share out
+
+static const std::size_t N = 32;
+static const double softening = 1e-2;
+
+typedef vZ::Vector<3> V;
+typedef vZ::EquationSystem<2*N, V> Y;
+typedef Y (*F)(double, const Y&);
+
+// Positions in y[0..N), velocities in y[N..2*N), unit masses and G == 1/N
+Y
+nbody(double, const Y& y)
+{
+  Y dydx;
+  for (std::size_t i = 0; i < N; ++i) {
+    dydx[i] = y[N + i];
+    dydx[N + i] = V(0.0, 0.0, 0.0);
+  }
+  for (std::size_t i = 0; i < N; ++i) {
+    for (std::size_t j = i + 1; j < N; ++j) {
+      V d = y[j] - y[i];
+      double r2 = dot(d, d) + softening*softening;
+      V a = d/(N*r2*std::sqrt(r2));
+      dydx[N + i] += a;
+      dydx[N + j] -= a;
+    }
+  }
+  return dydx;
+}
+
+// A slightly perturbed ring, rotating near its circular speed
+Y
+initial()
+{
+  static const double pi = 3.14159265358979323846;
+  Y y;
+  for (std::size_t i = 0; i < N; ++i) {
+    double theta = 2.0*pi*i/N, r = 1.0 + 0.05*std::sin(3.0*theta);
+    y[i] = V(r*std::cos(theta), r*std::sin(theta), 0.01*std::cos(theta));
+    y[N + i] = V(-0.5*std::sin(theta), 0.5*std::cos(theta), 0.0);
+  }
+  return y;
+}
+
+// Wall-clock time, since std::clock() adds up every thread's time
+double
+seconds()
+{
+#if __cplusplus >= 201103L
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+#else
+  return double(std::clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+template <typename Integrator>
+void
+run(const char* name, Integrator& integrator, double tol)
+{
+  integrator.tol(tol).y(initial()).x(0.0).h(0.0);
+
+  double start = seconds();
+  integrator.integrate(5.0);
+  double time = seconds() - start;
+
+  std::cout << "  " << std::left << std::setw(14) << name << std::right
+            << std::setw(7) << integrator.iterations() << " steps,"
+            << std::setw(8) << integrator.evaluations() << " evaluations, "
+            << std::fixed << std::setprecision(1) << 1000.0*time << " ms"
+            << std::endl;
+}
+
+int
+main()
+{
+  vZ::ThreadPool pool;
+
+  for (int i = 8; i <= 12; i += 2) {
+    double tol = std::pow(10.0, -i);
+    std::cout << std::scientific << std::setprecision(0) << "tol " << tol
+              << ":" << std::endl;
+
+    vZ::GenericDP45Integrator<Y, F> dp45(nbody);
+    run("DP45", dp45, tol);
+    vZ::GenericDOP853Integrator<Y, F> dop853(nbody);
+    run("DOP853", dop853, tol);
+    vZ::GenericGBSIntegrator<Y, F> gbs(nbody);
+    run("GBS", gbs, tol);
+
+    vZ::GenericGBSIntegrator<Y, F> parallel(nbody);
+    parallel.threadPool(&pool);
+    std::cout << "  " << pool.threads() << " threads:" << std::endl;
+    run("  GBS", parallel, tol);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,101 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+// Cost of many short trajectories of y'' = -k*y, with k spread over four
+// orders of magnitude, from a hand-picked h vs. an automatic one
+
+typedef vZ::EquationSystem<2> Y;
+
+class Oscillator
+{
+public:
+  explicit Oscillator(double k) : m_k(k) { }
+
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    dydx[0] = y[1];
+    dydx[1] = -m_k*y[0];
+    return dydx;
+  }
+
+private:
+  double m_k;
+};
+
+typedef vZ::GenericDP45Integrator<Y, Oscillator> DP45;
+
+static const std::size_t size = 4096;
+static const double tol = 1e-8, x_final = 0.1;
+
+double
+seconds(std::clock_t start)
+{
+  return double(std::clock() - start)/CLOCKS_PER_SEC;
+}
+
+// h == 0 chooses it automatically
+void
+run(const char* name, double h)
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+
+  unsigned int iterations = 0, rejections = 0, evaluations = 0;
+  double sum = 0.0;
+
+  std::clock_t start = std::clock();
+  for (std::size_t i = 0; i < size; ++i) {
+    DP45 integrator(Oscillator(std::pow(10.0, 4.0*i/size)));
+    integrator.tol(tol).y(y0).x(0.0).h(h);
+    integrator.integrate(x_final);
+
+    iterations  += integrator.iterations();
+    rejections  += integrator.rejections();
+    evaluations += integrator.evaluations();
+    sum         += integrator.y()[0];
+  }
+  double time = seconds(start);
+
+  std::cout << "  " << std::left << std::setw(13) << name << std::right
+            << std::setw(7) << iterations << " steps, "
+            << std::setw(6) << rejections << " rejections, "
+            << std::setw(8) << evaluations << " evaluations, "
+            << time << " s (mean " << sum/size << ")" << std::endl;
+}
+
+int
+main()
+{
+  std::cout << std::setprecision(4)
+            << size << " trajectories to x = " << x_final << ":"
+            << std::endl;
+  run("h = 0.06:", 0.06);
+  run("Automatic h:", 0.0);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,123 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#if __cplusplus >= 201103L
+#  include <chrono>
+#endif
+
+// Time to integrate an ensemble of Lorenz systems, each with a different
+// rho, with a new integrator per trajectory vs. ParallelEnsemble
+
+typedef vZ::EquationSystem<3> Y;
+
+class Lorenz
+{
+public:
+  explicit Lorenz(double rho = 28.0) : m_rho(rho) { }
+
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    dydx[0] = 10.0*(y[1] - y[0]);
+    dydx[1] = y[0]*(m_rho - y[2]) - y[1];
+    dydx[2] = y[0]*y[1] - 8.0/3.0*y[2];
+    return dydx;
+  }
+
+private:
+  double m_rho;
+};
+
+typedef vZ::GenericDP45Integrator<Y, Lorenz> DP45;
+
+static const std::size_t size = 4096;
+static const double tol = 1e-8, x_final = 10.0;
+
+// Wall-clock time, since std::clock() adds up every thread's time
+double
+seconds()
+{
+#if __cplusplus >= 201103L
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+#else
+  return double(std::clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+double
+parallel(const DP45& prototype, const std::vector<Y>& y0,
+         const std::vector<double>& rho, unsigned int threads)
+{
+  vZ::ParallelEnsemble<DP45> ensemble(prototype);
+  ensemble.x(0.0).h(0.01).threads(threads);
+
+  double start = seconds();
+  ensemble.integrate(y0, rho, x_final);
+  return seconds() - start;
+}
+
+int
+main()
+{
+  std::vector<double> rho(size);
+  std::vector<Y> y0(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    rho[i] = 20.0 + 10.0*i/size;
+    y0[i][0] = 1.0;
+    y0[i][1] = 1.0;
+    y0[i][2] = 1.0;
+  }
+
+  DP45 prototype((Lorenz()));
+  prototype.tol(tol);
+
+  // A new integrator per trajectory
+  double start = seconds();
+  for (std::size_t i = 0; i < size; ++i) {
+    DP45 single((Lorenz(rho[i])));
+    single.tol(tol).y(y0[i]).x(0.0).h(0.01);
+    single.integrate(x_final);
+  }
+  double singleTime = seconds() - start;
+
+  unsigned int threads = vZ::ParallelEnsemble<DP45>(prototype).threads();
+  double serialTime = parallel(prototype, y0, rho, 1);
+  double parallelTime = parallel(prototype, y0, rho, threads);
+
+  std::cout << std::setprecision(4)
+            << size << " trajectories:" << std::endl
+            << "  One integrator per trajectory: " << singleTime << " s"
+            << std::endl
+            << "  One thread:" << std::endl
+            << "    ParallelEnsemble:  " << serialTime << " s" << std::endl
+            << "  " << threads << " threads:" << std::endl
+            << "    ParallelEnsemble:  " << parallelTime << " s" << std::endl
+            << "    Speedup:           " << singleTime/parallelTime
+            << std::endl;
+  return EXIT_SUCCESS;
+}
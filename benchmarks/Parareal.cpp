@@ -0,0 +1,154 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#if __cplusplus >= 201103L
+#  include <chrono>
+#endif
+
+// Parareal with a coarse RK4 and a fine DP45, against DP45 alone, on a ring
+// of coupled van der Pol oscillators: convergence per iteration, the
+// speedup it would give with a thread per slice, and the speedup measured
+// on this machine's threads
+
+static const std::size_t N = 16;
+static const double coupling = 0.2;
+
+typedef vZ::EquationSystem<2*N> Y;
+typedef Y (*F)(double, const Y&);
+typedef vZ::GenericRK4Integrator<Y, F>  Coarse;
+typedef vZ::GenericDP45Integrator<Y, F> Fine;
+
+// Positions in y[0..N), velocities in y[N..2*N)
+Y
+vanDerPol(double, const Y& y)
+{
+  Y dydx;
+  for (std::size_t i = 0; i < N; ++i) {
+    double u = y[i], v = y[N + i];
+    double left = y[(i + N - 1)%N], right = y[(i + 1)%N];
+    dydx[i] = v;
+    dydx[N + i] = (1.0 - u*u)*v - u + coupling*(left - 2.0*u + right);
+  }
+  return dydx;
+}
+
+Y
+initial()
+{
+  static const double pi = 3.14159265358979323846;
+  Y y;
+  for (std::size_t i = 0; i < N; ++i) {
+    y[i] = 2.0*std::cos(2.0*pi*i/N);
+    y[N + i] = 0.0;
+  }
+  return y;
+}
+
+double
+distance(const Y& u, const Y& v)
+{
+  double max = 0.0;
+  for (std::size_t i = 0; i < 2*N; ++i) {
+    max = std::max(max, std::abs(u[i] - v[i]));
+  }
+  return max;
+}
+
+Coarse
+coarse()
+{
+  Coarse integrator(vanDerPol);
+  integrator.h(0.5);
+  return integrator;
+}
+
+Fine
+fine(double tol)
+{
+  Fine integrator(vanDerPol);
+  integrator.tol(tol);
+  return integrator;
+}
+
+// Wall-clock time, since std::clock() adds up every thread's time
+double
+seconds()
+{
+#if __cplusplus >= 201103L
+  using namespace std::chrono;
+  return duration<double>(steady_clock::now().time_since_epoch()).count();
+#else
+  return double(std::clock())/CLOCKS_PER_SEC;
+#endif
+}
+
+int
+main()
+{
+  static const double tol = 1e-12, x_final = 20.0;
+  vZ::ThreadPool pool;
+
+  Fine sequential = fine(tol);
+  sequential.y(initial()).x(0.0).h(0.0);
+  double start = seconds();
+  sequential.integrate(x_final);
+  double sequentialTime = seconds() - start;
+
+  std::cout << "DP45:  " << sequential.evaluations() << " evaluations, "
+            << std::fixed << std::setprecision(1) << 1000.0*sequentialTime
+            << " ms" << std::endl
+            << "Parareal, RK4 with h == 0.5, on " << pool.threads()
+            << " threads:" << std::endl;
+
+  for (unsigned int slices = 16; slices <= 128; slices *= 2) {
+    vZ::Parareal<Coarse, Fine> parareal(coarse(), fine(tol));
+    parareal.slices(slices).tol(1e-9).threadPool(&pool).x(0.0);
+
+    start = seconds();
+    parareal.integrate(initial(), x_final);
+    double time = seconds() - start;
+
+    std::cout << "  " << std::setw(3) << slices << " slices: "
+              << parareal.iterations() << " iterations, changes"
+              << std::scientific << std::setprecision(1);
+    for (unsigned int k = 0; k < parareal.iterations(); ++k) {
+      std::cout << " " << parareal.change(k);
+    }
+    double ideal = double(sequential.evaluations())
+                   /parareal.criticalEvaluations();
+    std::cout << std::endl
+              << "              error "
+              << distance(parareal.y(), sequential.y()) << ", "
+              << parareal.evaluations() << " evaluations, "
+              << parareal.criticalEvaluations() << " on the critical path"
+              << std::endl
+              << std::fixed << std::setprecision(2)
+              << "              speedup " << ideal
+              << " with a thread per slice, " << sequentialTime/time
+              << " measured" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+// Steps, evaluations of f, error, and time for DPRKN6 on a second-order
+// system, against DP45 on the same system split by hand into first-order
+// form.  The system is a Fermi-Pasta-Ulam-Tsingou chain of N masses with
+// cubic springs and fixed ends, integrated over [0, 100].
+
+static const std::size_t N = 64;
+static const double beta = 1.0;
+
+typedef vZ::EquationSystem<N> Y;
+typedef vZ::EquationSystem<2*N> Split;
+
+Y
+chain(double, const Y& y)
+{
+  Y r;
+  for (std::size_t i = 0; i < N; ++i) {
+    double left  = y[i] - (i == 0     ? 0.0 : y[i - 1]);
+    double right = (i == N - 1 ? 0.0 : y[i + 1]) - y[i];
+    r[i] = right - left + beta*(right*right*right - left*left*left);
+  }
+  return r;
+}
+
+Split
+split(double x, const Split& y)
+{
+  Y q;
+  for (std::size_t i = 0; i < N; ++i) {
+    q[i] = y[i];
+  }
+  Y a = chain(x, q);
+
+  Split dydx;
+  for (std::size_t i = 0; i < N; ++i) {
+    dydx[i] = y[N + i];
+    dydx[N + i] = a[i];
+  }
+  return dydx;
+}
+
+// Start in a mixture of the lowest mode and a faster one, so the step size
+// is limited by accuracy rather than stability
+Y
+initial()
+{
+  static const double pi = 3.14159265358979323846;
+  Y y;
+  for (std::size_t i = 0; i < N; ++i) {
+    y[i] = std::sin(pi*(i + 1)/(N + 1))
+           + 0.5*std::sin(pi*(N/4)*(i + 1)/(N + 1));
+  }
+  return y;
+}
+
+Y
+zero()
+{
+  Y y;
+  for (std::size_t i = 0; i < N; ++i) {
+    y[i] = 0.0;
+  }
+  return y;
+}
+
+double
+distance(const Y& u, const Y& v)
+{
+  double max = 0.0;
+  for (std::size_t i = 0; i < N; ++i) {
+    max = std::max(max, std::abs(u[i] - v[i]));
+  }
+  return max;
+}
+
+void
+print(const char* name, double tol, unsigned int steps,
+      unsigned int evaluations, double error, std::clock_t start,
+      std::clock_t end)
+{
+  std::cout << "  " << std::left << std::setw(8) << name << std::right
+            << std::scientific << std::setprecision(0) << tol
+            << std::setw(8) << steps << " steps,"
+            << std::setw(8) << evaluations << " evaluations, error "
+            << std::setprecision(2) << error << ", " << std::fixed
+            << std::setprecision(2) << 1000.0*(end - start)/CLOCKS_PER_SEC
+            << " ms" << std::endl;
+}
+
+int
+main()
+{
+  typedef Y (*F)(double, const Y&);
+  typedef Split (*SplitF)(double, const Split&);
+
+  vZ::GenericDPRKN6Integrator<Y, F> reference(chain);
+  reference.tol(1e-14).y(vZ::PhaseSpace<Y>(initial(), zero())).x(0.0)
+           .h(0.0);
+  reference.integrate(100.0);
+
+  for (int i = 6; i <= 12; i += 3) {
+    double tol = std::pow(10.0, -i);
+
+    vZ::GenericDPRKN6Integrator<Y, F> rkn(chain);
+    rkn.tol(tol).y(vZ::PhaseSpace<Y>(initial(), zero())).x(0.0).h(0.0);
+
+    std::clock_t start = std::clock();
+    rkn.integrate(100.0);
+    std::clock_t end = std::clock();
+    print("DPRKN6", tol, rkn.iterations(), rkn.evaluations(),
+          distance(rkn.q(), reference.q()), start, end);
+
+    Split y0;
+    Y q0 = initial();
+    for (std::size_t j = 0; j < N; ++j) {
+      y0[j] = q0[j];
+      y0[N + j] = 0.0;
+    }
+    vZ::GenericDP45Integrator<Split, SplitF> dp45(split);
+    dp45.tol(tol).y(y0).x(0.0).h(0.0);
+
+    start = std::clock();
+    dp45.integrate(100.0);
+    end = std::clock();
+
+    Y q;
+    for (std::size_t j = 0; j < N; ++j) {
+      q[j] = dp45.y()[j];
+    }
+    print("DP45", tol, dp45.iterations(), dp45.evaluations(),
+          distance(q, reference.q()), start, end);
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+// Time per DP45 step for systems of various sizes.  Build with and without
+// -DVZ_NO_SIMD to compare the SIMD kernels against the generic loops.
+
+// N/2 uncoupled harmonic oscillators, y'' = -y
+template <std::size_t N>
+class Oscillators
+{
+public:
+  typedef vZ::EquationSystem<N> Y;
+
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    for (std::size_t i = 0; i < N; i += 2) {
+      dydx[i] = y[i + 1];
+      dydx[i + 1] = -y[i];
+    }
+    return dydx;
+  }
+};
+
+template <std::size_t N>
+void
+bench()
+{
+  typedef vZ::EquationSystem<N> Y;
+  typedef vZ::GenericDP45Integrator<Y, Oscillators<N> > Integrator;
+
+  // Keep the total work roughly constant across sizes
+  const unsigned int runs = 1 + 4096/N;
+
+  Y y0;
+  for (std::size_t i = 0; i < N; i += 2) {
+    y0[i] = 1.0;
+    y0[i + 1] = 0.0;
+  }
+
+  Integrator* integrator = new Integrator(Oscillators<N>());
+  integrator->tol(1e-8);
+
+  std::clock_t start = std::clock();
+  for (unsigned int i = 0; i < runs; ++i) {
+    integrator->y(y0).x(0.0).h(0.1);
+    integrator->integrate(100.0);
+  }
+  std::clock_t end = std::clock();
+  unsigned int steps = integrator->iterations();
+  delete integrator;
+
+  double ns = 1e9*(end - start)/CLOCKS_PER_SEC/steps;
+  std::cout << "N = " << std::setw(4) << N << ": "
+            << std::setw(8) << std::setprecision(4) << ns << " ns/step"
+            << std::endl;
+}
+
+int
+main()
+{
+  std::cout << "SIMD width: " << VZ_SIMD_ALIGNMENT << " bytes" << std::endl;
+  bench<4>();
+  bench<64>();
+  bench<1024>();
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Steps, evaluations of f, and time taken on Robertson's stiff chemical
+// kinetics problem, by DP45, the Rosenbrock methods, the integrator which
+// switches between DP45 and RODAS4, and BDF; and on a larger reaction-
+// diffusion problem, the Jacobians and factorizations that RODAS4 and BDF
+// need
+
+typedef vZ::EquationSystem<3> Y;
+typedef Y (*F)(double, const Y&);
+typedef void (*J)(double, const Y&, vZ::Matrix<3>&, Y&);
+
+Y
+robertson(double, const Y& y)
+{
+  Y r;
+  r[0] = -0.04*y[0] + 1.0e4*y[1]*y[2];
+  r[1] =  0.04*y[0] - 1.0e4*y[1]*y[2] - 3.0e7*y[1]*y[1];
+  r[2] =  3.0e7*y[1]*y[1];
+  return r;
+}
+
+void
+jacobian(double, const Y& y, vZ::Matrix<3>& dfdy, Y&)
+{
+  dfdy(0, 0) = -0.04;
+  dfdy(0, 1) =  1.0e4*y[2];
+  dfdy(0, 2) =  1.0e4*y[1];
+  dfdy(1, 0) =  0.04;
+  dfdy(1, 1) = -1.0e4*y[2] - 6.0e7*y[1];
+  dfdy(1, 2) = -1.0e4*y[1];
+  dfdy(2, 1) =  6.0e7*y[1];
+}
+
+// The Brusselator with diffusion in one dimension (Hairer and Wanner II,
+// Section 10), discretized on N interior points
+typedef vZ::DynamicEquationSystem<> Dynamic;
+
+static const std::size_t N = 100;
+static const double alpha = 1.0/50.0;
+
+Dynamic
+brusselator(double, const Dynamic& y)
+{
+  // u[i] == y[2*i], v[i] == y[2*i + 1], with u == 1 and v == 3 on the
+  // boundary
+  double c = alpha*(N + 1)*(N + 1);
+  Dynamic r(2*N);
+  for (std::size_t i = 0; i < N; ++i) {
+    double u = y[2*i], v = y[2*i + 1];
+    double uLeft  = i == 0     ? 1.0 : y[2*i - 2];
+    double uRight = i == N - 1 ? 1.0 : y[2*i + 2];
+    double vLeft  = i == 0     ? 3.0 : y[2*i - 1];
+    double vRight = i == N - 1 ? 3.0 : y[2*i + 3];
+    r[2*i]     = 1.0 + u*u*v - 4.0*u + c*(uLeft - 2.0*u + uRight);
+    r[2*i + 1] = 3.0*u - u*u*v + c*(vLeft - 2.0*v + vRight);
+  }
+  return r;
+}
+
+template <typename Integrator>
+void
+run(const char* name, Integrator& integrator)
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+  y0[2] = 0.0;
+
+  std::vector<double> atol(3, 1e-8);
+  atol[1] = 1e-12;
+  integrator.rtol(1e-6).atol(atol).y(y0).x(0.0).h(0.0);
+
+  std::clock_t start = std::clock();
+  integrator.integrate(40.0);
+  std::clock_t end = std::clock();
+
+  std::cout << "  " << std::left << std::setw(18) << name << std::right
+            << std::setw(8) << integrator.iterations() << " steps,"
+            << std::setw(9) << integrator.evaluations() << " evaluations, "
+            << std::fixed << std::setprecision(3)
+            << 1000.0*(end - start)/CLOCKS_PER_SEC << " ms" << std::endl;
+}
+
+template <typename Integrator>
+void
+runBrusselator(const char* name)
+{
+  static const double pi = 3.14159265358979323846;
+  Dynamic y0(2*N);
+  for (std::size_t i = 0; i < N; ++i) {
+    y0[2*i] = 1.0 + std::sin(2.0*pi*(i + 1)/(N + 1));
+    y0[2*i + 1] = 3.0;
+  }
+
+  Integrator integrator(brusselator);
+  integrator.tol(1e-6).y(y0).x(0.0).h(0.0);
+
+  std::clock_t start = std::clock();
+  integrator.integrate(10.0);
+  std::clock_t end = std::clock();
+
+  std::cout << "  " << std::left << std::setw(18) << name << std::right
+            << std::setw(8) << integrator.iterations() << " steps,"
+            << std::setw(9) << integrator.evaluations() << " evaluations,"
+            << std::setw(6) << integrator.jacobians() << " Jacobians,"
+            << std::setw(6) << integrator.factorizations()
+            << " factorizations, " << std::fixed << std::setprecision(3)
+            << 1000.0*(end - start)/CLOCKS_PER_SEC << " ms" << std::endl;
+}
+
+int
+main()
+{
+  vZ::GenericDP45Integrator<Y, F> dp45(robertson);
+  vZ::GenericROS3PIntegrator<Y, F, J> ros3p(robertson);
+  vZ::GenericROS3PIntegrator<Y, F, J> ros3pJ(robertson, jacobian);
+  vZ::GenericRODAS4Integrator<Y, F, J> rodas4(robertson);
+  vZ::GenericRODAS4Integrator<Y, F, J> rodas4J(robertson, jacobian);
+  vZ::GenericSwitchingIntegrator<Y, F, J> switching(robertson, jacobian);
+  vZ::GenericBDFIntegrator<Y, F, J> bdf(robertson);
+  vZ::GenericBDFIntegrator<Y, F, J> bdfJ(robertson, jacobian);
+
+  std::cout << "Robertson, x in [0, 40], rtol = 1e-6:" << std::endl;
+  run("DP45", dp45);
+  run("ROS3P", ros3p);
+  run("ROS3P, Jacobian", ros3pJ);
+  run("RODAS4", rodas4);
+  run("RODAS4, Jacobian", rodas4J);
+  run("Switching", switching);
+  run("BDF", bdf);
+  run("BDF, Jacobian", bdfJ);
+
+  std::cout << "Brusselator, " << 2*N << " unknowns, x in [0, 10], tol = 1e-6:"
+            << std::endl;
+  runBrusselator<vZ::GenericRODAS4Integrator<Dynamic> >("RODAS4");
+  runBrusselator<vZ::GenericBDFIntegrator<Dynamic> >("BDF");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,143 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <iomanip>
+
+// The energy error after 1000 periods of a Kepler orbit with eccentricity
+// 0.5, against evaluations of the force, for DP45 at a range of tolerances
+// and the symplectic methods at a range of fixed step sizes
+
+typedef vZ::Vector<3> V;
+typedef vZ::EquationSystem<2, V> Y;
+
+static const double pi = 3.14159265358979323846;
+static const double e  = 0.5;
+static const double periods = 1000.0;
+
+V
+velocity(double, const V& p)
+{
+  return p;
+}
+
+V
+force(double, const V& q)
+{
+  double r = std::sqrt(dot(q, q));
+  return -q/(r*r*r);
+}
+
+Y
+kepler(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = velocity(x, y[1]);
+  dydx[1] = force(x, y[0]);
+  return dydx;
+}
+
+double
+energyError(const V& q, const V& p)
+{
+  return std::abs(dot(p, p)/2.0 - 1.0/std::sqrt(dot(q, q)) + 0.5);
+}
+
+V
+q0()
+{
+  return V(1.0 - e, 0.0, 0.0);
+}
+
+V
+p0()
+{
+  return V(0.0, std::sqrt((1.0 + e)/(1.0 - e)), 0.0);
+}
+
+void
+print(double parameter, unsigned int steps, unsigned int evaluations,
+      double error, std::clock_t start, std::clock_t end)
+{
+  std::cout << std::scientific << std::setprecision(1)
+            << "  " << std::setw(8) << parameter
+            << std::setw(10) << steps << " steps,"
+            << std::setw(10) << evaluations << " evaluations, error "
+            << std::setprecision(2) << error << ", "
+            << std::fixed << std::setprecision(1)
+            << 1000.0*(end - start)/CLOCKS_PER_SEC << " ms" << std::endl;
+}
+
+void
+runDP45()
+{
+  std::cout << "DP45 (tolerance):" << std::endl;
+  for (int i = 6; i <= 12; i += 2) {
+    Y y0;
+    y0[0] = q0();
+    y0[1] = p0();
+
+    double tol = std::pow(10.0, -i);
+    vZ::GenericDP45Integrator<Y, Y (*)(double, const Y&)> integrator(kepler);
+    integrator.tol(tol).y(y0).x(0.0).h(0.0);
+
+    std::clock_t start = std::clock();
+    integrator.integrate(2.0*pi*periods);
+    std::clock_t end = std::clock();
+
+    print(tol, integrator.iterations(),
+          integrator.evaluations(),
+          energyError(integrator.y()[0], integrator.y()[1]), start, end);
+  }
+}
+
+template <template <typename, typename, typename, typename> class Integrator>
+void
+run(const char* name)
+{
+  typedef V (*F)(double, const V&);
+
+  std::cout << name << " (steps per period):" << std::endl;
+  for (unsigned int n = 25; n <= 400; n *= 2) {
+    Integrator<V, V, F, F> integrator(velocity, force);
+    integrator.y(vZ::PhaseSpace<V>(q0(), p0())).x(0.0).h(2.0*pi/n);
+
+    std::clock_t start = std::clock();
+    integrator.integrate(2.0*pi*periods);
+    std::clock_t end = std::clock();
+
+    print(n, integrator.iterations(), integrator.evaluations(),
+          energyError(integrator.q(), integrator.p()), start, end);
+  }
+}
+
+int
+main()
+{
+  runDP45();
+  run<vZ::GenericVerletIntegrator>("Verlet");
+  run<vZ::GenericYoshida4Integrator>("Yoshida4");
+  run<vZ::GenericBlanesMoanIntegrator>("BlanesMoan");
+  run<vZ::GenericYoshida6Integrator>("Yoshida6");
+  run<vZ::GenericYoshida8Integrator>("Yoshida8");
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,89 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+// Evaluations of f against the error achieved, for the high-order methods,
+// DP45, Adams, and GBS extrapolation, on a Kepler orbit with eccentricity
+// 0.5 over five periods
+
+typedef vZ::EquationSystem<4> Y;
+typedef Y (*F)(double, const Y&);
+
+// r'' = -r/|r|^3
+Y
+kepler(double x, const Y& y)
+{
+  double r2 = y[0]*y[0] + y[1]*y[1];
+  double r3 = r2*std::sqrt(r2);
+
+  Y dydx;
+  dydx[0] = y[2];
+  dydx[1] = y[3];
+  dydx[2] = -y[0]/r3;
+  dydx[3] = -y[1]/r3;
+  return dydx;
+}
+
+template <typename Integrator>
+void
+run(const char* name)
+{
+  // Starting at periapsis, the orbit closes after each period of 2*pi
+  static const double e = 0.5, pi = 3.14159265358979323846;
+  Y y0;
+  y0[0] = 1.0 - e;
+  y0[1] = 0.0;
+  y0[2] = 0.0;
+  y0[3] = std::sqrt((1.0 + e)/(1.0 - e));
+
+  std::cout << name << ":" << std::endl;
+  for (int i = 6; i <= 13; ++i) {
+    double tol = std::pow(10.0, -i);
+
+    Integrator integrator(kepler);
+    integrator.tol(tol).y(y0).x(0.0).h(0.0);
+    integrator.integrate(10.0*pi);
+
+    double error = 0.0;
+    for (unsigned int j = 0; j < 4; ++j) {
+      error = std::max(error, std::abs(integrator.y()[j] - y0[j]));
+    }
+
+    std::cout << "  tol = 1e-" << std::left << std::setw(2) << i
+              << std::right << std::setw(8) << integrator.evaluations()
+              << " evaluations, error " << std::setprecision(2)
+              << std::scientific << error << std::fixed << std::endl;
+  }
+}
+
+int
+main()
+{
+  run<vZ::GenericDP45Integrator<Y, F> >("DP45");
+  run<vZ::GenericVerner65Integrator<Y, F> >("Verner65");
+  run<vZ::GenericDOP853Integrator<Y, F> >("DOP853");
+  run<vZ::GenericAdamsIntegrator<Y, F> >("Adams");
+  run<vZ::GenericGBSIntegrator<Y, F> >("GBS");
+  return EXIT_SUCCESS;
+}
@@ -24,8 +24,13 @@
 #define VZ_HPP
 
 #include <vZ/Traits.hpp>
+#include <vZ/SIMD.hpp>
+#include <vZ/Lanes.hpp>
+#include <vZ/Expression.hpp>
+#include <vZ/Matrix.hpp>
 #include <vZ/Vector.hpp>
 #include <vZ/EquationSystem.hpp>
+#include <vZ/DynamicEquationSystem.hpp>
 #include <vZ/Integrator.hpp>
 #include <vZ/RK.hpp>
 #include <vZ/Simple.hpp>
@@ -33,11 +38,32 @@
 #include <vZ/Midpoint.hpp>
 #include <vZ/Heun.hpp>
 #include <vZ/RK4.hpp>
+#include <vZ/Controller.hpp>
+#include <vZ/ErrorControl.hpp>
 #include <vZ/Adaptive.hpp>
 #include <vZ/HE12.hpp>
 #include <vZ/BS23.hpp>
 #include <vZ/RKF45.hpp>
 #include <vZ/CK45.hpp>
 #include <vZ/DP45.hpp>
+#include <vZ/Verner65.hpp>
+#include <vZ/DOP853.hpp>
+#include <vZ/Rosenbrock.hpp>
+#include <vZ/ROS3P.hpp>
+#include <vZ/RODAS4.hpp>
+#include <vZ/Switching.hpp>
+#include <vZ/Adams.hpp>
+#include <vZ/BDF.hpp>
+#include <vZ/Symplectic.hpp>
+#include <vZ/Verlet.hpp>
+#include <vZ/Yoshida.hpp>
+#include <vZ/BlanesMoan.hpp>
+#include <vZ/RKN.hpp>
+#include <vZ/DPRKN6.hpp>
+#include <vZ/ThreadPool.hpp>
+#include <vZ/GBS.hpp>
+#include <vZ/Ensemble.hpp>
+#include <vZ/Parallel.hpp>
+#include <vZ/Parareal.hpp>
 
 #endif // VZ_HPP
@@ -0,0 +1,422 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_ADAMS_HPP
+#define VZ_ADAMS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vZ
+{
+  // Variable-step, variable-order Adams-Bashforth-Moulton method, in PECE
+  // form
+  //
+  // Each step predicts with the explicit Adams method of order k, evaluates
+  // f there, corrects with the implicit method of order k + 1, and evaluates
+  // f again at the solution, so it costs two evaluations of f whatever the
+  // order.  The methods are written in terms of modified divided differences
+  // of f, after Krogh and Shampine and Gordon (see Hairer, Norsett, and
+  // Wanner III.5), so the coefficients are recomputed for every step size
+  // sequence, rather than interpolating the history onto a new grid.
+  //
+  // The difference between the corrected solutions of orders k + 1 and k
+  // gives the error estimate, and the estimates for orders k - 1 and k + 1
+  // decide when to change order, up to maxOrder().  The first
+  // s_startSteps steps are taken by the RK method Starter, which must be
+  // constructible from f.  The history starts over if x() is moved from the
+  // end of the last step, but changing y() alone requires a reset().
+  template <typename Y,
+            typename F = typename GenericIntegrator<Y>::Function,
+            typename Starter = GenericDP45Integrator<Y, F> >
+  class GenericAdamsIntegrator
+    : public GenericStaticIntegrator<
+        Y, GenericAdamsIntegrator<Y, F, Starter>
+      >,
+      public GenericErrorControl<Y, GenericAdamsIntegrator<Y, F, Starter> >
+  {
+    typedef GenericStaticIntegrator<Y, GenericAdamsIntegrator> Base;
+    friend class GenericStaticIntegrator<Y, GenericAdamsIntegrator>;
+
+  public:
+    typedef typename Base::Scalar Scalar;
+    typedef F                     Function;
+
+    // The highest supported order, and the number of RK steps taken first,
+    // after which the order is s_startSteps
+    static const unsigned int s_maxOrder   = 12;
+    static const unsigned int s_startSteps = 4;
+
+    GenericAdamsIntegrator(Function f);
+    ~GenericAdamsIntegrator() { }
+
+    // The function being integrated, e.g. to change its parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
+
+    // The RK method which starts the integration
+    Starter&       starter()       { return m_starter; }
+    const Starter& starter() const { return m_starter; }
+
+    // The order of the predictor; the corrector's is one higher
+    unsigned int order() const { return m_order; }
+
+    // Limit the order, to at most s_maxOrder
+    GenericAdamsIntegrator& maxOrder(unsigned int order);
+    unsigned int maxOrder() const { return m_maxOrder; }
+
+    // Also forgets the history, so the next step starts again with Starter
+    void reset();
+
+  protected:
+    // Choose h if it's 0, with Starter
+    void start();
+    void step();
+
+  private:
+    // Forget the history
+    void restart();
+
+    // Compute the coefficients for a step of size h at order k
+    void coefficients(Scalar h, unsigned int k);
+
+    // Take the step to x() + h, where f is f1, into the differences
+    void update(Scalar h, const Y& f1);
+
+    // Give Starter our tolerances and controller
+    void configureStarter();
+    // Take a step with Starter
+    void startingStep();
+
+    // The scaled error estimate at order k, from the predicted difference
+    // Phi[k](n + 1)
+    Scalar error(Scalar h, unsigned int k, const Y& phi) const;
+
+    Function m_f;
+    Starter m_starter;
+
+    unsigned int m_order, m_maxOrder;
+    // Steps taken at the current order
+    unsigned int m_orderSteps;
+    // The number of points in the history, and of usable differences
+    unsigned int m_points, m_differences;
+    // The last point in the history
+    Scalar m_xLast;
+
+    // The modified divided differences Phi[j](n) of f at the last points,
+    // and the distances psi[j] == x(n) - x(n - j)
+    Y m_phi[s_maxOrder + 2];
+    Scalar m_psi[s_maxOrder + 2];
+
+    // For the step being attempted: psi[j](n + 1), beta[j](n) and the
+    // scaled differences Phi*[j](n) == beta[j](n)*Phi[j](n), and the
+    // integration coefficients g[j](n)
+    Scalar m_psiNew[s_maxOrder + 2];
+    Scalar m_beta[s_maxOrder + 2];
+    Y m_phiStar[s_maxOrder + 2];
+    Scalar m_g[s_maxOrder + 2];
+
+    // The predicted solution, the predicted difference Phi[k](n + 1), the
+    // corrected solution, and f there
+    Y m_yPredicted, m_e, m_yNew, m_f1, m_scratch;
+  };
+
+  // Type alias
+  typedef GenericAdamsIntegrator<double> AdamsIntegrator;
+
+  // Implementations
+
+  template <typename Y, typename F, typename Starter>
+  GenericAdamsIntegrator<Y, F, Starter>::GenericAdamsIntegrator(Function f)
+    : m_f(f), m_starter(f), m_order(s_startSteps), m_maxOrder(s_maxOrder),
+      m_orderSteps(0), m_points(0), m_differences(0)
+  {
+  }
+
+  template <typename Y, typename F, typename Starter>
+  GenericAdamsIntegrator<Y, F, Starter>&
+  GenericAdamsIntegrator<Y, F, Starter>::maxOrder(unsigned int order)
+  {
+    m_maxOrder = order < 1 ? 1 : order > s_maxOrder ? s_maxOrder : order;
+    m_order = std::min(m_order, m_maxOrder);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    m_starter.reset();
+    restart();
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::restart()
+  {
+    m_order = s_startSteps < m_maxOrder ? s_startSteps : m_maxOrder;
+    m_orderSteps = 0;
+    m_points = 0;
+    m_differences = 0;
+  }
+
+  template <typename Y, typename F, typename Starter>
+  inline void
+  GenericAdamsIntegrator<Y, F, Starter>::start()
+  {
+    if (this->h() != Scalar(0)) {
+      return;
+    }
+
+    // Integrating Starter up to x() lets it choose h without stepping
+    configureStarter();
+    unsigned int evaluations = m_starter.evaluations();
+    m_starter.y(this->y()).x(this->x()).h(0);
+    m_starter.integrate(this->x());
+    this->h(m_starter.h());
+    this->evaluations(this->evaluations()
+                      + m_starter.evaluations() - evaluations);
+  }
+
+  template <typename Y, typename F, typename Starter>
+  inline void
+  GenericAdamsIntegrator<Y, F, Starter>::step()
+  {
+    if (m_points > 0 && this->x() != m_xLast) {
+      restart();
+    }
+
+    if (m_points <= s_startSteps || m_points <= m_order) {
+      startingStep();
+      return;
+    }
+
+    // Attempt the integration step in a loop
+    Scalar h, newH;
+    unsigned int k, newK;
+    Scalar errK;
+    while (true) {
+      h = this->h();
+      k = m_order;
+      coefficients(h, k);
+
+      // Predict
+      m_yPredicted = this->y();
+      for (unsigned int j = 0; j < k; ++j) {
+        m_yPredicted += (h*m_g[j])*m_phiStar[j];
+      }
+
+      // Evaluate
+      evaluate(m_f, this->x() + h, m_yPredicted, m_f1);
+      this->evaluations(this->evaluations() + 1);
+
+      // Phi[k](n + 1) == f(p) - Phi*[0](n) - ... - Phi*[k - 1](n)
+      m_e = m_f1;
+      for (unsigned int j = 0; j < k; ++j) {
+        m_e -= m_phiStar[j];
+      }
+
+      // Correct
+      m_yNew = m_yPredicted + (h*m_g[k])*m_e;
+
+      // The errors at orders k - 1, k, and k + 1
+      errK = error(h, k, m_e);
+      Scalar errKm1 = std::numeric_limits<Scalar>::infinity();
+      if (k > 1) {
+        m_scratch = m_e + m_phiStar[k - 1];
+        errKm1 = error(h, k - 1, m_scratch);
+      }
+      Scalar errKp1 = std::numeric_limits<Scalar>::infinity();
+      if (k < m_maxOrder && m_differences > k + 1
+          && m_orderSteps >= k + 1) {
+        m_scratch = m_e - m_phiStar[k];
+        errKp1 = error(h, k + 1, m_scratch);
+      }
+
+      // Lower the order if that's no less accurate, and only raise it after
+      // k + 1 steps at this one, and not on a rejected step
+      newK = k;
+      Scalar errNew = errK;
+      if (errKm1 <= errK) {
+        newK = k - 1;
+        errNew = errKm1;
+      } else if (errKp1 < errK && errK <= Scalar(1)) {
+        newK = k + 1;
+        errNew = errKp1;
+      }
+
+      // The estimates are rougher than an embedded RK pair's, so aim for
+      // half the tolerance, like DE/STEP
+      errNew *= Scalar(2);
+
+      if (errK > Scalar(1)) {
+        // Reject the step, and retry with at most half of h, since errNew
+        // may be acceptable at a lowered order, but don't cut h by more
+        // than 10 times
+        newH = this->reject(h, errNew, newK + 1);
+        this->h(std::max(std::min(newH, h/Scalar(2)), h/Scalar(10)));
+        if (newK != m_order) {
+          m_order = newK;
+          m_orderSteps = 0;
+        }
+        continue;
+      }
+
+      // Changing the step size quickly upsets the differences, so the ratio
+      // is limited to [1/2, 2]
+      newH = errNew == Scalar(0) ? Scalar(2)*h
+        : this->accept(h, errNew, newK + 1);
+      newH = std::min(std::max(newH, h/Scalar(2)), Scalar(2)*h);
+      break;
+    }
+
+    // Evaluate again at the corrected solution
+    evaluate(m_f, this->x() + h, m_yNew, m_f1);
+    this->evaluations(this->evaluations() + 1);
+    update(h, m_f1);
+
+    this->y(m_yNew);
+    this->x(this->x() + h);
+    m_xLast = this->x();
+
+    ++m_orderSteps;
+    if (newK != m_order) {
+      m_order = newK;
+      m_orderSteps = 0;
+    }
+    this->h(newH);
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::configureStarter()
+  {
+    if (this->atols().empty()) {
+      m_starter.atol(this->atol()).rtol(this->rtol());
+    } else {
+      m_starter.atol(this->atols()).rtol(this->rtols());
+    }
+    m_starter.controller(this->controller());
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::startingStep()
+  {
+    if (m_points == 0) {
+      // The history starts with f(x, y)
+      evaluate(m_f, this->x(), this->y(), m_phi[0]);
+      this->evaluations(this->evaluations() + 1);
+      m_points = 1;
+      m_differences = 1;
+      m_xLast = this->x();
+
+      configureStarter();
+      m_starter.reset();
+    }
+
+    unsigned int evaluations = m_starter.evaluations();
+    m_starter.y(this->y()).x(this->x()).h(this->h());
+    m_starter.advance(this->x() + this->h());
+
+    // The step, then f at its end, into the history
+    Scalar h = m_starter.x() - this->x();
+    evaluate(m_f, m_starter.x(), m_starter.y(), m_f1);
+    this->evaluations(this->evaluations() + 1
+                      + m_starter.evaluations() - evaluations);
+    coefficients(h, std::min(m_differences, s_maxOrder + 1) - 1);
+    update(h, m_f1);
+
+    this->y(m_starter.y());
+    this->x(m_starter.x());
+    m_xLast = this->x();
+    this->h(m_starter.h());
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::coefficients(Scalar h,
+                                                      unsigned int k)
+  {
+    // psi[j](n + 1) == h + psi[j - 1](n), and
+    // beta[j](n) == beta[j - 1](n)*psi[j](n + 1)/psi[j](n)
+    m_psiNew[1] = h;
+    m_beta[0] = 1;
+    m_phiStar[0] = m_phi[0];
+    for (unsigned int j = 1; j <= k && j < m_differences; ++j) {
+      m_psiNew[j + 1] = h + m_psi[j];
+      m_beta[j] = m_beta[j - 1]*m_psiNew[j]/m_psi[j];
+      m_phiStar[j] = m_beta[j]*m_phi[j];
+    }
+
+    // g[j] == c[j][1], where
+    //   c[0][q] == 1/q
+    //   c[j][q] == c[j - 1][q] - c[j - 1][q + 1]*h/psi[j](n + 1)
+    Scalar c[s_maxOrder + 4];
+    for (unsigned int q = 1; q <= k + 2; ++q) {
+      c[q] = Scalar(1)/q;
+    }
+    m_g[0] = 1;
+    for (unsigned int j = 1; j <= k + 1; ++j) {
+      Scalar r = h/m_psiNew[j];
+      for (unsigned int q = 1; q <= k + 2 - j; ++q) {
+        c[q] -= c[q + 1]*r;
+      }
+      m_g[j] = c[1];
+    }
+  }
+
+  template <typename Y, typename F, typename Starter>
+  void
+  GenericAdamsIntegrator<Y, F, Starter>::update(Scalar h, const Y& f1)
+  {
+    // Phi[0](n + 1) == f1, and Phi[j + 1](n + 1) == Phi[j](n + 1) - Phi*[j](n)
+    unsigned int differences = std::min(m_differences + 1,
+                                        std::min(m_order, m_maxOrder) + 2);
+    m_phi[0] = f1;
+    for (unsigned int j = 0; j + 1 < differences; ++j) {
+      m_phi[j + 1] = m_phi[j] - m_phiStar[j];
+    }
+    m_differences = differences;
+
+    // psi[j](n + 1) becomes psi[j](n)
+    m_psi[1] = h;
+    for (unsigned int j = 2; j < differences; ++j) {
+      m_psi[j] = m_psiNew[j];
+    }
+    ++m_points;
+  }
+
+  template <typename Y, typename F, typename Starter>
+  inline typename GenericAdamsIntegrator<Y, F, Starter>::Scalar
+  GenericAdamsIntegrator<Y, F, Starter>::error(Scalar h, unsigned int k,
+                                               const Y& phi) const
+  {
+    // The difference between the corrected solutions of orders k + 1 and k
+    Scalar d = h*(m_g[k] - m_g[k - 1]);
+    using std::abs;
+    return abs(d)*this->errorNorm(phi, m_yNew, this->y());
+  }
+}
+
+#endif // VZ_ADAMS_HPP
@@ -21,132 +21,462 @@
 #ifndef VZ_ADAPTIVE_HPP
 #define VZ_ADAPTIVE_HPP
 
+#include <algorithm>
 #include <cmath>
+#include <vector>
 
 namespace vZ
 {
+  // Continuous extension of an adaptive method over a step from x0 to
+  // x0 + h, for dense output
+  //
+  // weights() gives w and wf such that, with theta == (x - x0)/h,
+  //   y(x) == y(x0) + h*(w[0]*k[0] + ... + w[S - 1]*k[S - 1] + wf*f1)
+  // where f1 == f(x0 + h, y(x0 + h)).  The default is the cubic Hermite
+  // interpolant of y and y' at both ends of the step, which is third-order.
+  // Methods with a native interpolant specialize this.
+  //
+  // Interpolants which need E > 0 extra stages set s_extraStages == E, and
+  // give them as s_a[E][S + 1 + E] and s_c[E], where column S of s_a is the
+  // weight of f1.  Their weights follow the stages' in w, which then has
+  // S + E entries.  The extra stages are only evaluated once per step, the
+  // first time it's interpolated.
+  template <typename Tableau>
+  class DenseOutput
+  {
+  public:
+    typedef typename Tableau::Scalar Scalar;
+
+    static const unsigned int s_order = 3;
+    static const unsigned int s_extraStages = 0;
+
+    static void weights(Scalar theta, Scalar w[], Scalar& wf);
+
+  private:
+    DenseOutput();
+  };
+
+  // How the error of a step is estimated from its stages
+  //
+  // By default, the error is the norm of y - y*, the difference between the
+  // solutions given by b and b*.  Methods which combine it with a second
+  // embedded estimate specialize this with s_combined == true, the weights
+  // s_d[S] of the second estimate, and combine(err, err2), which takes both
+  // errors (scaled so that 1 is just acceptable) to the one that's tested.
+  template <typename Tableau>
+  class ErrorEstimate
+  {
+  public:
+    static const bool s_combined = false;
+
+  private:
+    ErrorEstimate();
+  };
+
   // Base class for adaptive RK-style algorithms
-  template <typename Y>
-  class GenericAdaptiveIntegrator : public GenericRKIntegrator<Y>
+  //
+  // The tolerances and the step size controller are set through
+  // GenericErrorControl.
+  template <typename Y, typename Tableau, typename F>
+  class GenericAdaptiveIntegrator
+    : public GenericRKIntegrator<Y, Tableau, F,
+                                 GenericAdaptiveIntegrator<Y, Tableau, F> >,
+      public GenericErrorControl<Y, GenericAdaptiveIntegrator<Y, Tableau, F> >
   {
+    typedef GenericRKIntegrator<Y, Tableau, F, GenericAdaptiveIntegrator> Base;
+    typedef GenericErrorControl<Y, GenericAdaptiveIntegrator> Control;
+    friend class GenericStaticIntegrator<Y, GenericAdaptiveIntegrator>;
+
   public:
-    typedef typename GenericRKIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericRKIntegrator<Y>::Function Function;
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+    typedef typename Control::StepController StepController;
 
-    GenericAdaptiveIntegrator& tol(Scalar tol)
-      { m_atol = tol; m_rtol = tol; return *this; }
-    GenericAdaptiveIntegrator& atol(Scalar tol) { m_atol = tol; return *this; }
-    GenericAdaptiveIntegrator& rtol(Scalar tol) { m_rtol = tol; return *this; }
+    // The extra evaluations of f spent choosing the first step size
+    unsigned int initialStepEvaluations() const
+      { return m_initialStepEvaluations; }
 
-    Scalar atol() const { return m_atol; }
-    Scalar rtol() const { return m_rtol; }
+    // Also forgets the rejections, the controller's history, and the cached
+    // FSAL stage.  If h() is 0, a step size is chosen from f at the start.
+    void reset();
 
-    unsigned int rejections() const { return m_rejections; }
+    // Dense output
+    //
+    // The solution at any x in the last step taken, [xLast(), x()], from the
+    // interpolant given by DenseOutput<Tableau>.  This doesn't disturb the
+    // step size.  Methods which aren't FSAL need f(x(), y()) for this, which
+    // is then reused as the first stage of the next step, and some
+    // interpolants need extra stages, which are reused until the next step.
+    Scalar xLast() const { return m_xLast; }
+    void interpolate(Scalar x, Y& y);
+    Y    interpolate(Scalar x) { Y y; interpolate(x, y); return y; }
 
-  protected:
-    typedef typename GenericRKIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericRKIntegrator<Y>::BCoefficients BCoefficients;
-    typedef typename GenericRKIntegrator<Y>::KVector       KVector;
+    // Hairer's estimate of h*|lambda| over the last step, where lambda is the
+    // dominant eigenvalue of df/dy, from the last two stages:
+    //   |k[s - 1] - k[s - 2]|/|Y[s - 1] - Y[s - 2]|*h
+    // where Y[i] is the argument of stage i.  When it stays beyond the edge
+    // of the method's stability region, the step size is being limited by
+    // stability rather than accuracy, i.e. the problem is stiff.
+    Scalar stiffness();
 
-    GenericAdaptiveIntegrator(Function f, unsigned int order,
-                              ACoefficients a, BCoefficients b,
-                              BCoefficients bStar);
+  protected:
+    GenericAdaptiveIntegrator(Function f);
     virtual ~GenericAdaptiveIntegrator() { }
 
+    // Choose h if it's 0.  This costs one extra evaluation of f: f(x, y) is
+    // kept for the first step.
+    void start();
     void step();
 
+    // The error of the step from y() to m_yNew, estimated from m_yErr (and
+    // m_yErr2), and scaled so that 1 is just acceptable
+    Scalar error() const;
+
+    // Step freely to x, and interpolate it
+    template <typename Observer>
+    void observe(Scalar x, Scalar x_final, Y& y, Observer& observer);
+
   private:
-    Scalar m_atol, m_rtol;
-    unsigned int m_order;
-    unsigned int m_rejections;
-    ACoefficients m_a;
-    BCoefficients m_b, m_bStar;
+    typedef DenseOutput<Tableau> Dense;
+
+    // Whether the error is combined from two estimates
+    template <bool Combined>
+    class Estimates { };
+    typedef Estimates<ErrorEstimate<Tableau>::s_combined> Estimate;
+
+    void calculateError2(Estimates<false>) { }
+    void calculateError2(Estimates<true>);
+
+    // The scaled norm of an error estimate
+    Scalar error(const Y& e) const;
+    Scalar error(Scalar err, Estimates<false>) const { return err; }
+    Scalar error(Scalar err, Estimates<true>) const;
+
+    // Compile-time count of extra stages for dense output
+    template <unsigned int E>
+    class Extra { };
+
+    // Evaluate the extra stages of the interpolant over the last step
+    template <unsigned int E>
+    void calculateExtraStages(Scalar h, const Y& f1, Extra<E>);
+    void calculateExtraStages(Scalar, const Y&, Extra<0>) { }
+
+    unsigned int m_initialStepEvaluations;
 
     bool m_fsal, m_k1Set;
-    Y m_k1;
-  };
 
-  // Type alias
-  typedef GenericAdaptiveIntegrator<double> AdaptiveIntegrator;
+    // The weights b[i] - b*[i] of the error estimate
+    Scalar m_d[Tableau::s_stages];
+
+    // The candidate solution and its error estimates, reused across steps
+    Y m_yNew, m_yErr, m_yErr2;
+
+    // The start of the last step, f(x(), y()) if it has been evaluated for
+    // dense output, and the interpolant's extra stages if they have been
+    Scalar m_xLast;
+    Y m_f1;
+    bool m_f1Set;
+    std::vector<Y> m_kExtra;
+    bool m_extraSet;
+  };
 
   // Implementations
 
-  template <typename Y>
-  GenericAdaptiveIntegrator<Y>::GenericAdaptiveIntegrator(
-    Function f, unsigned int order,
-    ACoefficients a, BCoefficients b, BCoefficients bStar
+  template <typename Y, typename Tableau, typename F>
+  GenericAdaptiveIntegrator<Y, Tableau, F>::GenericAdaptiveIntegrator(
+    Function f
   )
-    : GenericRKIntegrator<Y>(f), m_order(order), m_rejections(0),
-      m_a(a), m_b(b), m_bStar(bStar), m_fsal(true), m_k1Set(false)
+    : Base(f), m_initialStepEvaluations(0),
+      m_fsal(true), m_k1Set(false), m_f1Set(false), m_extraSet(false)
   {
-    std::size_t i;
-    for (i = 0; i < m_a.back().size(); ++i) {
-      if (m_a.back()[i] != m_b.at(i)) {
+    // The error estimate is y - y*, which is taken directly from the stages
+    // rather than by computing y* too
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      m_d[i] = Tableau::s_b[i] - Tableau::s_bStar[i];
+    }
+
+    // First Same As Last: the last stage is evaluated at the solution point
+    static const unsigned int last = Tableau::s_stages - 1;
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      if (Tableau::s_a[last][i] != Tableau::s_b[i]) {
         m_fsal = false;
         return;
       }
     }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    m_initialStepEvaluations = 0;
+    m_k1Set = false;
+    m_f1Set = false;
+    m_extraSet = false;
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::interpolate(Scalar x, Y& y)
+  {
+    static const unsigned int last = Tableau::s_stages - 1;
+    static const unsigned int extra = Dense::s_extraStages;
+
+    // The span of the step, rather than the h it was taken with, so that
+    // theta is exactly 1 at x()
+    Scalar h = this->x() - m_xLast;
+    Scalar w[Tableau::s_stages + extra], wf;
+    Dense::weights((x - m_xLast)/h, w, wf);
+
+    // Relative to the end of the step, so that the old y isn't needed, and
+    // y(x()) == y() exactly
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      w[i] -= Tableau::s_b[i];
+    }
+
+    if (!m_fsal && !m_f1Set) {
+      evaluate(this->f(), this->x(), this->y(), m_f1);
+      m_f1Set = true;
+      this->evaluations(this->evaluations() + 1);
+    }
+    const Y& f1 = m_fsal ? this->k(last) : m_f1;
+    calculateExtraStages(h, f1, Extra<extra>());
 
-    if (m_b.at(i) != Scalar(0))
-      m_fsal = false;
+    if (m_fsal) {
+      // The last stage is f1
+      w[last] += wf;
+      linearCombination<Tableau::s_stages>(y, this->y(), h, w,
+                                           &this->k(0));
+    } else {
+      linearCombination<Tableau::s_stages>(y, this->y(), h, w,
+                                           &this->k(0));
+      y += (h*wf)*m_f1;
+    }
+    for (unsigned int i = 0; i < extra; ++i) {
+      y += (h*w[Tableau::s_stages + i])*m_kExtra[i];
+    }
   }
 
-  template <typename Y>
+  template <typename Y, typename Tableau, typename F>
+  template <unsigned int E>
   void
-  GenericAdaptiveIntegrator<Y>::step()
+  GenericAdaptiveIntegrator<Y, Tableau, F>::calculateExtraStages(
+    Scalar h, const Y& f1, Extra<E>
+  )
   {
-    static const Scalar S = Scalar(19)/Scalar(20); // Arbitrary saftey factor
+    static const unsigned int last = Tableau::s_stages - 1;
+
+    if (m_extraSet) {
+      return;
+    }
+    m_kExtra.resize(E);
+
+    for (unsigned int i = 0; i < E; ++i) {
+      // Relative to the end of the step, as in interpolate()
+      const Scalar* a = Dense::s_a[i];
+      Scalar w[Tableau::s_stages];
+      for (unsigned int j = 0; j < Tableau::s_stages; ++j) {
+        w[j] = a[j] - Tableau::s_b[j];
+      }
+
+      Scalar af = a[Tableau::s_stages];
+      if (m_fsal) {
+        w[last] += af;
+        af = Scalar(0);
+      }
+
+      linearCombination<Tableau::s_stages>(m_yNew, this->y(), h, w,
+                                           &this->k(0));
+      if (af != Scalar(0)) {
+        m_yNew += (h*af)*f1;
+      }
+      for (unsigned int j = 0; j < i; ++j) {
+        Scalar ae = a[Tableau::s_stages + 1 + j];
+        if (ae != Scalar(0)) {
+          m_yNew += (h*ae)*m_kExtra[j];
+        }
+      }
+
+      evaluate(this->f(), m_xLast + h*Dense::s_c[i], m_yNew, m_kExtra[i]);
+      this->evaluations(this->evaluations() + 1);
+    }
+    m_extraSet = true;
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  typename GenericAdaptiveIntegrator<Y, Tableau, F>::Scalar
+  GenericAdaptiveIntegrator<Y, Tableau, F>::stiffness()
+  {
+    static const unsigned int last = Tableau::s_stages - 1;
+
+    // Y[s - 1] - Y[s - 2] is taken straight from the stages, into m_yErr2,
+    // which is only needed during a step.  h cancels out.
+    Scalar d[Tableau::s_stages];
+    for (unsigned int j = 0; j < Tableau::s_stages; ++j) {
+      d[j] = Tableau::s_a[last][j] - Tableau::s_a[last - 1][j];
+    }
+    weightedSum<Tableau::s_stages>(m_yErr2, Scalar(1), d, &this->k(0));
+
+    using std::abs;
+    Scalar dy = abs(m_yErr2);
+    if (dy == Scalar(0)) {
+      return dy;
+    }
+    return abs(this->k(last) - this->k(last - 1))/dy;
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  template <typename Observer>
+  inline void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::observe(Scalar x, Scalar x_final,
+                                                    Y& y, Observer& observer)
+  {
+    while (this->x() < x) {
+      this->advance(x_final);
+    }
+
+    if (this->x() == x) {
+      observer(x, this->y());
+    } else {
+      interpolate(x, y);
+      observer(x, static_cast<const Y&>(y));
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::start()
+  {
+    if (this->h() != Scalar(0)) {
+      return;
+    }
+
+    if (m_k1Set) {
+      m_f1 = this->k(Tableau::s_stages - 1);
+    } else if (!m_f1Set) {
+      evaluate(this->f(), this->x(), this->y(), m_f1);
+      this->evaluations(this->evaluations() + 1);
+    }
+    m_f1Set = true;
+
+    this->h(this->initialStep(this->f(), this->x(), this->y(), m_f1, m_yNew,
+                              m_yErr, Tableau::s_order));
+    this->evaluations(this->evaluations() + 1);
+    ++m_initialStepEvaluations;
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::step()
+  {
+    static const unsigned int last = Tableau::s_stages - 1;
     Scalar newH = this->h();
-    Y y;
-    KVector k;
+
+    // k1 is the same for every attempt
+    if (m_k1Set) {
+      this->k(0) = this->k(last);
+    } else if (m_f1Set) {
+      this->k(0) = m_f1;
+    } else {
+      this->calculateK1();
+    }
+    m_f1Set = false;
+    m_extraSet = false;
 
     // Attempt the integration step in a loop
     while (true) {
-      if (m_k1Set) {
-        k = this->calculateK(m_k1, y, m_a);
-      } else if (m_fsal) {
-        k = this->calculateK(y, m_a);
+      // For FSAL methods, the last stage was evaluated at the new solution,
+      // so only the error is left to compute; otherwise both are computed
+      // in one sweep over the stages
+      this->calculateK(m_yNew);
+      if (m_fsal) {
+        weightedSum<Tableau::s_stages>(m_yErr, this->h(), m_d, &this->k(0));
       } else {
-        k = this->calculateK(m_a);
-        y = this->calculateY(k, m_b);
+        combineWithError<Tableau::s_stages>(m_yNew, m_yErr, this->y(),
+                                            this->h(), Tableau::s_b, m_d,
+                                            &this->k(0));
       }
-      Y yStar = this->calculateY(k, m_bStar);
+      calculateError2(Estimate());
 
       // Get an error estimate
-
-      using std::abs;
-      using std::pow;
-      Scalar delta = abs(y - yStar);
-
-      if (delta == Scalar(0)) {
+      Scalar err = error();
+      if (err == Scalar(0)) {
         break;
       }
 
-      Scalar scale = m_atol + std::max(abs(y), abs(this->y()))*m_rtol;
-      newH         = S*this->h()*pow(scale/delta, Scalar(1)/m_order);
-
-      if (delta > scale) {
+      if (err > Scalar(1)) {
         // Reject the step
-        this->h(newH);
-        ++m_rejections;
+        this->h(this->reject(this->h(), err, Tableau::s_order));
       } else {
+        newH = this->accept(this->h(), err, Tableau::s_order);
         break;
       }
     }
 
     // Update x and y
-    this->y(y);
+    m_xLast = this->x();
+    this->y(m_yNew);
     this->x(this->x() + this->h());
 
     // Handle FSAL optimization
     if (m_fsal) {
       m_k1Set = true;
-      m_k1    = k.back();
     }
 
     // Adjust the stepsize for the next iteration
     this->h(newH);
   }
+
+  template <typename Y, typename Tableau, typename F>
+  inline typename GenericAdaptiveIntegrator<Y, Tableau, F>::Scalar
+  GenericAdaptiveIntegrator<Y, Tableau, F>::error() const
+  {
+    return error(error(m_yErr), Estimate());
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline typename GenericAdaptiveIntegrator<Y, Tableau, F>::Scalar
+  GenericAdaptiveIntegrator<Y, Tableau, F>::error(const Y& e) const
+  {
+    return this->errorNorm(e, m_yNew, this->y());
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericAdaptiveIntegrator<Y, Tableau, F>::calculateError2(Estimates<true>)
+  {
+    weightedSum<Tableau::s_stages>(m_yErr2, this->h(),
+                                   ErrorEstimate<Tableau>::s_d, &this->k(0));
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline typename GenericAdaptiveIntegrator<Y, Tableau, F>::Scalar
+  GenericAdaptiveIntegrator<Y, Tableau, F>::error(Scalar err,
+                                                  Estimates<true>) const
+  {
+    if (err == Scalar(0)) {
+      return err;
+    }
+    return ErrorEstimate<Tableau>::combine(err, error(m_yErr2));
+  }
+
+  template <typename Tableau>
+  inline void
+  DenseOutput<Tableau>::weights(Scalar theta, Scalar w[], Scalar& wf)
+  {
+    // The Hermite basis functions for y(x0 + h) - y(x0), y'(x0), and y'(x1)
+    Scalar h01 = theta*theta*(Scalar(3) - Scalar(2)*theta);
+    Scalar h10 = theta*(Scalar(1) - theta)*(Scalar(1) - theta);
+    Scalar h11 = theta*theta*(theta - Scalar(1));
+
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      w[i] = h01*Tableau::s_b[i];
+    }
+    w[0] += h10;
+    wf = h11;
+  }
 }
 
 #endif // VZ_ADAPTIVE_HPP
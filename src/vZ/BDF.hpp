@@ -0,0 +1,604 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_BDF_HPP
+#define VZ_BDF_HPP
+
+#include <algorithm>
+#include <cmath>
+
+namespace vZ
+{
+  // Variable-order backward differentiation formulae, for large stiff
+  // systems
+  //
+  // The BDF of order q (1 to 5) is implemented in Nordsieck form, after
+  // LSODE (Hindmarsh) and Hairer and Wanner (III.6):  the history is kept as
+  //   z[j] == h^j*y^(j)(x)/j!, j == 0..q
+  // which is extrapolated to the next step by Pascal's triangle and then
+  // corrected by
+  //   z[j] += l[j]*e
+  // where l[j] are the coefficients of (1 + t)(1 + t/2)...(1 + t/q), and the
+  // correction e satisfies the implicit equation
+  //   h*f(x + h, z[0] + e) == z[1] + l[1]*e
+  // The coefficients are those of constant steps, and z is rescaled when h
+  // changes, so h and q are only changed after q + 1 steps of the same size
+  // unless a step fails.
+  //
+  // The equation is solved by Newton's method with the matrix
+  //   l[1]/h*I - J
+  // where J == df/dy.  Unlike a Rosenbrock method, the Jacobian and its LU
+  // factorization are kept across steps: it's only refactored when l[1]/h
+  // has changed by more than 30%, or after 20 steps, and J is only
+  // recomputed after 50 steps or when Newton's method fails to converge
+  // with an old one.  J comes from a J function, or from forward
+  // differences, as for the Rosenbrock methods.  The linear algebra is done
+  // by LinearAlgebra<Y>, which is dense for the built-in types; a system
+  // with a banded or sparse Jacobian can specialize it.
+  //
+  // The history starts over if x() is moved from the end of the last step,
+  // but changing y() alone requires a reset().
+  template <typename Y,
+            typename F = typename GenericIntegrator<Y>::Function,
+            typename J = typename GenericIntegrator<Y>::JacobianFunction>
+  class GenericBDFIntegrator
+    : public GenericStaticIntegrator<Y, GenericBDFIntegrator<Y, F, J> >,
+      public GenericErrorControl<Y, GenericBDFIntegrator<Y, F, J> >
+  {
+    typedef GenericStaticIntegrator<Y, GenericBDFIntegrator> Base;
+    friend class GenericStaticIntegrator<Y, GenericBDFIntegrator>;
+
+  public:
+    typedef typename Base::Scalar               Scalar;
+    typedef F                                   Function;
+    typedef J                                   JacobianFunction;
+    typedef typename LinearAlgebra<Y>::Jacobian Jacobian;
+
+    static const unsigned int s_maxOrder = 5;
+
+    // With a finite-difference Jacobian
+    GenericBDFIntegrator(Function f);
+    GenericBDFIntegrator(Function f, JacobianFunction jacobian);
+    ~GenericBDFIntegrator() { }
+
+    // The functions being integrated, e.g. to change their parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
+
+    JacobianFunction&       jacobian()       { return m_jacobian; }
+    const JacobianFunction& jacobian() const { return m_jacobian; }
+
+    // The number of Jacobians computed, LU factorizations made, and Newton
+    // iterations (each costing an evaluation of f and a linear solve)
+    unsigned int jacobians()        const { return m_jacobians; }
+    unsigned int factorizations()   const { return m_factorizations; }
+    unsigned int newtonIterations() const { return m_newtonIterations; }
+
+    // The current order
+    unsigned int order() const { return m_order; }
+
+    // Limit the order, to at most s_maxOrder
+    GenericBDFIntegrator& maxOrder(unsigned int order);
+    unsigned int maxOrder() const { return m_maxOrder; }
+
+    // Also forgets the history, the counts, the rejections, and the
+    // controller's history.  If h() is 0, a step size is chosen from f at
+    // the start.
+    void reset();
+
+  protected:
+    // Choose h if it's 0, like the Rosenbrock methods
+    void start();
+    void step();
+
+  private:
+    typedef LinearAlgebra<Y>                Algebra;
+    typedef typename Algebra::Factorization Factorization;
+
+    // Newton's method gives up after this many iterations, or if it
+    // diverges
+    static const unsigned int s_newtonIterations = 3;
+
+    // Forget the history
+    void restart();
+
+    // Compute the coefficients l for each order
+    void initialize();
+
+    // Scale z for a step size of h
+    void rescale(Scalar h);
+
+    // Lower the order by one, keeping y, h*y', and the last q - 2 points
+    void lowerOrder();
+
+    // Solve for the correction e by Newton's method, factoring the matrix
+    // first if needed; returns false if it doesn't converge
+    bool correct(Scalar x, Scalar h);
+
+    // Make m_lu the factorization of c*I - J, recomputing J at (x, y) first
+    // if needed, given f(x, y) in m_f1
+    bool factor(Scalar x, const Y& y, Scalar c);
+
+    // The scaled error estimate for order k, given its leading term d
+    Scalar error(unsigned int k, const Y& d) const;
+
+    // Inflate an error estimate for order k, so that it asks for a step
+    // size b times smaller
+    static Scalar bias(Scalar err, Scalar b, unsigned int k)
+      { return std::pow(b, Scalar(k + 1))*err; }
+
+    // Whether the error err1 of order k1 allows a longer step than err2 of
+    // order k2
+    static bool longer(Scalar err1, unsigned int k1,
+                       Scalar err2, unsigned int k2)
+      { return std::pow(err1, Scalar(1)/(k1 + 1))
+          < std::pow(err2, Scalar(1)/(k2 + 1)); }
+
+    Function m_f;
+    JacobianFunction m_jacobian;
+    bool m_hasJacobian;
+
+    // f(x(), y()), if it's been evaluated by start()
+    Y m_f0;
+    bool m_f0Set;
+
+    unsigned int m_order, m_maxOrder;
+    // Whether z is valid, and where it ends
+    bool m_started;
+    Scalar m_xLast;
+    // The step size z is scaled for
+    Scalar m_hz;
+    // Steps until h and q may change
+    unsigned int m_wait;
+
+    // The Nordsieck history, its prediction, the correction and the last
+    // step's, if it's usable for the order q + 1 estimate
+    Y m_z[s_maxOrder + 2];
+    Y m_zPredicted[s_maxOrder + 2];
+    Y m_e, m_eLast;
+    bool m_eLastSet;
+
+    // l[q][j] for each order q, and the factorial of q
+    Scalar m_l[s_maxOrder + 2][s_maxOrder + 2];
+    Scalar m_factorial[s_maxOrder + 2];
+
+    // J, and the factorization of c*I - J, with its age in steps
+    Jacobian m_dfdy;
+    Factorization m_lu;
+    Scalar m_c;
+    bool m_jacobianSet, m_jacobianCurrent, m_luSet;
+    unsigned int m_jacobianAge, m_luAge;
+    // The estimated convergence rate of Newton's method
+    Scalar m_rate;
+
+    // The iterate, f there, and the Newton correction
+    Y m_yNew, m_f1, m_delta;
+
+    unsigned int m_jacobians, m_factorizations, m_newtonIterations;
+  };
+
+  // Type alias
+  typedef GenericBDFIntegrator<double> BDFIntegrator;
+
+  // Implementations
+
+  template <typename Y, typename F, typename J>
+  GenericBDFIntegrator<Y, F, J>::GenericBDFIntegrator(Function f)
+    : m_f(f), m_jacobian(), m_hasJacobian(false), m_f0Set(false),
+      m_maxOrder(s_maxOrder), m_jacobians(0), m_factorizations(0),
+      m_newtonIterations(0)
+  {
+    initialize();
+    restart();
+  }
+
+  template <typename Y, typename F, typename J>
+  GenericBDFIntegrator<Y, F, J>::GenericBDFIntegrator(
+    Function f, JacobianFunction jacobian
+  )
+    : m_f(f), m_jacobian(jacobian), m_hasJacobian(true), m_f0Set(false),
+      m_maxOrder(s_maxOrder), m_jacobians(0), m_factorizations(0),
+      m_newtonIterations(0)
+  {
+    initialize();
+    restart();
+  }
+
+  template <typename Y, typename F, typename J>
+  void
+  GenericBDFIntegrator<Y, F, J>::initialize()
+  {
+    // Multiply out (1 + t)(1 + t/2)...(1 + t/q), one factor at a time
+    for (unsigned int q = 0; q <= s_maxOrder + 1; ++q) {
+      Scalar* l = m_l[q];
+      std::fill(l, l + s_maxOrder + 2, Scalar(0));
+      l[0] = 1;
+      for (unsigned int i = 1; i <= q; ++i) {
+        for (unsigned int j = i; j > 0; --j) {
+          l[j] += l[j - 1]/i;
+        }
+      }
+    }
+
+    m_factorial[0] = 1;
+    for (unsigned int q = 1; q <= s_maxOrder + 1; ++q) {
+      m_factorial[q] = q*m_factorial[q - 1];
+    }
+  }
+
+  template <typename Y, typename F, typename J>
+  GenericBDFIntegrator<Y, F, J>&
+  GenericBDFIntegrator<Y, F, J>::maxOrder(unsigned int order)
+  {
+    m_maxOrder = order < 1 ? 1 : order > s_maxOrder ? s_maxOrder : order;
+    while (m_started && m_order > m_maxOrder) {
+      lowerOrder();
+    }
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J>
+  void
+  GenericBDFIntegrator<Y, F, J>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    restart();
+    m_f0Set = false;
+    m_jacobians = 0;
+    m_factorizations = 0;
+    m_newtonIterations = 0;
+  }
+
+  template <typename Y, typename F, typename J>
+  void
+  GenericBDFIntegrator<Y, F, J>::restart()
+  {
+    m_order = 1;
+    m_started = false;
+    m_eLastSet = false;
+    m_jacobianSet = false;
+    m_luSet = false;
+    m_jacobianAge = 0;
+    m_luAge = 0;
+    m_rate = 1;
+  }
+
+  template <typename Y, typename F, typename J>
+  inline void
+  GenericBDFIntegrator<Y, F, J>::start()
+  {
+    if (this->h() != Scalar(0)) {
+      return;
+    }
+
+    if (!m_f0Set) {
+      evaluate(m_f, this->x(), this->y(), m_f0);
+      m_f0Set = true;
+      this->evaluations(this->evaluations() + 1);
+    }
+
+    // The first step is backward Euler, with an error of order 2
+    this->h(this->initialStep(m_f, this->x(), this->y(), m_f0, m_yNew, m_f1,
+                              2));
+    this->evaluations(this->evaluations() + 1);
+  }
+
+  template <typename Y, typename F, typename J>
+  inline void
+  GenericBDFIntegrator<Y, F, J>::step()
+  {
+    if (m_started && this->x() != m_xLast) {
+      restart();
+    }
+
+    if (!m_started) {
+      // z == (y, h*y'), for backward Euler
+      if (!m_f0Set) {
+        evaluate(m_f, this->x(), this->y(), m_f0);
+        this->evaluations(this->evaluations() + 1);
+      }
+      m_z[0] = this->y();
+      m_z[1] = this->h()*m_f0;
+      m_hz = this->h();
+      m_wait = 2;
+      m_started = true;
+    }
+    m_f0Set = false;
+    m_jacobianCurrent = false;
+
+    // Attempt the integration step in a loop
+    unsigned int q;
+    Scalar h, err;
+    while (true) {
+      if (this->h() != m_hz) {
+        rescale(this->h());
+      }
+      h = this->h();
+      q = m_order;
+
+      // Predict
+      for (unsigned int j = 0; j <= q; ++j) {
+        m_zPredicted[j] = m_z[j];
+      }
+      for (unsigned int k = 0; k < q; ++k) {
+        for (unsigned int j = q; j > k; --j) {
+          m_zPredicted[j - 1] += m_zPredicted[j];
+        }
+      }
+
+      // Correct
+      if (!correct(this->x() + h, h)) {
+        this->h(this->fail(h));
+        m_wait = q + 1;
+        continue;
+      }
+
+      err = error(q, m_e);
+      if (err <= Scalar(1)) {
+        break;
+      }
+
+      // Reject the step, and lower the order if that would allow a longer
+      // one
+      unsigned int newQ = q;
+      Scalar newErr = bias(err, Scalar(6)/5, q);
+      if (q > 1) {
+        Scalar errLower = bias(error(q - 1, m_z[q]), Scalar(13)/10, q - 1);
+        if (longer(errLower, q - 1, newErr, q)) {
+          newQ = q - 1;
+          newErr = errLower;
+          lowerOrder();
+        }
+      }
+      // The estimate at a lowered order may be below 1, so cap the retry at
+      // half of h, but don't cut h by more than 10 times
+      Scalar newH = this->reject(h, newErr, newQ + 1);
+      this->h(std::max(std::min(newH, h/Scalar(2)), h/Scalar(10)));
+      m_wait = newQ + 1;
+      m_eLastSet = false;
+    }
+
+    // Update z and x
+    for (unsigned int j = 0; j <= q; ++j) {
+      m_z[j] = m_zPredicted[j] + m_l[q][j]*m_e;
+    }
+    this->y(m_z[0]);
+    this->x(this->x() + h);
+    m_xLast = this->x();
+    ++m_jacobianAge;
+    ++m_luAge;
+
+    if (--m_wait > 1) {
+      return;
+    } else if (m_wait == 1) {
+      // Keep e for the next step's order q + 1 estimate
+      m_eLast = m_e;
+      m_eLastSet = true;
+      return;
+    }
+
+    // Choose the order whose error estimate allows the longest step, with
+    // a bias against changing it, like LSODE
+    unsigned int newQ = q;
+    Scalar newErr = bias(err, Scalar(6)/5, q);
+    if (q > 1) {
+      Scalar errLower = bias(error(q - 1, m_z[q]), Scalar(13)/10, q - 1);
+      if (longer(errLower, q - 1, newErr, q)) {
+        newQ = q - 1;
+        newErr = errLower;
+      }
+    }
+    if (q < m_maxOrder && m_eLastSet) {
+      m_delta = m_e - m_eLast;
+      Scalar errHigher = bias(error(q + 1, m_delta), Scalar(7)/5, q + 1);
+      if (longer(errHigher, q + 1, newErr, newQ)) {
+        newQ = q + 1;
+        newErr = errHigher;
+      }
+    }
+    m_eLastSet = false;
+
+    // Keep h and q unless it's worth at least 10% longer steps, to keep the
+    // factorization
+    Scalar newH = newErr == Scalar(0) ? Scalar(10)*h
+      : this->accept(h, newErr, newQ + 1);
+    if (newH < Scalar(11)/10*h) {
+      m_wait = 3;
+      return;
+    }
+
+    if (newQ > q) {
+      // z[q + 1] == h^(q + 1)*y^(q + 1)/(q + 1)!, from e
+      m_z[q + 1] = (m_l[q][q]/(q + 1))*m_e;
+      m_order = newQ;
+    } else if (newQ < q) {
+      lowerOrder();
+    }
+
+    this->h(std::min(newH, Scalar(10)*h));
+    m_wait = newQ + 1;
+  }
+
+  template <typename Y, typename F, typename J>
+  void
+  GenericBDFIntegrator<Y, F, J>::rescale(Scalar h)
+  {
+    Scalar eta = h/m_hz;
+    Scalar factor = eta;
+    for (unsigned int j = 1; j <= m_order; ++j) {
+      m_z[j] *= factor;
+      factor *= eta;
+    }
+    m_hz = h;
+    m_eLastSet = false;
+  }
+
+  template <typename Y, typename F, typename J>
+  void
+  GenericBDFIntegrator<Y, F, J>::lowerOrder()
+  {
+    // Subtract z[q] times t^2(t + 1)...(t + q - 2), which vanishes with its
+    // derivative at t == 0 and at t == -1, ..., -(q - 2), and cancels z[q]
+    unsigned int q = m_order;
+    Scalar w[s_maxOrder + 2] = { Scalar(0) };
+    w[2] = 1;
+    for (unsigned int i = 1; i + 2 <= q; ++i) {
+      for (unsigned int j = i + 2; j > 0; --j) {
+        w[j] = w[j]*i + w[j - 1];
+      }
+      w[0] *= i;
+    }
+    for (unsigned int j = 2; j < q; ++j) {
+      m_z[j] -= w[j]*m_z[q];
+    }
+    m_order = q - 1;
+  }
+
+  template <typename Y, typename F, typename J>
+  bool
+  GenericBDFIntegrator<Y, F, J>::correct(Scalar x, Scalar h)
+  {
+    unsigned int q = m_order;
+    Scalar l1 = m_l[q][1];
+    Scalar c = l1/h;
+    // The error estimate's weight on e
+    Scalar weight = Scalar(1)/(l1*(q + 1));
+
+    while (true) {
+      m_yNew = m_zPredicted[0];
+      m_e = Scalar(0)*m_yNew;
+      evaluate(m_f, x, m_yNew, m_f1);
+      this->evaluations(this->evaluations() + 1);
+
+      // Refactor if l[1]/h has changed too much, or the factorization is old
+      if (!m_luSet || m_luAge >= 20
+          || std::abs(m_c/c - Scalar(1)) > Scalar(3)/10) {
+        if (!factor(x, m_zPredicted[0], c)) {
+          return false;
+        }
+      }
+
+      // A factorization for a different c converges more slowly; CVODE's
+      // scaling of the correction makes up for some of that
+      Scalar scale = Scalar(1);
+      if (m_c != c) {
+        Scalar ratio = m_c/c;
+        scale = Scalar(2)*ratio/(Scalar(1) + ratio);
+      }
+
+      Scalar last = Scalar(0);
+      bool converged = false;
+      for (unsigned int i = 0; i < s_newtonIterations; ++i) {
+        if (i > 0) {
+          evaluate(m_f, x, m_yNew, m_f1);
+          this->evaluations(this->evaluations() + 1);
+        }
+        ++m_newtonIterations;
+
+        // (c*I - J)*delta == f(x, y) - (z[1] + l[1]*e)/h
+        m_delta = m_f1 - (m_zPredicted[1] + l1*m_e)*(Scalar(1)/h);
+        Algebra::solve(m_lu, m_delta);
+        if (scale != Scalar(1)) {
+          m_delta *= scale;
+        }
+        m_e += m_delta;
+        m_yNew = m_zPredicted[0] + m_e;
+
+        Scalar norm = this->errorNorm(m_delta, m_yNew, this->y());
+        if (i > 0) {
+          m_rate = std::max(m_rate*Scalar(3)/10, norm/last);
+        }
+        // Stop when the remaining error is well within the tolerance
+        if (norm*std::min(Scalar(1), m_rate)*weight <= Scalar(1)/10) {
+          converged = true;
+          break;
+        }
+        if (i > 0 && norm > Scalar(2)*last) {
+          break;
+        }
+        last = norm;
+      }
+
+      if (converged) {
+        return true;
+      }
+
+      // Try again with a new Jacobian, or at least a new factorization,
+      // before giving up
+      if (!m_jacobianCurrent) {
+        m_jacobianSet = false;
+      } else if (m_c == c) {
+        return false;
+      }
+      m_luSet = false;
+    }
+  }
+
+  template <typename Y, typename F, typename J>
+  bool
+  GenericBDFIntegrator<Y, F, J>::factor(Scalar x, const Y& y, Scalar c)
+  {
+    if (!m_jacobianSet || m_jacobianAge >= 50) {
+      std::size_t n = Algebra::size(y);
+      Algebra::resize(m_dfdy, n);
+      if (m_hasJacobian) {
+        Algebra::zero(m_dfdy);
+        m_delta = Scalar(0)*y;
+        m_jacobian(x, y, m_dfdy, m_delta);
+      } else {
+        differenceJacobian(m_f, x, y, m_f1, m_dfdy, m_yNew, m_delta);
+        m_yNew = y;
+        this->evaluations(this->evaluations() + n);
+      }
+      ++m_jacobians;
+      m_jacobianSet = true;
+      m_jacobianCurrent = true;
+      m_jacobianAge = 0;
+      m_rate = 1;
+    }
+
+    m_luSet = Algebra::factor(m_lu, c, m_dfdy);
+    if (!m_luSet) {
+      return false;
+    }
+    ++m_factorizations;
+    m_c = c;
+    m_luAge = 0;
+    return true;
+  }
+
+  template <typename Y, typename F, typename J>
+  inline typename GenericBDFIntegrator<Y, F, J>::Scalar
+  GenericBDFIntegrator<Y, F, J>::error(unsigned int k, const Y& d) const
+  {
+    // The local error of the order k BDF is
+    //   h^(k + 1)*y^(k + 1)/((k + 1)*l[k][1])
+    // where h^(k + 1)*y^(k + 1) is approximately e for k == q, q!*z[q] for
+    // k == q - 1, and the difference of the last two e for k == q + 1
+    Scalar weight = Scalar(1)/((k + 1)*m_l[k][1]);
+    if (k + 1 == m_order) {
+      weight *= m_factorial[m_order];
+    }
+    return weight*this->errorNorm(d, m_yNew, this->y());
+  }
+}
+
+#endif // VZ_BDF_HPP
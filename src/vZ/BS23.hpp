@@ -36,30 +36,35 @@ namespace vZ
   //   b   | 2/9  1/3 4/9 0
   //   b*  | 7/24 1/4 1/3 1/8
   template <typename Y>
-  class GenericBS23Integrator : public GenericAdaptiveIntegrator<Y>
+  class BS23Tableau
   {
   public:
-    typedef typename GenericAdaptiveIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericAdaptiveIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericBS23Integrator(Function f)
-      : GenericAdaptiveIntegrator<Y>(f, 3, s_a, s_b, s_bStar) { }
-    ~GenericBS23Integrator() { }
+    static const unsigned int s_stages = 4;
+    static const unsigned int s_order  = 3;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericAdaptiveIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericAdaptiveIntegrator<Y>::BCoefficients BCoefficients;
+    BS23Tableau();
+  };
+
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericBS23Integrator
+    : public GenericAdaptiveIntegrator<Y, BS23Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, BS23Tableau<Y>, F> Base;
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
-    static BCoefficients s_bStar;
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
 
-    static Scalar s_a2Arr[1];
-    static Scalar s_a3Arr[2];
-    static Scalar s_a4Arr[3];
-    static std::vector<Scalar> s_aArr[3];
-    static Scalar s_bArr[4];
-    static Scalar s_bStarArr[4];
+    GenericBS23Integrator(Function f) : Base(f) { }
+    ~GenericBS23Integrator() { }
   };
 
   // Type alias
@@ -68,36 +73,17 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericBS23Integrator<Y>::Scalar
-  GenericBS23Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)/Scalar(2)
-  };
-  template <typename Y>
-  typename GenericBS23Integrator<Y>::Scalar
-  GenericBS23Integrator<Y>::s_a3Arr[2] = {
-    Scalar(0), Scalar(3)/Scalar(4)
-  };
-  template <typename Y>
-  typename GenericBS23Integrator<Y>::Scalar
-  GenericBS23Integrator<Y>::s_a4Arr[3] = {
-    Scalar(2)/Scalar(9), Scalar(1)/Scalar(3), Scalar(4)/Scalar(9)
+  const typename BS23Tableau<Y>::Scalar
+  BS23Tableau<Y>::s_a[4][4] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(2) },
+    { Scalar(0), Scalar(3)/Scalar(4) },
+    { Scalar(2)/Scalar(9), Scalar(1)/Scalar(3), Scalar(4)/Scalar(9) }
   };
 
   template <typename Y>
-  std::vector<typename GenericBS23Integrator<Y>::Scalar>
-  GenericBS23Integrator<Y>::s_aArr[3] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1),
-    std::vector<Scalar>(s_a3Arr, s_a3Arr + 2),
-    std::vector<Scalar>(s_a4Arr, s_a4Arr + 3)
-  };
-
-  template <typename Y>
-  typename GenericBS23Integrator<Y>::ACoefficients
-  GenericBS23Integrator<Y>::s_a(s_aArr, s_aArr + 3);
-
-  template <typename Y>
-  typename GenericBS23Integrator<Y>::Scalar
-  GenericBS23Integrator<Y>::s_bArr[4] = {
+  const typename BS23Tableau<Y>::Scalar
+  BS23Tableau<Y>::s_b[4] = {
     Scalar(2)/Scalar(9),
     Scalar(1)/Scalar(3),
     Scalar(4)/Scalar(9),
@@ -105,12 +91,8 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericBS23Integrator<Y>::BCoefficients
-  GenericBS23Integrator<Y>::s_b(s_bArr, s_bArr + 4);
-
-  template <typename Y>
-  typename GenericBS23Integrator<Y>::Scalar
-  GenericBS23Integrator<Y>::s_bStarArr[4] = {
+  const typename BS23Tableau<Y>::Scalar
+  BS23Tableau<Y>::s_bStar[4] = {
     Scalar(7)/Scalar(24),
     Scalar(1)/Scalar(4),
     Scalar(1)/Scalar(3),
@@ -118,8 +100,13 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericBS23Integrator<Y>::BCoefficients
-  GenericBS23Integrator<Y>::s_bStar(s_bStarArr, s_bStarArr + 4);
+  const typename BS23Tableau<Y>::Scalar
+  BS23Tableau<Y>::s_c[4] = {
+    Scalar(0),
+    Scalar(1)/Scalar(2),
+    Scalar(3)/Scalar(4),
+    Scalar(1)
+  };
 }
 
 #endif // VZ_BS23_HPP
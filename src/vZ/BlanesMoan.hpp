@@ -0,0 +1,96 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_BLANESMOAN_HPP
+#define VZ_BLANESMOAN_HPP
+
+namespace vZ
+{
+  // Blanes and Moan's fourth-order method
+  //
+  // The six-stage symmetric splitting method S6 of Blanes and Moan (2002),
+  // which isn't a composition of Verlet steps.  Its error constants are so
+  // much smaller than those of the triple jump that it's more efficient
+  // despite costing twice as many force evaluations per step.
+  template <typename Q>
+  class BlanesMoanTableau
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    static const unsigned int s_stages = 6;
+    static const unsigned int s_order  = 4;
+
+    static const Scalar s_a[s_stages + 1];
+    static const Scalar s_b[s_stages];
+
+  private:
+    BlanesMoanTableau();
+  };
+
+  template <typename Q, typename P = Q,
+            typename V = typename PhaseSpace<Q, P>::VelocityFunction,
+            typename A = typename PhaseSpace<Q, P>::ForceFunction>
+  class GenericBlanesMoanIntegrator
+    : public GenericSymplecticIntegrator<Q, P, BlanesMoanTableau<Q>, V, A>
+  {
+    typedef GenericSymplecticIntegrator<Q, P, BlanesMoanTableau<Q>, V, A>
+      Base;
+
+  public:
+    typedef typename Base::VelocityFunction VelocityFunction;
+    typedef typename Base::ForceFunction    ForceFunction;
+
+    GenericBlanesMoanIntegrator(VelocityFunction velocity,
+                                ForceFunction force)
+      : Base(velocity, force) { }
+    ~GenericBlanesMoanIntegrator() { }
+  };
+
+  // Type alias
+  typedef GenericBlanesMoanIntegrator<double> BlanesMoanIntegrator;
+
+  // Implementation
+
+  template <typename Q>
+  const typename BlanesMoanTableau<Q>::Scalar
+  BlanesMoanTableau<Q>::s_a[7] = {
+    Scalar(0.0792036964311957),
+    Scalar(0.353172906049774),
+    Scalar(-0.0420650803577195),
+    Scalar(0.2193769557534996),
+    Scalar(-0.0420650803577195),
+    Scalar(0.353172906049774),
+    Scalar(0.0792036964311957)
+  };
+
+  template <typename Q>
+  const typename BlanesMoanTableau<Q>::Scalar
+  BlanesMoanTableau<Q>::s_b[6] = {
+    Scalar(0.209515106613362),
+    Scalar(-0.143851773179818),
+    Scalar(0.434336666566456),
+    Scalar(0.434336666566456),
+    Scalar(-0.143851773179818),
+    Scalar(0.209515106613362)
+  };
+}
+
+#endif // VZ_BLANESMOAN_HPP
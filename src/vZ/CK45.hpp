@@ -38,32 +38,35 @@ namespace vZ
   //   b     | 37/378      0        250/621     125/594      0         512/1771
   //   b*    | 2825/27648  0        18575/48384 13525/55296  277/14336 1/4
   template <typename Y>
-  class GenericCK45Integrator : public GenericAdaptiveIntegrator<Y>
+  class CK45Tableau
   {
   public:
-    typedef typename GenericAdaptiveIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericAdaptiveIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericCK45Integrator(Function f)
-      : GenericAdaptiveIntegrator<Y>(f, 5, s_a, s_b, s_bStar) { }
-    ~GenericCK45Integrator() { }
+    static const unsigned int s_stages = 6;
+    static const unsigned int s_order  = 5;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericAdaptiveIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericAdaptiveIntegrator<Y>::BCoefficients BCoefficients;
+    CK45Tableau();
+  };
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
-    static BCoefficients s_bStar;
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericCK45Integrator
+    : public GenericAdaptiveIntegrator<Y, CK45Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, CK45Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
 
-    static Scalar s_a2Arr[1];
-    static Scalar s_a3Arr[2];
-    static Scalar s_a4Arr[3];
-    static Scalar s_a5Arr[4];
-    static Scalar s_a6Arr[5];
-    static std::vector<Scalar> s_aArr[5];
-    static Scalar s_bArr[6];
-    static Scalar s_bStarArr[6];
+    GenericCK45Integrator(Function f) : Base(f) { }
+    ~GenericCK45Integrator() { }
   };
 
   // Type alias
@@ -72,72 +75,45 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)/Scalar(5)
-  };
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_a3Arr[2] = {
-    Scalar(3)/Scalar(40), Scalar(9)/Scalar(40)
-  };
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_a4Arr[3] = {
-     Scalar(3)/Scalar(10),
-    -Scalar(9)/Scalar(10),
-     Scalar(6)/Scalar(5)
-  };
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_a5Arr[4] = {
-    -Scalar(11)/Scalar(54),
-     Scalar(5)/Scalar(2),
-    -Scalar(70)/Scalar(27),
-     Scalar(35)/Scalar(27),
-  };
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_a6Arr[5] = {
-    Scalar(1631)/Scalar(55296),
-    Scalar(175)/Scalar(512),
-    Scalar(575)/Scalar(13824),
-    Scalar(44275)/Scalar(110592),
-    Scalar(253)/Scalar(4096)
-  };
-
-  template <typename Y>
-  std::vector<typename GenericCK45Integrator<Y>::Scalar>
-  GenericCK45Integrator<Y>::s_aArr[5] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1),
-    std::vector<Scalar>(s_a3Arr, s_a3Arr + 2),
-    std::vector<Scalar>(s_a4Arr, s_a4Arr + 3),
-    std::vector<Scalar>(s_a5Arr, s_a5Arr + 4),
-    std::vector<Scalar>(s_a6Arr, s_a6Arr + 5)
+  const typename CK45Tableau<Y>::Scalar
+  CK45Tableau<Y>::s_a[6][6] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(5) },
+    { Scalar(3)/Scalar(40), Scalar(9)/Scalar(40) },
+    {
+       Scalar(3)/Scalar(10),
+      -Scalar(9)/Scalar(10),
+       Scalar(6)/Scalar(5)
+    },
+    {
+      -Scalar(11)/Scalar(54),
+       Scalar(5)/Scalar(2),
+      -Scalar(70)/Scalar(27),
+       Scalar(35)/Scalar(27)
+    },
+    {
+      Scalar(1631)/Scalar(55296),
+      Scalar(175)/Scalar(512),
+      Scalar(575)/Scalar(13824),
+      Scalar(44275)/Scalar(110592),
+      Scalar(253)/Scalar(4096)
+    }
   };
 
   template <typename Y>
-  typename GenericCK45Integrator<Y>::ACoefficients
-  GenericCK45Integrator<Y>::s_a(s_aArr, s_aArr + 5);
-
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_bArr[6] = {
+  const typename CK45Tableau<Y>::Scalar
+  CK45Tableau<Y>::s_b[6] = {
     Scalar(37)/Scalar(378),
     Scalar(0),
     Scalar(250)/Scalar(621),
     Scalar(125)/Scalar(594),
     Scalar(0),
-    Scalar(512)/Scalar(1771),
+    Scalar(512)/Scalar(1771)
   };
 
   template <typename Y>
-  typename GenericCK45Integrator<Y>::BCoefficients
-  GenericCK45Integrator<Y>::s_b(s_bArr, s_bArr + 6);
-
-  template <typename Y>
-  typename GenericCK45Integrator<Y>::Scalar
-  GenericCK45Integrator<Y>::s_bStarArr[6] = {
+  const typename CK45Tableau<Y>::Scalar
+  CK45Tableau<Y>::s_bStar[6] = {
     Scalar(2825)/Scalar(27648),
     Scalar(0),
     Scalar(18575)/Scalar(48384),
@@ -147,8 +123,15 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericCK45Integrator<Y>::BCoefficients
-  GenericCK45Integrator<Y>::s_bStar(s_bStarArr, s_bStarArr + 6);
+  const typename CK45Tableau<Y>::Scalar
+  CK45Tableau<Y>::s_c[6] = {
+    Scalar(0),
+    Scalar(1)/Scalar(5),
+    Scalar(3)/Scalar(10),
+    Scalar(3)/Scalar(5),
+    Scalar(1),
+    Scalar(7)/Scalar(8)
+  };
 }
 
 #endif // VZ_CK45_HPP
@@ -0,0 +1,254 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_CONTROLLER_HPP
+#define VZ_CONTROLLER_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vZ
+{
+  // Step size controller for the adaptive integrators
+  //
+  // After a step of size h with error estimate err (scaled so that err <= 1
+  // is acceptable), the next step size is
+  //   S*h*err^(-b1/k)*err1^(-b2/k)*err2^(-b3/k)*(h/h1)^(-a2)*(h1/h2)^(-a3)
+  // where err1, err2, h1, and h2 belong to the previous two accepted steps,
+  // and k is the order of the error estimate.  This is Soderlind's digital
+  // filter form, which includes the elementary controller (b1 == 1), and
+  // Gustafsson's PI controller.  The new step size is then limited to
+  // [min*h, max*h].
+  //
+  // A rejected step is retried with the elementary controller, and doesn't
+  // enter the history.
+  template <typename Scalar>
+  class GenericStepController
+  {
+  public:
+    // The elementary controller, with S == 0.95 and no limits
+    GenericStepController();
+    // A filter with the given coefficients, S == 0.95, and limits of
+    // [0.2, 5]
+    GenericStepController(Scalar b1, Scalar b2, Scalar b3,
+                          Scalar a2, Scalar a3);
+
+    // h*err^(-1/k)
+    static GenericStepController elementary();
+    // Gustafsson's PI.3.4
+    static GenericStepController pi();
+    // Soderlind's H211b (b == 4) and H312b (b == 8) filters, which smooth
+    // the step size sequence.  They react slowly to the error, so they use
+    // S == 0.9 to keep rejections down.
+    static GenericStepController h211();
+    static GenericStepController h312();
+
+    GenericStepController& safety(Scalar S) { m_S = S; return *this; }
+    GenericStepController& limits(Scalar min, Scalar max)
+      { m_min = min; m_max = max; return *this; }
+
+    Scalar safety() const { return m_S; }
+    Scalar min()    const { return m_min; }
+    Scalar max()    const { return m_max; }
+
+    // The next step size after accepting or rejecting a step of size h
+    Scalar accept(Scalar h, Scalar err, unsigned int k);
+    Scalar reject(Scalar h, Scalar err, unsigned int k);
+
+    // Forget the history
+    void reset();
+
+  private:
+    Scalar limit(Scalar h, Scalar newH) const;
+
+    Scalar m_b1, m_b2, m_b3, m_a2, m_a3;
+    Scalar m_S, m_min, m_max;
+
+    // The last two accepted errors, the last accepted step size, and the
+    // ratio of the last two
+    Scalar m_err1, m_err2, m_h1, m_rho1;
+  };
+
+  // Type alias
+  typedef GenericStepController<double> StepController;
+
+  // Starting step size, after Hairer, Norsett, and Wanner (II.4)
+  //
+  // All the arguments are norms.  initialStepGuess() guesses h0 from y0 and
+  // f0 == f(x0, y0), relative to the error scale sc.  initialStep() refines
+  // it with df == f(x0 + h0, y0 + h0*f0) - f0, which estimates y'', for an
+  // error estimate of order k.
+  template <typename Scalar>
+  Scalar initialStepGuess(Scalar y0, Scalar f0, Scalar sc);
+  template <typename Scalar>
+  Scalar initialStep(Scalar h0, Scalar f0, Scalar df, Scalar sc,
+                     unsigned int k);
+
+  // Implementations
+
+  template <typename Scalar>
+  GenericStepController<Scalar>::GenericStepController()
+    : m_b1(1), m_b2(0), m_b3(0), m_a2(0), m_a3(0),
+      m_S(Scalar(19)/Scalar(20)), m_min(0),
+      m_max(std::numeric_limits<Scalar>::infinity())
+  {
+    reset();
+  }
+
+  template <typename Scalar>
+  GenericStepController<Scalar>::GenericStepController(Scalar b1, Scalar b2,
+                                                       Scalar b3, Scalar a2,
+                                                       Scalar a3)
+    : m_b1(b1), m_b2(b2), m_b3(b3), m_a2(a2), m_a3(a3),
+      m_S(Scalar(19)/Scalar(20)), m_min(Scalar(1)/Scalar(5)), m_max(5)
+  {
+    reset();
+  }
+
+  template <typename Scalar>
+  inline GenericStepController<Scalar>
+  GenericStepController<Scalar>::elementary()
+  {
+    return GenericStepController();
+  }
+
+  template <typename Scalar>
+  inline GenericStepController<Scalar>
+  GenericStepController<Scalar>::pi()
+  {
+    return GenericStepController(Scalar(7)/Scalar(10), Scalar(-2)/Scalar(5),
+                                 0, 0, 0);
+  }
+
+  template <typename Scalar>
+  inline GenericStepController<Scalar>
+  GenericStepController<Scalar>::h211()
+  {
+    return GenericStepController(Scalar(1)/Scalar(4), Scalar(1)/Scalar(4), 0,
+                                 Scalar(1)/Scalar(4), 0)
+      .safety(Scalar(9)/Scalar(10));
+  }
+
+  template <typename Scalar>
+  inline GenericStepController<Scalar>
+  GenericStepController<Scalar>::h312()
+  {
+    return GenericStepController(Scalar(1)/Scalar(8), Scalar(1)/Scalar(4),
+                                 Scalar(1)/Scalar(8), Scalar(3)/Scalar(8),
+                                 Scalar(1)/Scalar(8))
+      .safety(Scalar(9)/Scalar(10));
+  }
+
+  template <typename Scalar>
+  inline void
+  GenericStepController<Scalar>::reset()
+  {
+    // Missing history is treated as exactly on target
+    m_err1 = 1;
+    m_err2 = 1;
+    m_h1   = 0;
+    m_rho1 = 1;
+  }
+
+  template <typename Scalar>
+  inline Scalar
+  GenericStepController<Scalar>::accept(Scalar h, Scalar err, unsigned int k)
+  {
+    using std::pow;
+
+    // Skip the pow() calls for the terms which aren't used
+    Scalar rho = m_h1 == Scalar(0) ? Scalar(1) : h/m_h1;
+    Scalar factor = pow(err, -m_b1/k);
+    if (m_b2 != Scalar(0)) {
+      factor *= pow(m_err1, -m_b2/k);
+    }
+    if (m_b3 != Scalar(0)) {
+      factor *= pow(m_err2, -m_b3/k);
+    }
+    if (m_a2 != Scalar(0)) {
+      factor *= pow(rho, -m_a2);
+    }
+    if (m_a3 != Scalar(0)) {
+      factor *= pow(m_rho1, -m_a3);
+    }
+
+    m_err2 = m_err1;
+    m_err1 = err;
+    m_h1   = h;
+    m_rho1 = rho;
+
+    return limit(h, m_S*h*factor);
+  }
+
+  template <typename Scalar>
+  inline Scalar
+  GenericStepController<Scalar>::reject(Scalar h, Scalar err, unsigned int k)
+  {
+    using std::pow;
+    return limit(h, m_S*h*pow(err, -Scalar(1)/k));
+  }
+
+  template <typename Scalar>
+  inline Scalar
+  initialStepGuess(Scalar y0, Scalar f0, Scalar sc)
+  {
+    static const Scalar small = Scalar(1)/Scalar(100000);
+
+    Scalar d0 = y0/sc, d1 = f0/sc;
+    if (d0 < small || d1 < small) {
+      return Scalar(1)/Scalar(1000000);
+    } else {
+      return d0/d1/Scalar(100);
+    }
+  }
+
+  template <typename Scalar>
+  inline Scalar
+  initialStep(Scalar h0, Scalar f0, Scalar df, Scalar sc, unsigned int k)
+  {
+    using std::pow;
+
+    // The larger of |y'| and |y''|, which the first step must resolve
+    Scalar d = std::max(f0/sc, df/sc/h0);
+    Scalar h1;
+    if (d <= std::numeric_limits<Scalar>::epsilon()) {
+      h1 = std::max(Scalar(1)/Scalar(1000000), h0/Scalar(1000));
+    } else {
+      h1 = pow(Scalar(1)/Scalar(100)/d, Scalar(1)/k);
+    }
+    return std::min(Scalar(100)*h0, h1);
+  }
+
+  template <typename Scalar>
+  inline Scalar
+  GenericStepController<Scalar>::limit(Scalar h, Scalar newH) const
+  {
+    if (newH < m_min*h) {
+      return m_min*h;
+    } else if (newH > m_max*h) {
+      return m_max*h;
+    } else {
+      return newH;
+    }
+  }
+}
+
+#endif // VZ_CONTROLLER_HPP
@@ -0,0 +1,460 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_DOP853_HPP
+#define VZ_DOP853_HPP
+
+namespace vZ
+{
+  // Dormand-Prince 8(5,3) method, as in Hairer and Wanner's DOP853
+  //
+  // Eighth-order with 12 stages, and embedded fifth- and third-order
+  // solutions.  The fifth-order one is b*, and the third-order one is given
+  // by ErrorEstimate.  The coefficients are irrational, so they're given to
+  // 30 digits rather than as a tableau.
+  template <typename Y>
+  class DOP853Tableau
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+
+    static const unsigned int s_stages = 12;
+    static const unsigned int s_order  = 8;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
+
+  private:
+    DOP853Tableau();
+  };
+
+  // The fifth- and third-order error estimates are combined as
+  //   err5^2/sqrt(err5^2 + err3^2/100)
+  // which behaves like an eighth-order estimate, and is only small when both
+  // of them are.
+  template <typename Y>
+  class ErrorEstimate<DOP853Tableau<Y> >
+  {
+  public:
+    typedef typename DOP853Tableau<Y>::Scalar Scalar;
+
+    static const bool s_combined = true;
+    static const Scalar s_d[12];
+
+    static Scalar combine(Scalar err5, Scalar err3);
+
+  private:
+    ErrorEstimate();
+  };
+
+  // Dormand and Prince's seventh-order continuous extension, with three
+  // extra stages:
+  //   y(x0 + theta*h) == y0 + theta*(r2 + (1 - theta)*(r3 + theta*(r4
+  //                        + (1 - theta)*(r5 + theta*(r6 + (1 - theta)*(r7
+  //                        + theta*r8))))))
+  // where r2 == dy == y1 - y0, r3 == h*k1 - dy, r4 == dy - h*f1 - r3, and
+  // r5..r8 == h*(d[j][0]*k[0] + ...), over the stages, f1, and the extra
+  // stages in that order.
+  template <typename Y>
+  class DenseOutput<DOP853Tableau<Y> >
+  {
+  public:
+    typedef typename DOP853Tableau<Y>::Scalar Scalar;
+
+    static const unsigned int s_order = 7;
+    static const unsigned int s_extraStages = 3;
+
+    static const Scalar s_a[3][16];
+    static const Scalar s_c[3];
+
+    static void weights(Scalar theta, Scalar w[], Scalar& wf);
+
+  private:
+    DenseOutput();
+
+    static const Scalar s_d[4][16];
+  };
+
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericDOP853Integrator
+    : public GenericAdaptiveIntegrator<Y, DOP853Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, DOP853Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericDOP853Integrator(Function f) : Base(f) { }
+    ~GenericDOP853Integrator() { }
+  };
+
+  // Type alias
+  typedef GenericDOP853Integrator<double> DOP853Integrator;
+
+  // Implementation
+
+  template <typename Y>
+  const typename DOP853Tableau<Y>::Scalar
+  DOP853Tableau<Y>::s_a[12][12] = {
+    { Scalar(0) },
+    { Scalar(5.26001519587677318785587544488e-2) },
+    {
+      Scalar(1.97250569845378994544595329183e-2),
+      Scalar(5.91751709536136983633785987549e-2)
+    },
+    {
+      Scalar(2.95875854768068491816892993775e-2),
+      Scalar(0),
+      Scalar(8.87627564304205475450678981324e-2)
+    },
+    {
+       Scalar(2.41365134159266685502369798665e-1),
+       Scalar(0),
+      -Scalar(8.84549479328286085344864962717e-1),
+       Scalar(9.24834003261792003115737966543e-1)
+    },
+    {
+      Scalar(3.7037037037037037037037037037e-2),
+      Scalar(0),
+      Scalar(0),
+      Scalar(1.70828608729473871279604482173e-1),
+      Scalar(1.25467687566822425016691814123e-1)
+    },
+    {
+       Scalar(3.7109375e-2),
+       Scalar(0),
+       Scalar(0),
+       Scalar(1.70252211019544039314978060272e-1),
+       Scalar(6.02165389804559606850219397283e-2),
+      -Scalar(1.7578125e-2)
+    },
+    {
+       Scalar(3.70920001185047927108779319836e-2),
+       Scalar(0),
+       Scalar(0),
+       Scalar(1.70383925712239993810214054705e-1),
+       Scalar(1.07262030446373284651809199168e-1),
+      -Scalar(1.53194377486244017527936158236e-2),
+       Scalar(8.27378916381402288758473766002e-3)
+    },
+    {
+       Scalar(6.24110958716075717114429577812e-1),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(3.36089262944694129406857109825),
+      -Scalar(8.68219346841726006818189891453e-1),
+       Scalar(2.75920996994467083049415600797e1),
+       Scalar(2.01540675504778934086186788979e1),
+      -Scalar(4.34898841810699588477366255144e1)
+    },
+    {
+       Scalar(4.77662536438264365890433908527e-1),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(2.48811461997166764192642586468),
+      -Scalar(5.90290826836842996371446475743e-1),
+       Scalar(2.12300514481811942347288949897e1),
+       Scalar(1.52792336328824235832596922938e1),
+      -Scalar(3.32882109689848629194453265587e1),
+      -Scalar(2.03312017085086261358222928593e-2)
+    },
+    {
+      -Scalar(9.3714243008598732571704021658e-1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(5.18637242884406370830023853209),
+       Scalar(1.09143734899672957818500254654),
+      -Scalar(8.14978701074692612513997267357),
+      -Scalar(1.85200656599969598641566180701e1),
+       Scalar(2.27394870993505042818970056734e1),
+       Scalar(2.49360555267965238987089396762),
+      -Scalar(3.0467644718982195003823669022)
+    },
+    {
+       Scalar(2.27331014751653820792359768449),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(1.05344954667372501984066689879e1),
+      -Scalar(2.00087205822486249909675718444),
+      -Scalar(1.79589318631187989172765950534e1),
+       Scalar(2.79488845294199600508499808837e1),
+      -Scalar(2.85899827713502369474065508674),
+      -Scalar(8.87285693353062954433549289258),
+       Scalar(1.23605671757943030647266201528e1),
+       Scalar(6.43392746015763530355970484046e-1)
+    }
+  };
+
+  template <typename Y>
+  const typename DOP853Tableau<Y>::Scalar
+  DOP853Tableau<Y>::s_b[12] = {
+     Scalar(5.42937341165687622380535766363e-2),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(4.45031289275240888144113950566),
+     Scalar(1.89151789931450038304281599044),
+    -Scalar(5.8012039600105847814672114227),
+     Scalar(3.1116436695781989440891606237e-1),
+    -Scalar(1.52160949662516078556178806805e-1),
+     Scalar(2.01365400804030348374776537501e-1),
+     Scalar(4.47106157277725905176885569043e-2)
+  };
+
+  template <typename Y>
+  const typename DOP853Tableau<Y>::Scalar
+  DOP853Tableau<Y>::s_bStar[12] = {
+     Scalar(4.11736891223738815055525466763e-2),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(5.67546933912861332216170925866),
+     Scalar(2.38727684897175057456422398564),
+    -Scalar(7.4655811424655713184287418377),
+     Scalar(6.6149321570779357609756479137e-1),
+    -Scalar(4.86340068375533557585910690905e-1),
+     Scalar(1.19442194318914635909069111371e-1),
+     Scalar(6.70659235916588857765328353543e-2)
+  };
+
+  template <typename Y>
+  const typename DOP853Tableau<Y>::Scalar
+  DOP853Tableau<Y>::s_c[12] = {
+    Scalar(0),
+    Scalar(5.26001519587677318785587544488e-2),
+    Scalar(7.89002279381515978178381316732e-2),
+    Scalar(1.18350341907227396726757197510e-1),
+    Scalar(2.81649658092772603273242802490e-1),
+    Scalar(1)/Scalar(3),
+    Scalar(1)/Scalar(4),
+    Scalar(4)/Scalar(13),
+    Scalar(127)/Scalar(195),
+    Scalar(3)/Scalar(5),
+    Scalar(6)/Scalar(7),
+    Scalar(1)
+  };
+
+  // b - bHat, where bHat is the third-order solution
+  template <typename Y>
+  const typename ErrorEstimate<DOP853Tableau<Y> >::Scalar
+  ErrorEstimate<DOP853Tableau<Y> >::s_d[12] = {
+    -Scalar(1.898007540724076157147023288757e-1),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(0),
+     Scalar(4.45031289275240888144113950566),
+     Scalar(1.89151789931450038304281599044),
+    -Scalar(5.8012039600105847814672114227),
+    -Scalar(4.22682321323791962932445679177e-1),
+    -Scalar(1.52160949662516078556178806805e-1),
+     Scalar(2.01365400804030348374776537501e-1),
+     Scalar(2.26517921983608258118062039631e-2)
+  };
+
+  template <typename Y>
+  inline typename ErrorEstimate<DOP853Tableau<Y> >::Scalar
+  ErrorEstimate<DOP853Tableau<Y> >::combine(Scalar err5, Scalar err3)
+  {
+    using std::sqrt;
+    Scalar err5sq = err5*err5;
+    return err5sq/sqrt(err5sq + err3*err3/Scalar(100));
+  }
+
+  template <typename Y>
+  const typename DenseOutput<DOP853Tableau<Y> >::Scalar
+  DenseOutput<DOP853Tableau<Y> >::s_a[3][16] = {
+    {
+       Scalar(5.61675022830479523392909219681e-2),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(2.53500210216624811088794765333e-1),
+      -Scalar(2.46239037470802489917441475441e-1),
+      -Scalar(1.24191423263816360469010140626e-1),
+       Scalar(1.5329179827876569731206322685e-1),
+       Scalar(8.20105229563468988491666602057e-3),
+       Scalar(7.56789766054569976138603589584e-3),
+      -Scalar(8.298e-3)
+    },
+    {
+       Scalar(3.18346481635021405060768473261e-2),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(2.83009096723667755288322961402e-2),
+       Scalar(5.35419883074385676223797384372e-2),
+      -Scalar(5.49237485713909884646569340306e-2),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(1.08347328697249322858509316994e-4),
+       Scalar(3.82571090835658412954920192323e-4),
+      -Scalar(3.40465008687404560802977114492e-4),
+       Scalar(1.41312443674632500278074618366e-1)
+    },
+    {
+      -Scalar(4.28896301583791923408573538692e-1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(4.69762141536116384314449447206),
+       Scalar(7.68342119606259904184240953878),
+       Scalar(4.06898981839711007970213554331),
+       Scalar(3.56727187455281109270669543021e-1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(1.39902416515901462129418009734e-3),
+       Scalar(2.9475147891527723389556272149),
+      -Scalar(9.15095847217987001081870187138)
+    }
+  };
+
+  template <typename Y>
+  const typename DenseOutput<DOP853Tableau<Y> >::Scalar
+  DenseOutput<DOP853Tableau<Y> >::s_c[3] = {
+    Scalar(1)/Scalar(10),
+    Scalar(1)/Scalar(5),
+    Scalar(7)/Scalar(9)
+  };
+
+  template <typename Y>
+  const typename DenseOutput<DOP853Tableau<Y> >::Scalar
+  DenseOutput<DOP853Tableau<Y> >::s_d[4][16] = {
+    {
+      -Scalar(8.4289382761090128651353491142),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(5.667149535193777696253178359e-1),
+      -Scalar(3.0689499459498916912797304727),
+       Scalar(2.384667656512069828772814968),
+       Scalar(2.1170345824450282767155149946),
+      -Scalar(8.713915837779729920678990749e-1),
+       Scalar(2.240437430260788275854177165),
+       Scalar(6.315787787694688181557024929e-1),
+      -Scalar(8.89903364513333108206981174e-2),
+       Scalar(1.8148505520854727256656404962e1),
+      -Scalar(9.1946323924783554000451984436),
+      -Scalar(4.4360363875948939664310572)
+    },
+    {
+       Scalar(1.0427508642579134603413151009e1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(2.4228349177525818288430175319e2),
+       Scalar(1.6520045171727028198505394887e2),
+      -Scalar(3.7454675472269020279518312152e2),
+      -Scalar(2.2113666853125306036270938578e1),
+       Scalar(7.7334326684722638389603898808),
+      -Scalar(3.0674084731089398182061213626e1),
+      -Scalar(9.3321305264302278729567221706),
+       Scalar(1.5697238121770843886131091075e1),
+      -Scalar(3.1139403219565177677282850411e1),
+      -Scalar(9.3529243588444783865713862664),
+       Scalar(3.581684148639408375246589854e1)
+    },
+    {
+       Scalar(1.9985053242002433820987653617e1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(3.8703730874935176555105901742e2),
+      -Scalar(1.8917813819516756882830838328e2),
+       Scalar(5.2780815920542364900561016686e2),
+      -Scalar(1.1573902539959630126141871134e1),
+       Scalar(6.8812326946963000169666922661),
+      -Scalar(1.000605096691083840318386098),
+       Scalar(7.777137798053443209286926574e-1),
+      -Scalar(2.7782057523535084065932004339),
+      -Scalar(6.0196695231264120758267380846e1),
+       Scalar(8.4320405506677161018159903784e1),
+       Scalar(1.199229113618278932803513003e1)
+    },
+    {
+      -Scalar(2.5693933462703749003312586129e1),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+       Scalar(0),
+      -Scalar(1.5418974869023643374053993627e2),
+      -Scalar(2.3152937917604549567536039109e2),
+       Scalar(3.576391179106141237828534991e2),
+       Scalar(9.3405324183624310003907691704e1),
+      -Scalar(3.7458323136451633156875139351e1),
+       Scalar(1.0409964950896230045147246184e2),
+       Scalar(2.9840293426660503123344363579e1),
+      -Scalar(4.3533456590011143754432175058e1),
+       Scalar(9.63245539591882829483949506e1),
+      -Scalar(3.9177261675615439165231486172e1),
+      -Scalar(1.4972683625798562581422125276e2)
+    }
+  };
+
+  template <typename Y>
+  inline void
+  DenseOutput<DOP853Tableau<Y> >::weights(Scalar theta, Scalar w[],
+                                          Scalar& wf)
+  {
+    typedef DOP853Tableau<Y> Tableau;
+
+    // The coefficients of r2..r8
+    Scalar theta1 = Scalar(1) - theta;
+    Scalar c2 = theta;
+    Scalar c3 = theta*theta1;
+    Scalar c4 = theta*c3;
+    Scalar c5 = theta1*c4;
+    Scalar c6 = theta*c5;
+    Scalar c7 = theta1*c6;
+    Scalar c8 = theta*c7;
+
+    // The coefficient of dy == h*(b . k)
+    Scalar dy = c2 - c3 + Scalar(2)*c4;
+
+    Scalar r[16];
+    for (unsigned int i = 0; i < 16; ++i) {
+      r[i] = c5*s_d[0][i] + c6*s_d[1][i] + c7*s_d[2][i] + c8*s_d[3][i];
+    }
+
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      w[i] = dy*Tableau::s_b[i] + r[i];
+    }
+    w[0] += c3 - c4;
+    wf = r[12] - c4;
+    for (unsigned int i = 0; i < 3; ++i) {
+      w[Tableau::s_stages + i] = r[13 + i];
+    }
+  }
+}
+
+#endif // VZ_DOP853_HPP
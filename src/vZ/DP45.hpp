@@ -39,101 +39,102 @@ namespace vZ
   //   b    | 35/384      0          500/1113    125/192  -2187/6784    11/84    0
   //   b*   | 5179/57600  0          7571/16695  393/640  -92097/339200 172/2100 1/40
   template <typename Y>
-  class GenericDP45Integrator : public GenericAdaptiveIntegrator<Y>
+  class DP45Tableau
   {
   public:
-    typedef typename GenericAdaptiveIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericAdaptiveIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericDP45Integrator(Function f)
-      : GenericAdaptiveIntegrator<Y>(f, 5, s_a, s_b, s_bStar) { }
-    ~GenericDP45Integrator() { }
+    static const unsigned int s_stages = 7;
+    static const unsigned int s_order  = 5;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericAdaptiveIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericAdaptiveIntegrator<Y>::BCoefficients BCoefficients;
-
-    static ACoefficients s_a;
-    static BCoefficients s_b;
-    static BCoefficients s_bStar;
-
-    static Scalar s_a2Arr[1];
-    static Scalar s_a3Arr[2];
-    static Scalar s_a4Arr[3];
-    static Scalar s_a5Arr[4];
-    static Scalar s_a6Arr[5];
-    static Scalar s_a7Arr[6];
-    static std::vector<Scalar> s_aArr[6];
-    static Scalar s_bArr[7];
-    static Scalar s_bStarArr[7];
+    DP45Tableau();
   };
 
-  // Type alias
-  typedef GenericDP45Integrator<double> DP45Integrator;
+  // Dormand and Prince's fourth-order continuous extension, from Hairer and
+  // Wanner's DOPRI5:
+  //   y(x0 + theta*h) == y0 + theta*(dy + (1 - theta)*(r3 + theta*(r4
+  //                                       + (1 - theta)*r5)))
+  // where dy == y1 - y0, r3 == h*k1 - dy, r4 == dy - h*k7 - r3, and
+  // r5 == h*(d[0]*k[0] + ... + d[6]*k[6]).  f1 is k7, so wf is always 0.
+  template <typename Y>
+  class DenseOutput<DP45Tableau<Y> >
+  {
+  public:
+    typedef typename DP45Tableau<Y>::Scalar Scalar;
 
-  // Implementation
+    static const unsigned int s_order = 4;
+    static const unsigned int s_extraStages = 0;
 
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)/Scalar(5)
-  };
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a3Arr[2] = {
-    Scalar(3)/Scalar(40), Scalar(9)/Scalar(40)
-  };
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a4Arr[3] = {
-     Scalar(44)/Scalar(45), -Scalar(56)/Scalar(15), Scalar(32)/Scalar(9)
-  };
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a5Arr[4] = {
-     Scalar(19372)/Scalar(6561),
-    -Scalar(25360)/Scalar(2187),
-     Scalar(64448)/Scalar(6561),
-    -Scalar(212)/Scalar(729),
-  };
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a6Arr[5] = {
-     Scalar(9017)/Scalar(3168),
-    -Scalar(355)/Scalar(33),
-     Scalar(46732)/Scalar(5247),
-     Scalar(49)/Scalar(176),
-    -Scalar(5103)/Scalar(18656)
-  };
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_a7Arr[6] = {
-     Scalar(35)/Scalar(384),
-     Scalar(0),
-     Scalar(500)/Scalar(1113),
-     Scalar(125)/Scalar(192),
-    -Scalar(2187)/Scalar(6784),
-     Scalar(11)/Scalar(84)
+    static void weights(Scalar theta, Scalar w[], Scalar& wf);
+
+  private:
+    DenseOutput();
+
+    static const Scalar s_d[7];
   };
 
-  template <typename Y>
-  std::vector<typename GenericDP45Integrator<Y>::Scalar>
-  GenericDP45Integrator<Y>::s_aArr[6] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1),
-    std::vector<Scalar>(s_a3Arr, s_a3Arr + 2),
-    std::vector<Scalar>(s_a4Arr, s_a4Arr + 3),
-    std::vector<Scalar>(s_a5Arr, s_a5Arr + 4),
-    std::vector<Scalar>(s_a6Arr, s_a6Arr + 5),
-    std::vector<Scalar>(s_a7Arr, s_a7Arr + 6)
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericDP45Integrator
+    : public GenericAdaptiveIntegrator<Y, DP45Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, DP45Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericDP45Integrator(Function f) : Base(f) { }
+    ~GenericDP45Integrator() { }
   };
 
+  // Type alias
+  typedef GenericDP45Integrator<double> DP45Integrator;
+
+  // Implementation
+
   template <typename Y>
-  typename GenericDP45Integrator<Y>::ACoefficients
-  GenericDP45Integrator<Y>::s_a(s_aArr, s_aArr + 6);
+  const typename DP45Tableau<Y>::Scalar
+  DP45Tableau<Y>::s_a[7][7] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(5) },
+    { Scalar(3)/Scalar(40), Scalar(9)/Scalar(40) },
+    {
+       Scalar(44)/Scalar(45),
+      -Scalar(56)/Scalar(15),
+       Scalar(32)/Scalar(9)
+    },
+    {
+       Scalar(19372)/Scalar(6561),
+      -Scalar(25360)/Scalar(2187),
+       Scalar(64448)/Scalar(6561),
+      -Scalar(212)/Scalar(729)
+    },
+    {
+       Scalar(9017)/Scalar(3168),
+      -Scalar(355)/Scalar(33),
+       Scalar(46732)/Scalar(5247),
+       Scalar(49)/Scalar(176),
+      -Scalar(5103)/Scalar(18656)
+    },
+    {
+       Scalar(35)/Scalar(384),
+       Scalar(0),
+       Scalar(500)/Scalar(1113),
+       Scalar(125)/Scalar(192),
+      -Scalar(2187)/Scalar(6784),
+       Scalar(11)/Scalar(84)
+    }
+  };
 
   template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_bArr[7] = {
+  const typename DP45Tableau<Y>::Scalar
+  DP45Tableau<Y>::s_b[7] = {
      Scalar(35)/Scalar(384),
      Scalar(0),
      Scalar(500)/Scalar(1113),
@@ -144,12 +145,8 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericDP45Integrator<Y>::BCoefficients
-  GenericDP45Integrator<Y>::s_b(s_bArr, s_bArr + 7);
-
-  template <typename Y>
-  typename GenericDP45Integrator<Y>::Scalar
-  GenericDP45Integrator<Y>::s_bStarArr[7] = {
+  const typename DP45Tableau<Y>::Scalar
+  DP45Tableau<Y>::s_bStar[7] = {
      Scalar(5179)/Scalar(57600),
      Scalar(0),
      Scalar(7571)/Scalar(16695),
@@ -160,8 +157,50 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericDP45Integrator<Y>::BCoefficients
-  GenericDP45Integrator<Y>::s_bStar(s_bStarArr, s_bStarArr + 7);
+  const typename DP45Tableau<Y>::Scalar
+  DP45Tableau<Y>::s_c[7] = {
+    Scalar(0),
+    Scalar(1)/Scalar(5),
+    Scalar(3)/Scalar(10),
+    Scalar(4)/Scalar(5),
+    Scalar(8)/Scalar(9),
+    Scalar(1),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename DenseOutput<DP45Tableau<Y> >::Scalar
+  DenseOutput<DP45Tableau<Y> >::s_d[7] = {
+    -Scalar(12715105075.0)/Scalar(11282082432.0),
+     Scalar(0),
+     Scalar(87487479700.0)/Scalar(32700410799.0),
+    -Scalar(10690763975.0)/Scalar(1880347072.0),
+     Scalar(701980252875.0)/Scalar(199316789632.0),
+    -Scalar(1453857185.0)/Scalar(822651844.0),
+     Scalar(69997945.0)/Scalar(29380423.0)
+  };
+
+  template <typename Y>
+  inline void
+  DenseOutput<DP45Tableau<Y> >::weights(Scalar theta, Scalar w[], Scalar& wf)
+  {
+    typedef DP45Tableau<Y> Tableau;
+
+    Scalar theta1 = Scalar(1) - theta;
+    Scalar a = theta;
+    Scalar b = theta*theta1;
+    Scalar c = theta*b;
+    Scalar d = b*b;
+
+    // The coefficient of dy == h*(b . k)
+    Scalar dy = a - b + Scalar(2)*c;
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      w[i] = dy*Tableau::s_b[i] + d*s_d[i];
+    }
+    w[0] += b - c;
+    w[6] -= c;
+    wf = Scalar(0);
+  }
 }
 
 #endif // VZ_DP45_HPP
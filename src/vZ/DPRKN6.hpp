@@ -0,0 +1,164 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_DPRKN6_HPP
+#define VZ_DPRKN6_HPP
+
+namespace vZ
+{
+  // Dormand, El-Mikkawy, and Prince's RKN6(4)6FM method
+  //
+  // Sixth-order Runge-Kutta-Nystrom method with embedded fourth-order, and
+  // six stages, the last of which is FSAL, so a step costs five
+  // evaluations of f.  Its tableau is:
+  //
+  //   0     |
+  //   1/10  | 1/200
+  //   3/10  | -1/2200 1/22
+  //   7/10  | 637/6600 -7/110 7/33
+  //   17/25 | 225437/1968750 -30073/281250 65569/281250 -9367/984375
+  //   1     | 151/2142 5/116 385/1368 55/168 -6250/28101
+  //   ------+--------------------------------------------------------------
+  //   bBar  | 151/2142 5/116 385/1368 55/168 -6250/28101 0
+  //   b     | 151/2142 25/522 275/684 275/252 -78125/112404 1/12
+  //   bBar* | 1349/157500 7873/50000 192199/900000 521683/2100000 -16/125 0
+  //   b*    | 1349/157500 7873/45000 27457/90000 521683/630000 -2/5 1/12
+  template <typename Y>
+  class DPRKN6Tableau
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+
+    static const unsigned int s_stages     = 6;
+    static const unsigned int s_order      = 6;
+    static const unsigned int s_errorOrder = 5;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_c[s_stages];
+    static const Scalar s_bBar[s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bBarStar[s_stages];
+    static const Scalar s_bStar[s_stages];
+
+  private:
+    DPRKN6Tableau();
+  };
+
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericDPRKN6Integrator
+    : public GenericRKNIntegrator<Y, DPRKN6Tableau<Y>, F>
+  {
+    typedef GenericRKNIntegrator<Y, DPRKN6Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Function Function;
+
+    GenericDPRKN6Integrator(Function f) : Base(f) { }
+    ~GenericDPRKN6Integrator() { }
+  };
+
+  // Type alias
+  typedef GenericDPRKN6Integrator<double> DPRKN6Integrator;
+
+  // Implementation
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_a[6][6] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(200) },
+    { -Scalar(1)/Scalar(2200), Scalar(1)/Scalar(22) },
+    {
+       Scalar(637)/Scalar(6600),
+      -Scalar(7)/Scalar(110),
+       Scalar(7)/Scalar(33)
+    },
+    {
+       Scalar(225437)/Scalar(1968750),
+      -Scalar(30073)/Scalar(281250),
+       Scalar(65569)/Scalar(281250),
+      -Scalar(9367)/Scalar(984375)
+    },
+    {
+       Scalar(151)/Scalar(2142),
+       Scalar(5)/Scalar(116),
+       Scalar(385)/Scalar(1368),
+       Scalar(55)/Scalar(168),
+      -Scalar(6250)/Scalar(28101)
+    }
+  };
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_c[6] = {
+    Scalar(0),
+    Scalar(1)/Scalar(10),
+    Scalar(3)/Scalar(10),
+    Scalar(7)/Scalar(10),
+    Scalar(17)/Scalar(25),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_bBar[6] = {
+     Scalar(151)/Scalar(2142),
+     Scalar(5)/Scalar(116),
+     Scalar(385)/Scalar(1368),
+     Scalar(55)/Scalar(168),
+    -Scalar(6250)/Scalar(28101),
+     Scalar(0)
+  };
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_b[6] = {
+     Scalar(151)/Scalar(2142),
+     Scalar(25)/Scalar(522),
+     Scalar(275)/Scalar(684),
+     Scalar(275)/Scalar(252),
+    -Scalar(78125)/Scalar(112404),
+     Scalar(1)/Scalar(12)
+  };
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_bBarStar[6] = {
+     Scalar(1349)/Scalar(157500),
+     Scalar(7873)/Scalar(50000),
+     Scalar(192199)/Scalar(900000),
+     Scalar(521683)/Scalar(2100000),
+    -Scalar(16)/Scalar(125),
+     Scalar(0)
+  };
+
+  template <typename Y>
+  const typename DPRKN6Tableau<Y>::Scalar
+  DPRKN6Tableau<Y>::s_bStar[6] = {
+     Scalar(1349)/Scalar(157500),
+     Scalar(7873)/Scalar(45000),
+     Scalar(27457)/Scalar(90000),
+     Scalar(521683)/Scalar(630000),
+    -Scalar(2)/Scalar(5),
+     Scalar(1)/Scalar(12)
+  };
+}
+
+#endif // VZ_DPRKN6_HPP
@@ -0,0 +1,447 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_DYNAMICEQUATIONSYSTEM_HPP
+#define VZ_DYNAMICEQUATIONSYSTEM_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+namespace vZ
+{
+  // A system of ODEs whose size is only known at runtime
+  //
+  // The values live in a single cache-line aligned heap block, which is only
+  // reallocated when the size changes.  Arithmetic is lazily evaluated like
+  // for EquationSystem, so once an integrator's stage buffers have been
+  // sized by its first step, stepping doesn't allocate any memory (except
+  // whatever f(x, y) itself does).
+  template <typename T = double>
+  class DynamicEquationSystem
+    : public Expression<DynamicEquationSystem<T>, DynamicEquationSystem<T> >
+  {
+  public:
+    typedef typename Traits<T>::Scalar Scalar;
+    typedef T                          Value;
+
+    DynamicEquationSystem() : m_size(0), m_storage(0), m_values(0) { }
+    explicit DynamicEquationSystem(std::size_t n, const T& value = T());
+    DynamicEquationSystem(const DynamicEquationSystem& es);
+    template <typename E>
+    DynamicEquationSystem(const Expression<E, DynamicEquationSystem>& e);
+#if __cplusplus >= 201103L
+    DynamicEquationSystem(DynamicEquationSystem&& es);
+#endif
+    ~DynamicEquationSystem() { deallocate(); }
+
+    std::size_t size() const { return m_size; }
+    // Changes the size, resetting every value if it differs
+    void resize(std::size_t n, const T& value = T());
+    void swap(DynamicEquationSystem& es);
+
+    T&       operator[](std::size_t i)       { return m_values[i]; }
+    const T& operator[](std::size_t i) const { return m_values[i]; }
+
+    T*       data()       { return m_values; }
+    const T* data() const { return m_values; }
+
+    DynamicEquationSystem& operator=(const DynamicEquationSystem& rhs);
+#if __cplusplus >= 201103L
+    DynamicEquationSystem& operator=(DynamicEquationSystem&& rhs);
+#endif
+    template <typename E>
+    DynamicEquationSystem&
+    operator=(const Expression<E, DynamicEquationSystem>& rhs);
+    template <typename E>
+    DynamicEquationSystem&
+    operator+=(const Expression<E, DynamicEquationSystem>& rhs);
+    template <typename E>
+    DynamicEquationSystem&
+    operator-=(const Expression<E, DynamicEquationSystem>& rhs);
+    // y += a*x and y -= a*x get a dedicated kernel
+    DynamicEquationSystem& operator+=(
+      const ScaledExpression<DynamicEquationSystem, DynamicEquationSystem>& rhs
+    );
+    DynamicEquationSystem& operator-=(
+      const ScaledExpression<DynamicEquationSystem, DynamicEquationSystem>& rhs
+    );
+    DynamicEquationSystem& operator*=(Scalar rhs);
+    DynamicEquationSystem& operator/=(Scalar rhs);
+
+  private:
+    static const std::size_t s_cacheLine = 64;
+
+    std::size_t m_size;
+    void*       m_storage; // The block from operator new
+    T*          m_values;  // The aligned values within m_storage
+
+    void allocate(std::size_t n, const T& value);
+    void deallocate();
+  };
+
+  // Traits specialization
+  template <typename T>
+  class Traits<DynamicEquationSystem<T> >
+  {
+  public:
+    typedef typename Traits<T>::Scalar Scalar;
+
+  private:
+    Traits();
+  };
+
+  // LinearAlgebra specialization, for systems of scalars
+  template <typename T>
+  class LinearAlgebra<DynamicEquationSystem<T> >
+  {
+  public:
+    typedef typename Traits<T>::Scalar Scalar;
+    typedef DynamicEquationSystem<T>   Y;
+    typedef Matrix<0, T>               Jacobian;
+    typedef LU<0, T>                   Factorization;
+
+    static std::size_t size(const Y& y) { return y.size(); }
+    static T&       component(Y& y, std::size_t i)       { return y[i]; }
+    static const T& component(const Y& y, std::size_t i) { return y[i]; }
+
+    static void resize(Jacobian& jac, std::size_t n) { jac.resize(n); }
+    static void zero(Jacobian& jac) { jac.fill(T(0)); }
+    static T& element(Jacobian& jac, std::size_t i, std::size_t j)
+      { return jac(i, j); }
+
+    static bool factor(Factorization& lu, Scalar c, const Jacobian& jac)
+      { return lu.factor(c, jac); }
+    static void solve(const Factorization& lu, Y& b) { lu.solve(b.data()); }
+
+  private:
+    LinearAlgebra();
+  };
+
+  template <typename T>
+  inline void
+  swap(DynamicEquationSystem<T>& lhs, DynamicEquationSystem<T>& rhs)
+  {
+    lhs.swap(rhs);
+  }
+
+  template <typename T>
+  inline void
+  matchSize(DynamicEquationSystem<T>& y, const DynamicEquationSystem<T>& like)
+  {
+    y.resize(like.size());
+  }
+
+  // Max-norm
+  template <typename E, typename T>
+  typename DynamicEquationSystem<T>::Scalar
+  abs(const Expression<E, DynamicEquationSystem<T> >& es)
+  {
+    const E& e = es.derived();
+    typename DynamicEquationSystem<T>::Scalar ret(0);
+    for (std::size_t i = 0; i < e.size(); ++i) {
+      using std::abs;
+      ret = std::max(ret, abs(e[i]));
+    }
+    return ret;
+  }
+
+  template <typename T>
+  inline typename DynamicEquationSystem<T>::Scalar
+  abs(const DynamicEquationSystem<T>& es)
+  {
+    return simdMaxAbs(es.data(), es.size());
+  }
+
+  template <typename T>
+  inline typename DynamicEquationSystem<T>::Scalar
+  abs(const DifferenceExpression<DynamicEquationSystem<T>,
+                                 DynamicEquationSystem<T>,
+                                 DynamicEquationSystem<T> >& es)
+  {
+    return simdMaxAbsDifference(es.lhs().data(), es.rhs().data(), es.size());
+  }
+
+  // Weighted RMS norm of e, in a single pass (see weightedRMS() in
+  // ErrorControl.hpp)
+  template <typename T>
+  inline typename DynamicEquationSystem<T>::Scalar
+  weightedRMS(const DynamicEquationSystem<T>& e,
+              const DynamicEquationSystem<T>& u,
+              const DynamicEquationSystem<T>& v,
+              const typename DynamicEquationSystem<T>::Scalar* atol,
+              const typename DynamicEquationSystem<T>::Scalar* rtol)
+  {
+    using std::sqrt;
+    return sqrt(simdWeightedSquares(e.data(), u.data(), v.data(), atol, rtol,
+                                    e.size())/e.size());
+  }
+
+  // y = y0 + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, typename T, typename Scalar>
+  inline void
+  linearCombination(DynamicEquationSystem<T>& y,
+                    const DynamicEquationSystem<T>& y0, Scalar h,
+                    const Scalar* a, const DynamicEquationSystem<T>* k)
+  {
+    y = LinearCombinationExpression<DynamicEquationSystem<T>, S>(y0, h, a, k);
+  }
+
+  // e = h*(d[0]*k[0] + ... + d[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, typename T, typename Scalar>
+  inline void
+  weightedSum(DynamicEquationSystem<T>& e, Scalar h, const Scalar* d,
+              const DynamicEquationSystem<T>* k)
+  {
+    e = WeightedSumExpression<DynamicEquationSystem<T>, S>(h, d, k);
+  }
+
+  // y = y0 + h*(b[0]*k[0] + ...) and e = h*(d[0]*k[0] + ...), reading each
+  // stage once
+  template <unsigned int S, typename T, typename Scalar>
+  inline void
+  combineWithError(DynamicEquationSystem<T>& y, DynamicEquationSystem<T>& e,
+                   const DynamicEquationSystem<T>& y0, Scalar h,
+                   const Scalar* b, const Scalar* d,
+                   const DynamicEquationSystem<T>* k)
+  {
+    typedef DynamicEquationSystem<T> C;
+    LinearCombinationExpression<C, S> solution(y0, h, b, k);
+    WeightedSumExpression<C, S> error(h, d, k);
+    matchSize(y, y0);
+    matchSize(e, y0);
+
+    for (std::size_t i = 0; i < y0.size(); ++i) {
+      typename C::Value yi = solution[i], ei = error[i];
+      y[i] = yi;
+      e[i] = ei;
+    }
+  }
+
+  // Implementation
+
+  template <typename T>
+  inline
+  DynamicEquationSystem<T>::DynamicEquationSystem(std::size_t n,
+                                                  const T& value)
+  {
+    allocate(n, value);
+  }
+
+  template <typename T>
+  inline
+  DynamicEquationSystem<T>::DynamicEquationSystem(
+    const DynamicEquationSystem& es
+  )
+  {
+    allocate(es.size(), T());
+    std::copy(es.m_values, es.m_values + m_size, m_values);
+  }
+
+  template <typename T>
+  template <typename E>
+  inline
+  DynamicEquationSystem<T>::DynamicEquationSystem(
+    const Expression<E, DynamicEquationSystem>& e
+  )
+  {
+    allocate(e.derived().size(), T());
+    *this = e;
+  }
+
+#if __cplusplus >= 201103L
+  template <typename T>
+  inline
+  DynamicEquationSystem<T>::DynamicEquationSystem(DynamicEquationSystem&& es)
+    : m_size(0), m_storage(0), m_values(0)
+  {
+    swap(es);
+  }
+#endif
+
+  template <typename T>
+  inline void
+  DynamicEquationSystem<T>::resize(std::size_t n, const T& value)
+  {
+    if (n != m_size) {
+      deallocate();
+      allocate(n, value);
+    }
+  }
+
+  template <typename T>
+  inline void
+  DynamicEquationSystem<T>::swap(DynamicEquationSystem& es)
+  {
+    std::swap(m_size, es.m_size);
+    std::swap(m_storage, es.m_storage);
+    std::swap(m_values, es.m_values);
+  }
+
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator=(const DynamicEquationSystem& rhs)
+  {
+    if (this != &rhs) {
+      resize(rhs.size());
+      std::copy(rhs.m_values, rhs.m_values + m_size, m_values);
+    }
+    return *this;
+  }
+
+#if __cplusplus >= 201103L
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator=(DynamicEquationSystem&& rhs)
+  {
+    swap(rhs);
+    return *this;
+  }
+#endif
+
+  template <typename T>
+  template <typename E>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator=(
+    const Expression<E, DynamicEquationSystem>& rhs
+  )
+  {
+    const E& e = rhs.derived();
+    resize(e.size());
+    for (std::size_t i = 0; i < m_size; ++i) {
+      m_values[i] = e[i];
+    }
+    return *this;
+  }
+
+  template <typename T>
+  template <typename E>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator+=(
+    const Expression<E, DynamicEquationSystem>& rhs
+  )
+  {
+    const E& e = rhs.derived();
+    for (std::size_t i = 0; i < m_size; ++i) {
+      m_values[i] += e[i];
+    }
+    return *this;
+  }
+
+  template <typename T>
+  template <typename E>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator-=(
+    const Expression<E, DynamicEquationSystem>& rhs
+  )
+  {
+    const E& e = rhs.derived();
+    for (std::size_t i = 0; i < m_size; ++i) {
+      m_values[i] -= e[i];
+    }
+    return *this;
+  }
+
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator+=(
+    const ScaledExpression<DynamicEquationSystem, DynamicEquationSystem>& rhs
+  )
+  {
+    simdAxpy(m_values, rhs.lhs(), rhs.rhs().data(), m_size);
+    return *this;
+  }
+
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator-=(
+    const ScaledExpression<DynamicEquationSystem, DynamicEquationSystem>& rhs
+  )
+  {
+    simdAxpy(m_values, -rhs.lhs(), rhs.rhs().data(), m_size);
+    return *this;
+  }
+
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator*=(
+    typename DynamicEquationSystem<T>::Scalar rhs
+  )
+  {
+    simdScale(m_values, rhs, m_size);
+    return *this;
+  }
+
+  template <typename T>
+  inline DynamicEquationSystem<T>&
+  DynamicEquationSystem<T>::operator/=(
+    typename DynamicEquationSystem<T>::Scalar rhs
+  )
+  {
+    for (std::size_t i = 0; i < m_size; ++i) {
+      m_values[i] /= rhs;
+    }
+    return *this;
+  }
+
+  template <typename T>
+  void
+  DynamicEquationSystem<T>::allocate(std::size_t n, const T& value)
+  {
+    m_size = 0;
+    m_storage = 0;
+    m_values = 0;
+    if (n == 0) {
+      return;
+    }
+
+    m_storage = ::operator new(n*sizeof(T) + s_cacheLine - 1);
+    std::size_t address = reinterpret_cast<std::size_t>(m_storage);
+    address = (address + s_cacheLine - 1) & ~(s_cacheLine - 1);
+    m_values = reinterpret_cast<T*>(address);
+
+    try {
+      std::uninitialized_fill_n(m_values, n, value);
+    } catch (...) {
+      ::operator delete(m_storage);
+      m_storage = 0;
+      m_values = 0;
+      throw;
+    }
+    m_size = n;
+  }
+
+  template <typename T>
+  void
+  DynamicEquationSystem<T>::deallocate()
+  {
+    for (std::size_t i = 0; i < m_size; ++i) {
+      m_values[i].~T();
+    }
+    ::operator delete(m_storage);
+    m_size = 0;
+    m_storage = 0;
+    m_values = 0;
+  }
+}
+
+#endif // VZ_DYNAMICEQUATIONSYSTEM_HPP
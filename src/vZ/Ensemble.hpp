@@ -0,0 +1,499 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_ENSEMBLE_HPP
+#define VZ_ENSEMBLE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace vZ
+{
+  // Integrates an ensemble of independent copies of the same system
+  //
+  // The trajectories are grouped into blocks of W, one per SIMD lane.  Each
+  // block is stored in structure-of-arrays form, as an
+  // EquationSystem<N, Lanes<T, W> >, so every operation on it advances all W
+  // trajectories at once.  By default a block fills two SIMD registers, so
+  // that two independent chains of arithmetic hide instruction latency.
+  // Each lane has its own x, step size, and step size controller, which
+  // works as in GenericAdaptiveIntegrator (so it follows the same steps as
+  // integrating that trajectory alone).  Lanes which have finished, or whose
+  // step was rejected, are masked out of the update.
+  //
+  // Y must be an EquationSystem<N, T>, and Tableau an adaptive tableau such
+  // as DP45Tableau<Y>.  f is called on whole blocks, in place, as
+  // f(x, y, dydx, i), where x is a Lanes<T, W>, y and dydx are Blocks, and
+  // lane l holds trajectory i + l.  In the last block, lanes past size() are
+  // padding; f is evaluated on them, but the results are discarded.
+  template <typename Y, typename Tableau, typename F,
+            std::size_t W = 2*SIMDLanes<typename Traits<Y>::Scalar>::s_lanes>
+  class GenericEnsembleIntegrator;
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  class GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>
+  {
+  public:
+    typedef EquationSystem<N, T>          Y;
+    typedef typename Traits<Y>::Scalar    Scalar;
+    typedef Lanes<T, W>                   BlockScalar;
+    typedef EquationSystem<N, BlockScalar> Block;
+    typedef F                             Function;
+    typedef GenericStepController<Scalar> StepController;
+
+    static const std::size_t s_lanes = W;
+
+    // Every trajectory starts with y == 0, x == 0, and h == 0.  As in
+    // GenericAdaptiveIntegrator, trajectories with h == 0 choose their own
+    // first step size.
+    GenericEnsembleIntegrator(Function f, std::size_t size);
+    ~GenericEnsembleIntegrator() { }
+
+    std::size_t size() const { return m_size; }
+
+    // Tolerances, shared by every trajectory
+    GenericEnsembleIntegrator& tol(Scalar tol)
+      { m_atol = tol; m_rtol = tol; return *this; }
+    GenericEnsembleIntegrator& atol(Scalar tol) { m_atol = tol; return *this; }
+    GenericEnsembleIntegrator& rtol(Scalar tol) { m_rtol = tol; return *this; }
+
+    Scalar atol() const { return m_atol; }
+    Scalar rtol() const { return m_rtol; }
+
+    // Use a copy of controller for every trajectory
+    GenericEnsembleIntegrator& controller(const StepController& controller);
+
+    // The state of trajectory i
+    GenericEnsembleIntegrator& y(std::size_t i, const Y& y);
+    GenericEnsembleIntegrator& x(std::size_t i, Scalar x)
+      { m_x[i/W][i%W] = x; return *this; }
+    GenericEnsembleIntegrator& h(std::size_t i, Scalar h)
+      { m_h[i/W][i%W] = h; return *this; }
+
+    Y      y(std::size_t i) const;
+    Scalar x(std::size_t i) const { return m_x[i/W][i%W]; }
+    Scalar h(std::size_t i) const { return m_h[i/W][i%W]; }
+
+    // Set x or h for every trajectory
+    GenericEnsembleIntegrator& xAll(Scalar x);
+    GenericEnsembleIntegrator& hAll(Scalar h);
+
+    unsigned int iterations(std::size_t i) const { return m_iterations[i]; }
+    unsigned int rejections(std::size_t i) const { return m_rejections[i]; }
+
+    // Integrate every trajectory until x == x_final
+    void integrate(Scalar x_final);
+
+  private:
+    typedef Lanes<bool, W> Mask;
+    typedef typename Tableau::Scalar Coefficient;
+
+    // Compile-time stage index, to unroll the stage loop
+    template <unsigned int I>
+    class Stage { };
+
+    // Whether the error is combined from two estimates, as in
+    // GenericAdaptiveIntegrator
+    template <bool Combined>
+    class Estimates { };
+    typedef Estimates<ErrorEstimate<Tableau>::s_combined> Estimate;
+
+    // The max-norm of the second error estimate in each lane
+    BlockScalar error2(const BlockScalar&, Estimates<false>)
+      { return BlockScalar(T(0)); }
+    BlockScalar error2(const BlockScalar& h, Estimates<true>);
+
+    static Scalar combine(Scalar err, Scalar, Estimates<false>)
+      { return err; }
+    static Scalar combine(Scalar err, Scalar err2, Estimates<true>)
+      { return ErrorEstimate<Tableau>::combine(err, err2); }
+
+    Function m_f;
+    std::size_t m_size;
+    Scalar m_atol, m_rtol;
+    bool m_fsal;
+
+    // One entry per block
+    std::vector<Block>       m_y;
+    std::vector<BlockScalar> m_x, m_h;
+
+    // One entry per trajectory
+    std::vector<StepController> m_controllers;
+    std::vector<unsigned int> m_iterations, m_rejections;
+
+    // The weights b[i] - b*[i] of the error estimate
+    Coefficient m_d[Tableau::s_stages];
+
+    // Stages, candidate solution and error estimate for the current block
+    Block m_k[Tableau::s_stages];
+    Block m_yNew, m_yErr;
+
+    void integrate(std::size_t block, Scalar x_final);
+
+    // The terms h*a[j]*k[j] of a stage, for LinearCombinationTerms
+    class Terms
+    {
+    public:
+      Terms(const BlockScalar& h, const Coefficient* a, const Block* k)
+        : m_h(h), m_a(a), m_k(k) { }
+
+      // Rounded exactly as in LinearCombinationExpression
+      void
+      addTerm(BlockScalar& ret, unsigned int j, std::size_t i) const
+      {
+        if (m_a[j] != Coefficient(0)) {
+          ret += m_h*BlockScalar(m_a[j])*m_k[j][i];
+        }
+      }
+
+    private:
+      const BlockScalar& m_h;
+      const Coefficient* m_a;
+      const Block* m_k;
+    };
+
+    // y = y0 + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1]), like
+    // linearCombination(), but with a different h in each lane
+    template <unsigned int S>
+    void combine(Block& y, const Block& y0, const BlockScalar& h,
+                 const Coefficient* a) const;
+
+    // e = h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1]), rounded exactly as
+    // weightedSum()
+    template <unsigned int S>
+    void weightedSum(Block& e, const BlockScalar& h,
+                     const Coefficient* a) const;
+
+    template <unsigned int I>
+    void calculateK(std::size_t first, const BlockScalar& x,
+                    const BlockScalar& h, const Block& y0, Stage<I>);
+    void calculateK(std::size_t, const BlockScalar&, const BlockScalar&,
+                    const Block&, Stage<Tableau::s_stages>) { }
+  };
+
+  // Implementation
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::
+  GenericEnsembleIntegrator(Function f, std::size_t size)
+    : m_f(f), m_size(size), m_fsal(true),
+      m_x((size + W - 1)/W, BlockScalar(T(0))),
+      m_h(m_x.size(), BlockScalar(T(0))),
+      m_controllers(size), m_iterations(size), m_rejections(size)
+  {
+    Block zero;
+    for (std::size_t j = 0; j < N; ++j) {
+      zero[j] = BlockScalar(T(0));
+    }
+    m_y.assign(m_x.size(), zero);
+
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      m_d[i] = Tableau::s_b[i] - Tableau::s_bStar[i];
+    }
+
+    // First Same As Last: the last stage is evaluated at the solution point
+    static const unsigned int last = Tableau::s_stages - 1;
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      if (Tableau::s_a[last][i] != Tableau::s_b[i]) {
+        m_fsal = false;
+      }
+    }
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>&
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::controller(
+    const StepController& controller
+  )
+  {
+    std::fill(m_controllers.begin(), m_controllers.end(), controller);
+    return *this;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>&
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::y(
+    std::size_t i, const Y& y
+  )
+  {
+    for (std::size_t j = 0; j < N; ++j) {
+      m_y[i/W][j][i%W] = y[j];
+    }
+    return *this;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  typename GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::Y
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::y(
+    std::size_t i
+  ) const
+  {
+    Y ret;
+    for (std::size_t j = 0; j < N; ++j) {
+      ret[j] = m_y[i/W][j][i%W];
+    }
+    return ret;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>&
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::xAll(
+    Scalar x
+  )
+  {
+    std::fill(m_x.begin(), m_x.end(), BlockScalar(x));
+    return *this;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>&
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::hAll(
+    Scalar h
+  )
+  {
+    std::fill(m_h.begin(), m_h.end(), BlockScalar(h));
+    return *this;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  void
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::integrate(
+    Scalar x_final
+  )
+  {
+    // Each block runs to completion before the next, so the stages stay in
+    // cache
+    for (std::size_t b = 0; b < m_y.size(); ++b) {
+      integrate(b, x_final);
+    }
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  void
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::integrate(
+    std::size_t block, Scalar x_final
+  )
+  {
+    static const unsigned int last = Tableau::s_stages - 1;
+
+    std::size_t first = block*W;
+    Block& y = m_y[block];
+    BlockScalar& x = m_x[block];
+    BlockScalar& h = m_h[block];
+
+    Mask active, accepted, start;
+    bool any = false, anyStart = false;
+    for (std::size_t l = 0; l < W; ++l) {
+      active[l]   = first + l < m_size && x[l] < x_final;
+      accepted[l] = false;
+      start[l]    = active[l] && h[l] == Scalar(0);
+      any      = any || active[l];
+      anyStart = anyStart || start[l];
+    }
+
+    bool k1Set = false;
+    if (anyStart) {
+      // Choose the first step size, as in GenericAdaptiveIntegrator::start().
+      // f(x, y) is kept as k1.
+      m_f(x, y, m_k[0], first);
+      k1Set = true;
+
+      BlockScalar y0(T(0)), f0(T(0)), df(T(0)), sc(T(0)), h0(T(0));
+      for (std::size_t j = 0; j < N; ++j) {
+        y0 = max(y0, abs(y[j]));
+        f0 = max(f0, abs(m_k[0][j]));
+      }
+      for (std::size_t l = 0; l < W; ++l) {
+        if (start[l]) {
+          sc[l] = m_atol + y0[l]*m_rtol;
+          h0[l] = initialStepGuess(y0[l], f0[l], sc[l]);
+        }
+      }
+
+      // An explicit Euler step, to estimate y''
+      for (std::size_t j = 0; j < N; ++j) {
+        m_yNew[j] = y[j] + h0*m_k[0][j];
+      }
+      m_f(x + h0, m_yNew, m_k[1], first);
+      for (std::size_t j = 0; j < N; ++j) {
+        df = max(df, abs(m_k[1][j] - m_k[0][j]));
+      }
+
+      for (std::size_t l = 0; l < W; ++l) {
+        if (start[l]) {
+          h[l] = initialStep(h0[l], f0[l], df[l], sc[l], Tableau::s_order);
+        }
+      }
+    }
+
+    // Every lane attempts a step per iteration.  As in
+    // GenericAdaptiveIntegrator, a rejected step is retried from the same
+    // k1, and accepted ones reuse the last stage as the next k1 for FSAL
+    // methods.
+    while (any) {
+      for (std::size_t l = 0; l < W; ++l) {
+        if (active[l]) {
+          h[l] = std::min(h[l], x_final - x[l]);
+        }
+      }
+
+      if (k1Set) {
+        for (std::size_t j = 0; j < N; ++j) {
+          m_k[0][j] = select(accepted, m_k[last][j], m_k[0][j]);
+        }
+      } else {
+        m_f(x, y, m_k[0], first);
+      }
+      k1Set = m_fsal;
+
+      calculateK(first, x, h, y, Stage<1>());
+      if (!m_fsal) {
+        combine<Tableau::s_stages>(m_yNew, y, h, Tableau::s_b);
+      }
+      weightedSum<Tableau::s_stages>(m_yErr, h, m_d);
+
+      // Error estimates, as in GenericAdaptiveIntegrator
+      BlockScalar delta(T(0)), yNewNorm(T(0)), yNorm(T(0));
+      for (std::size_t j = 0; j < N; ++j) {
+        delta    = max(delta, abs(m_yErr[j]));
+        yNewNorm = max(yNewNorm, abs(m_yNew[j]));
+        yNorm    = max(yNorm, abs(y[j]));
+      }
+      BlockScalar delta2 = error2(h, Estimate());
+
+      any = false;
+      for (std::size_t l = 0; l < W; ++l) {
+        accepted[l] = false;
+        if (!active[l]) {
+          continue;
+        }
+
+        StepController& controller = m_controllers[first + l];
+        Scalar newH = h[l];
+        if (delta[l] != Scalar(0)) {
+          Scalar scale = m_atol + std::max(yNewNorm[l], yNorm[l])*m_rtol;
+          Scalar err   = combine(delta[l]/scale, delta2[l]/scale,
+                                 Estimate());
+
+          if (err > Scalar(1)) {
+            // Reject the step
+            h[l] = controller.reject(h[l], err, Tableau::s_order);
+            ++m_rejections[first + l];
+            any = true;
+            continue;
+          }
+          newH = controller.accept(h[l], err, Tableau::s_order);
+        }
+
+        accepted[l] = true;
+        x[l] += h[l];
+        h[l] = newH;
+        ++m_iterations[first + l];
+
+        active[l] = x[l] < x_final;
+        any = any || active[l];
+      }
+
+      for (std::size_t j = 0; j < N; ++j) {
+        y[j] = select(accepted, m_yNew[j], y[j]);
+      }
+    }
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  template <unsigned int S>
+  inline void
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::combine(
+    Block& y, const Block& y0, const BlockScalar& h, const Coefficient* a
+  ) const
+  {
+    Terms terms(h, a, m_k);
+    for (std::size_t j = 0; j < N; ++j) {
+      BlockScalar sum = y0[j];
+      LinearCombinationTerms<S>::add(sum, terms, j);
+      y[j] = sum;
+    }
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  template <unsigned int S>
+  inline void
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::weightedSum(
+    Block& e, const BlockScalar& h, const Coefficient* a
+  ) const
+  {
+    Terms terms(h, a, m_k);
+    for (std::size_t j = 0; j < N; ++j) {
+      BlockScalar sum = h*BlockScalar(a[0])*m_k[0][j];
+      LinearCombinationTerms<S - 1>::add(sum, TailTerms<Terms>(terms), j);
+      e[j] = sum;
+    }
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  inline typename
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::BlockScalar
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::error2(
+    const BlockScalar& h, Estimates<true>
+  )
+  {
+    // m_yErr is no longer needed
+    weightedSum<Tableau::s_stages>(m_yErr, h, ErrorEstimate<Tableau>::s_d);
+
+    BlockScalar delta2(T(0));
+    for (std::size_t j = 0; j < N; ++j) {
+      delta2 = max(delta2, abs(m_yErr[j]));
+    }
+    return delta2;
+  }
+
+  template <std::size_t N, typename T, typename Tableau, typename F,
+            std::size_t W>
+  template <unsigned int I>
+  inline void
+  GenericEnsembleIntegrator<EquationSystem<N, T>, Tableau, F, W>::calculateK(
+    std::size_t first, const BlockScalar& x, const BlockScalar& h,
+    const Block& y0, Stage<I>
+  )
+  {
+    // The argument of the last stage is left in m_yNew, which is the
+    // solution for FSAL methods
+    combine<I>(m_yNew, y0, h, Tableau::s_a[I]);
+    m_f(x + h*BlockScalar(Tableau::s_c[I]), m_yNew, m_k[I], first);
+
+    calculateK(first, x, h, y0, Stage<I + 1>());
+  }
+}
+
+#endif // VZ_ENSEMBLE_HPP
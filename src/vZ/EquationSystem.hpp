@@ -28,25 +28,45 @@
 namespace vZ
 {
   // A class to easily represent a system of ODEs
+  //
+  // Arithmetic on EquationSystems is lazily evaluated; see Expression.hpp
   template <std::size_t N, typename T = double>
-  class EquationSystem
+  class EquationSystem : public Expression<EquationSystem<N, T>,
+                                           EquationSystem<N, T> >
   {
   public:
     typedef typename Traits<T>::Scalar Scalar;
+    typedef T                          Value;
 
-    // EquationSystem();
+    EquationSystem() { }
+    template <typename E>
+    EquationSystem(const Expression<E, EquationSystem>& e) { *this = e; }
     // ~EquationSystem();
 
+    std::size_t size() const { return N; }
+
     T&       operator[](std::size_t i)       { return m_values[i]; }
     const T& operator[](std::size_t i) const { return m_values[i]; }
 
-    EquationSystem& operator+=(const EquationSystem& rhs);
-    EquationSystem& operator-=(const EquationSystem& rhs);
+    T*       data()       { return m_values; }
+    const T* data() const { return m_values; }
+
+    template <typename E>
+    EquationSystem& operator=(const Expression<E, EquationSystem>& rhs);
+    template <typename E>
+    EquationSystem& operator+=(const Expression<E, EquationSystem>& rhs);
+    template <typename E>
+    EquationSystem& operator-=(const Expression<E, EquationSystem>& rhs);
+    // y += a*x and y -= a*x get a dedicated kernel
+    EquationSystem&
+    operator+=(const ScaledExpression<EquationSystem, EquationSystem>& rhs);
+    EquationSystem&
+    operator-=(const ScaledExpression<EquationSystem, EquationSystem>& rhs);
     EquationSystem& operator*=(Scalar rhs);
     EquationSystem& operator/=(Scalar rhs);
 
   private:
-    T m_values[N];
+    VZ_SIMD_ALIGNAS(T, N) T m_values[N];
   };
 
   // Disallow 0-sized EquationSystems
@@ -64,122 +84,180 @@ namespace vZ
     Traits();
   };
 
-  // Unary operators
-
+  // LinearAlgebra specialization, for systems of scalars
   template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator+(const EquationSystem<N, T>& rhs)
+  class LinearAlgebra<EquationSystem<N, T> >
   {
-    return rhs;
-  }
+  public:
+    typedef typename Traits<T>::Scalar Scalar;
+    typedef EquationSystem<N, T>       Y;
+    typedef Matrix<N, T>               Jacobian;
+    typedef LU<N, T>                   Factorization;
 
-  template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator-(const EquationSystem<N, T>& rhs)
-  {
-    EquationSystem<N, T> res;
-    for (std::size_t i = 0; i < N; ++i) {
-      res[i] = -rhs[i];
-    }
-    return res;
-  }
+    static std::size_t size(const Y& y) { return y.size(); }
+    static T&       component(Y& y, std::size_t i)       { return y[i]; }
+    static const T& component(const Y& y, std::size_t i) { return y[i]; }
 
-  template <std::size_t N, typename T>
+    static void resize(Jacobian&, std::size_t) { }
+    static void zero(Jacobian& jac) { jac.fill(T(0)); }
+    static T& element(Jacobian& jac, std::size_t i, std::size_t j)
+      { return jac(i, j); }
+
+    static bool factor(Factorization& lu, Scalar c, const Jacobian& jac)
+      { return lu.factor(c, jac); }
+    static void solve(const Factorization& lu, Y& b) { lu.solve(b.data()); }
+
+  private:
+    LinearAlgebra();
+  };
+
+  // Max-norm
+  template <typename E, std::size_t N, typename T>
   typename EquationSystem<N, T>::Scalar
-  abs(const EquationSystem<N, T>& es)
+  abs(const Expression<E, EquationSystem<N, T> >& es)
   {
+    const E& e = es.derived();
     typename EquationSystem<N, T>::Scalar ret(0);
     for (std::size_t i = 0; i < N; ++i) {
       using std::abs;
-      ret = std::max(ret, abs(es[i]));
+      ret = std::max(ret, abs(e[i]));
     }
     return ret;
   }
 
-  // Binary operators
-
   template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator+(const EquationSystem<N, T>& lhs, const EquationSystem<N, T>& rhs)
+  inline typename EquationSystem<N, T>::Scalar
+  abs(const EquationSystem<N, T>& es)
   {
-    EquationSystem<N, T> res = lhs;
-    res += rhs;
-    return res;
+    return simdMaxAbs(es.data(), N);
   }
 
   template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator-(const EquationSystem<N, T>& lhs, const EquationSystem<N, T>& rhs)
+  inline typename EquationSystem<N, T>::Scalar
+  abs(const DifferenceExpression<EquationSystem<N, T>, EquationSystem<N, T>,
+                                 EquationSystem<N, T> >& es)
   {
-    EquationSystem<N, T> res = lhs;
-    res -= rhs;
-    return res;
+    return simdMaxAbsDifference(es.lhs().data(), es.rhs().data(), N);
   }
 
+  // Weighted RMS norm of e, in a single pass (see weightedRMS() in
+  // ErrorControl.hpp)
   template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator*(typename EquationSystem<N, T>::Scalar lhs,
-            const EquationSystem<N, T>& rhs)
+  inline typename EquationSystem<N, T>::Scalar
+  weightedRMS(const EquationSystem<N, T>& e, const EquationSystem<N, T>& u,
+              const EquationSystem<N, T>& v,
+              const typename EquationSystem<N, T>::Scalar* atol,
+              const typename EquationSystem<N, T>::Scalar* rtol)
   {
-    EquationSystem<N, T> res = rhs;
-    res *= lhs;
-    return res;
+    using std::sqrt;
+    return sqrt(simdWeightedSquares(e.data(), u.data(), v.data(), atol, rtol,
+                                    N)/N);
   }
 
-  template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator*(const EquationSystem<N, T>& lhs,
-            typename EquationSystem<N, T>::Scalar rhs)
+  // y = y0 + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  linearCombination(EquationSystem<N, T>& y, const EquationSystem<N, T>& y0,
+                    Scalar h, const Scalar* a, const EquationSystem<N, T>* k)
   {
-    EquationSystem<N, T> res = lhs;
-    res *= rhs;
-    return res;
+    y = LinearCombinationExpression<EquationSystem<N, T>, S>(y0, h, a, k);
   }
 
-  template <std::size_t N, typename T>
-  inline EquationSystem<N, T>
-  operator/(const EquationSystem<N, T>& lhs,
-            typename EquationSystem<N, T>::Scalar rhs)
+  // e = h*(d[0]*k[0] + ... + d[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  weightedSum(EquationSystem<N, T>& e, Scalar h, const Scalar* d,
+              const EquationSystem<N, T>* k)
   {
-    EquationSystem<N, T> res = lhs;
-    res /= rhs;
-    return res;
+    e = WeightedSumExpression<EquationSystem<N, T>, S>(h, d, k);
+  }
+
+  // y = y0 + h*(b[0]*k[0] + ...) and e = h*(d[0]*k[0] + ...), reading each
+  // stage once
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  combineWithError(EquationSystem<N, T>& y, EquationSystem<N, T>& e,
+                   const EquationSystem<N, T>& y0, Scalar h, const Scalar* b,
+                   const Scalar* d, const EquationSystem<N, T>* k)
+  {
+    typedef EquationSystem<N, T> C;
+    LinearCombinationExpression<C, S> solution(y0, h, b, k);
+    WeightedSumExpression<C, S> error(h, d, k);
+    for (std::size_t i = 0; i < y0.size(); ++i) {
+      typename C::Value yi = solution[i], ei = error[i];
+      y[i] = yi;
+      e[i] = ei;
+    }
   }
 
   // Implementation
 
   template <std::size_t N, typename T>
-  EquationSystem<N, T>&
-  EquationSystem<N, T>::operator+=(const EquationSystem<N, T>& rhs)
+  template <typename E>
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator=(const Expression<E, EquationSystem>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] += rhs.m_values[i];
+      m_values[i] = e[i];
     }
     return *this;
   }
 
   template <std::size_t N, typename T>
-  EquationSystem<N, T>&
-  EquationSystem<N, T>::operator-=(const EquationSystem<N, T>& rhs)
+  template <typename E>
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator+=(const Expression<E, EquationSystem>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] -= rhs.m_values[i];
+      m_values[i] += e[i];
     }
     return *this;
   }
 
   template <std::size_t N, typename T>
-  EquationSystem<N, T>&
-  EquationSystem<N, T>::operator*=(typename EquationSystem<N, T>::Scalar rhs)
+  template <typename E>
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator-=(const Expression<E, EquationSystem>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] *= rhs;
+      m_values[i] -= e[i];
     }
     return *this;
   }
 
   template <std::size_t N, typename T>
-  EquationSystem<N, T>&
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator+=(
+    const ScaledExpression<EquationSystem, EquationSystem>& rhs
+  )
+  {
+    simdAxpy(m_values, rhs.lhs(), rhs.rhs().data(), N);
+    return *this;
+  }
+
+  template <std::size_t N, typename T>
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator-=(
+    const ScaledExpression<EquationSystem, EquationSystem>& rhs
+  )
+  {
+    simdAxpy(m_values, -rhs.lhs(), rhs.rhs().data(), N);
+    return *this;
+  }
+
+  template <std::size_t N, typename T>
+  inline EquationSystem<N, T>&
+  EquationSystem<N, T>::operator*=(typename EquationSystem<N, T>::Scalar rhs)
+  {
+    simdScale(m_values, rhs, N);
+    return *this;
+  }
+
+  template <std::size_t N, typename T>
+  inline EquationSystem<N, T>&
   EquationSystem<N, T>::operator/=(typename EquationSystem<N, T>::Scalar rhs)
   {
     for (std::size_t i = 0; i < N; ++i) {
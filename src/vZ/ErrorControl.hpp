@@ -0,0 +1,221 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_ERRORCONTROL_HPP
+#define VZ_ERRORCONTROL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace vZ
+{
+  // Weighted RMS norm of e, where component i is scaled by
+  //   atol[i] + max(|u[i]|, |v[i]|)*rtol[i]
+  //
+  // The generic version treats Y as a single component.  Container types
+  // overload this to compute it in a single pass.
+  template <typename Y, typename Scalar>
+  inline Scalar
+  weightedRMS(const Y& e, const Y& u, const Y& v, const Scalar* atol,
+              const Scalar* rtol)
+  {
+    using std::abs;
+    return abs(e)/(atol[0] + std::max(abs(u), abs(v))*rtol[0]);
+  }
+
+  // Error control for the adaptive integrators
+  //
+  // Holds the tolerances and the step size controller, and measures error
+  // estimates against them.  Derived is the integrator, which the setters
+  // return.
+  //
+  // By default, an error is measured by the norm of the whole solution (the
+  // max-norm for EquationSystem), relative to a single scale.  Giving
+  // atol() or rtol() as a vector, with one tolerance per component, switches
+  // to weightedRMS(), so that each component is held to its own scale.
+  template <typename Y, typename Derived>
+  class GenericErrorControl
+  {
+  public:
+    typedef typename Traits<Y>::Scalar    Scalar;
+    typedef GenericStepController<Scalar> StepController;
+
+    // Scalar tolerances apply to every component
+    Derived& tol(Scalar tol) { atol(tol); return rtol(tol); }
+    Derived& atol(Scalar tol);
+    Derived& rtol(Scalar tol);
+
+    // Per-component tolerances.  If only one of them is given as a vector,
+    // the other's scalar value is used for every component.
+    Derived& atol(const std::vector<Scalar>& tol);
+    Derived& rtol(const std::vector<Scalar>& tol);
+
+    Scalar atol() const { return m_atol; }
+    Scalar rtol() const { return m_rtol; }
+    // Empty unless per-component tolerances were given
+    const std::vector<Scalar>& atols() const { return m_atols; }
+    const std::vector<Scalar>& rtols() const { return m_rtols; }
+
+    // How the step size is chosen; the elementary controller by default
+    Derived& controller(const StepController& controller)
+      { m_controller = controller; return derived(); }
+    const StepController& controller() const { return m_controller; }
+
+    unsigned int rejections() const { return m_rejections; }
+
+  protected:
+    GenericErrorControl() : m_rejections(0) { }
+    ~GenericErrorControl() { }
+
+    // Forget the rejections and the controller's history
+    void resetErrorControl() { m_controller.reset(); m_rejections = 0; }
+
+    // The norm of the error e of a step from v to u, scaled so that 1 is
+    // just acceptable
+    Scalar errorNorm(const Y& e, const Y& u, const Y& v) const;
+
+    // The next step size after accepting or rejecting a step of size h with
+    // error err, for an error estimate of order k
+    Scalar accept(Scalar h, Scalar err, unsigned int k)
+      { return m_controller.accept(h, err, k); }
+    Scalar reject(Scalar h, Scalar err, unsigned int k)
+      { ++m_rejections; return m_controller.reject(h, err, k); }
+    // A step which failed outright, rather than on its error, is retried
+    // with half the step size
+    Scalar fail(Scalar h) { ++m_rejections; return h/Scalar(2); }
+    // For methods which choose their own step size after a rejection
+    void countRejection() { ++m_rejections; }
+
+    // Choose the first step size for an error estimate of order k, given
+    // f0 == f(x, y).  This costs one evaluation of f, at a trial step whose
+    // argument and derivative are left in y1 and f1.
+    template <typename F>
+    Scalar initialStep(F& f, Scalar x, const Y& y, const Y& f0, Y& y1, Y& f1,
+                       unsigned int k) const;
+
+  private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+
+    Scalar m_atol, m_rtol;
+    std::vector<Scalar> m_atols, m_rtols;
+    StepController m_controller;
+    unsigned int m_rejections;
+  };
+
+  // Implementations
+
+  template <typename Y, typename Derived>
+  Derived&
+  GenericErrorControl<Y, Derived>::atol(Scalar tol)
+  {
+    m_atol = tol;
+    std::fill(m_atols.begin(), m_atols.end(), tol);
+    return derived();
+  }
+
+  template <typename Y, typename Derived>
+  Derived&
+  GenericErrorControl<Y, Derived>::rtol(Scalar tol)
+  {
+    m_rtol = tol;
+    std::fill(m_rtols.begin(), m_rtols.end(), tol);
+    return derived();
+  }
+
+  template <typename Y, typename Derived>
+  Derived&
+  GenericErrorControl<Y, Derived>::atol(const std::vector<Scalar>& tol)
+  {
+    m_atols = tol;
+    if (m_rtols.size() != tol.size()) {
+      m_rtols.assign(tol.size(), m_rtol);
+    }
+    return derived();
+  }
+
+  template <typename Y, typename Derived>
+  Derived&
+  GenericErrorControl<Y, Derived>::rtol(const std::vector<Scalar>& tol)
+  {
+    m_rtols = tol;
+    if (m_atols.size() != tol.size()) {
+      m_atols.assign(tol.size(), m_atol);
+    }
+    return derived();
+  }
+
+  template <typename Y, typename Derived>
+  inline typename GenericErrorControl<Y, Derived>::Scalar
+  GenericErrorControl<Y, Derived>::errorNorm(const Y& e, const Y& u,
+                                             const Y& v) const
+  {
+    if (m_atols.empty()) {
+      using std::abs;
+      Scalar delta = abs(e);
+      if (delta == Scalar(0)) {
+        return delta;
+      }
+
+      Scalar scale = m_atol + std::max(abs(u), abs(v))*m_rtol;
+      return delta/scale;
+    } else {
+      return weightedRMS(e, u, v, &m_atols[0], &m_rtols[0]);
+    }
+  }
+
+  template <typename Y, typename Derived>
+  template <typename F>
+  typename GenericErrorControl<Y, Derived>::Scalar
+  GenericErrorControl<Y, Derived>::initialStep(F& f, Scalar x, const Y& y,
+                                               const Y& f0, Y& y1, Y& f1,
+                                               unsigned int k) const
+  {
+    using std::abs;
+
+    // The norms of y, f, and f', measured as in the error test
+    Scalar y0n, f0n, sc;
+    if (m_atols.empty()) {
+      y0n = abs(y);
+      f0n = abs(f0);
+      sc = m_atol + y0n*m_rtol;
+    } else {
+      y0n = weightedRMS(y, y, y, &m_atols[0], &m_rtols[0]);
+      f0n = weightedRMS(f0, y, y, &m_atols[0], &m_rtols[0]);
+      sc = 1;
+    }
+    Scalar h0 = initialStepGuess(y0n, f0n, sc);
+
+    // An explicit Euler step, to estimate y''
+    y1 = y + h0*f0;
+    evaluate(f, x + h0, y1, f1);
+
+    Scalar df;
+    if (m_atols.empty()) {
+      df = abs(f1 - f0);
+    } else {
+      f1 -= f0;
+      df = weightedRMS(f1, y, y, &m_atols[0], &m_rtols[0]);
+    }
+    return vZ::initialStep(h0, f0n, df, sc, k);
+  }
+}
+
+#endif // VZ_ERRORCONTROL_HPP
@@ -33,24 +33,33 @@ namespace vZ
   //   --+--
   //     | 1
   template <typename Y>
-  class GenericEulerIntegrator : public GenericSimpleIntegrator<Y>
+  class EulerTableau
   {
   public:
-    typedef typename GenericSimpleIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericSimpleIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericEulerIntegrator(Function f)
-      : GenericSimpleIntegrator<Y>(f, s_a, s_b) { }
-    ~GenericEulerIntegrator() { }
+    static const unsigned int s_stages = 1;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericSimpleIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericSimpleIntegrator<Y>::BCoefficients BCoefficients;
+    EulerTableau();
+  };
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericEulerIntegrator
+    : public GenericSimpleIntegrator<Y, EulerTableau<Y>, F>
+  {
+    typedef GenericSimpleIntegrator<Y, EulerTableau<Y>, F> Base;
 
-    static Scalar s_bArr[1];
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericEulerIntegrator(Function f) : Base(f) { }
+    ~GenericEulerIntegrator() { }
   };
 
   // Type alias
@@ -59,18 +68,18 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericEulerIntegrator<Y>::Scalar
-  GenericEulerIntegrator<Y>::s_bArr[1] = {
-    Scalar(1)
+  const typename EulerTableau<Y>::Scalar
+  EulerTableau<Y>::s_a[1][1] = {
+    { Scalar(0) }
   };
 
   template <typename Y>
-  typename GenericEulerIntegrator<Y>::ACoefficients
-  GenericEulerIntegrator<Y>::s_a;
+  const typename EulerTableau<Y>::Scalar
+  EulerTableau<Y>::s_b[1] = { Scalar(1) };
 
   template <typename Y>
-  typename GenericEulerIntegrator<Y>::BCoefficients
-  GenericEulerIntegrator<Y>::s_b(s_bArr, s_bArr + 1);
+  const typename EulerTableau<Y>::Scalar
+  EulerTableau<Y>::s_c[1] = { Scalar(0) };
 }
 
 #endif // VZ_EULER_HPP
@@ -0,0 +1,361 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_EXPRESSION_HPP
+#define VZ_EXPRESSION_HPP
+
+#include <cstddef>
+
+namespace vZ
+{
+  // Base class for lazily evaluated element-wise expressions
+  //
+  // E is the type of the expression itself, and C is the container type it
+  // evaluates to (e.g. EquationSystem<N, T>).  Arithmetic on expressions
+  // only builds a tree of lightweight nodes, which is evaluated one element
+  // at a time when it is assigned to a C.  That way a whole linear
+  // combination like y + h*(a*k1 + b*k2) is computed in a single pass,
+  // without any temporary containers.
+  //
+  // Containers derive from Expression<C, C>, and provide the Scalar and
+  // Value (element) types, size(), and operator[].
+  template <typename E, typename C>
+  class Expression
+  {
+  public:
+    const E& derived() const { return static_cast<const E&>(*this); }
+
+  protected:
+    Expression() { }
+  };
+
+  // How expression nodes hold their operands: containers by reference,
+  // other nodes (which are cheap temporaries) by value
+  template <typename E, typename C>
+  class ExpressionOperand
+  {
+  public:
+    typedef E Type;
+
+  private:
+    ExpressionOperand();
+  };
+
+  template <typename C>
+  class ExpressionOperand<C, C>
+  {
+  public:
+    typedef const C& Type;
+
+  private:
+    ExpressionOperand();
+  };
+
+  // lhs + rhs
+  template <typename L, typename R, typename C>
+  class SumExpression : public Expression<SumExpression<L, R, C>, C>
+  {
+  public:
+    typedef typename C::Value Value;
+
+    SumExpression(const L& lhs, const R& rhs) : m_lhs(lhs), m_rhs(rhs) { }
+
+    std::size_t size() const { return m_lhs.size(); }
+    Value operator[](std::size_t i) const { return m_lhs[i] + m_rhs[i]; }
+
+  private:
+    typename ExpressionOperand<L, C>::Type m_lhs;
+    typename ExpressionOperand<R, C>::Type m_rhs;
+  };
+
+  // lhs - rhs
+  template <typename L, typename R, typename C>
+  class DifferenceExpression
+    : public Expression<DifferenceExpression<L, R, C>, C>
+  {
+  public:
+    typedef typename C::Value Value;
+
+    DifferenceExpression(const L& lhs, const R& rhs)
+      : m_lhs(lhs), m_rhs(rhs) { }
+
+    std::size_t size() const { return m_lhs.size(); }
+    Value operator[](std::size_t i) const { return m_lhs[i] - m_rhs[i]; }
+
+    const L& lhs() const { return m_lhs; }
+    const R& rhs() const { return m_rhs; }
+
+  private:
+    typename ExpressionOperand<L, C>::Type m_lhs;
+    typename ExpressionOperand<R, C>::Type m_rhs;
+  };
+
+  // -rhs
+  template <typename E, typename C>
+  class NegatedExpression : public Expression<NegatedExpression<E, C>, C>
+  {
+  public:
+    typedef typename C::Value Value;
+
+    explicit NegatedExpression(const E& rhs) : m_rhs(rhs) { }
+
+    std::size_t size() const { return m_rhs.size(); }
+    Value operator[](std::size_t i) const { return -m_rhs[i]; }
+
+  private:
+    typename ExpressionOperand<E, C>::Type m_rhs;
+  };
+
+  // lhs*rhs, where lhs is a scalar
+  template <typename E, typename C>
+  class ScaledExpression : public Expression<ScaledExpression<E, C>, C>
+  {
+  public:
+    typedef typename C::Scalar Scalar;
+    typedef typename C::Value  Value;
+
+    ScaledExpression(Scalar lhs, const E& rhs) : m_lhs(lhs), m_rhs(rhs) { }
+
+    std::size_t size() const { return m_rhs.size(); }
+    Value operator[](std::size_t i) const { return m_lhs*m_rhs[i]; }
+
+    Scalar   lhs() const { return m_lhs; }
+    const E& rhs() const { return m_rhs; }
+
+  private:
+    Scalar m_lhs;
+    typename ExpressionOperand<E, C>::Type m_rhs;
+  };
+
+  // lhs/rhs, where rhs is a scalar
+  template <typename E, typename C>
+  class QuotientExpression : public Expression<QuotientExpression<E, C>, C>
+  {
+  public:
+    typedef typename C::Scalar Scalar;
+    typedef typename C::Value  Value;
+
+    QuotientExpression(const E& lhs, Scalar rhs) : m_lhs(lhs), m_rhs(rhs) { }
+
+    std::size_t size() const { return m_lhs.size(); }
+    Value operator[](std::size_t i) const { return m_lhs[i]/m_rhs; }
+
+  private:
+    typename ExpressionOperand<E, C>::Type m_lhs;
+    Scalar m_rhs;
+  };
+
+  // Adds the first J terms of a LinearCombinationExpression, in order
+  template <unsigned int J>
+  class LinearCombinationTerms
+  {
+  public:
+    template <typename E, typename Value>
+    static void add(Value& ret, const E& e, std::size_t i)
+    {
+      LinearCombinationTerms<J - 1>::add(ret, e, i);
+      e.addTerm(ret, J - 1, i);
+    }
+
+  private:
+    LinearCombinationTerms();
+  };
+
+  template <>
+  class LinearCombinationTerms<0>
+  {
+  public:
+    template <typename E, typename Value>
+    static void add(Value&, const E&, std::size_t) { }
+
+  private:
+    LinearCombinationTerms();
+  };
+
+  // y + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1])
+  //
+  // Used for the stages of RK methods.  The sum is unrolled, and terms with
+  // zero coefficients are skipped, so for the constant tableaus of RK
+  // methods each element is computed with straight-line code.
+  template <typename C, unsigned int S>
+  class LinearCombinationExpression
+    : public Expression<LinearCombinationExpression<C, S>, C>
+  {
+  public:
+    typedef typename C::Scalar Scalar;
+    typedef typename C::Value  Value;
+
+    LinearCombinationExpression(const C& y, Scalar h, const Scalar* a,
+                                const C* k)
+      : m_y(y), m_h(h), m_a(a), m_k(k) { }
+
+    std::size_t size() const { return m_y.size(); }
+    Value operator[](std::size_t i) const;
+
+    // ret += h*a[j]*k[j][i], unless a[j] is zero
+    void addTerm(Value& ret, unsigned int j, std::size_t i) const;
+
+  private:
+    const C& m_y;
+    Scalar m_h;
+    const Scalar* m_a;
+    const C* m_k;
+  };
+
+  // The terms of E after the first, for LinearCombinationTerms
+  template <typename E>
+  class TailTerms
+  {
+  public:
+    explicit TailTerms(const E& e) : m_e(e) { }
+
+    template <typename Value>
+    void addTerm(Value& ret, unsigned int j, std::size_t i) const
+      { m_e.addTerm(ret, j + 1, i); }
+
+  private:
+    const E& m_e;
+  };
+
+  // h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1])
+  //
+  // Like LinearCombinationExpression, but without y, for the error estimates
+  // of adaptive methods.  It starts from the first term rather than from
+  // zero, so that no zero Value is needed.
+  template <typename C, unsigned int S>
+  class WeightedSumExpression
+    : public Expression<WeightedSumExpression<C, S>, C>
+  {
+  public:
+    typedef typename C::Scalar Scalar;
+    typedef typename C::Value  Value;
+
+    WeightedSumExpression(Scalar h, const Scalar* a, const C* k)
+      : m_h(h), m_a(a), m_k(k) { }
+
+    std::size_t size() const { return m_k[0].size(); }
+    Value operator[](std::size_t i) const;
+
+    // ret += h*a[j]*k[j][i], unless a[j] is zero
+    void addTerm(Value& ret, unsigned int j, std::size_t i) const;
+
+  private:
+    Scalar m_h;
+    const Scalar* m_a;
+    const C* m_k;
+  };
+
+  // Unary operators
+
+  template <typename E, typename C>
+  inline E
+  operator+(const Expression<E, C>& rhs)
+  {
+    return rhs.derived();
+  }
+
+  template <typename E, typename C>
+  inline NegatedExpression<E, C>
+  operator-(const Expression<E, C>& rhs)
+  {
+    return NegatedExpression<E, C>(rhs.derived());
+  }
+
+  // Binary operators
+
+  template <typename L, typename R, typename C>
+  inline SumExpression<L, R, C>
+  operator+(const Expression<L, C>& lhs, const Expression<R, C>& rhs)
+  {
+    return SumExpression<L, R, C>(lhs.derived(), rhs.derived());
+  }
+
+  template <typename L, typename R, typename C>
+  inline DifferenceExpression<L, R, C>
+  operator-(const Expression<L, C>& lhs, const Expression<R, C>& rhs)
+  {
+    return DifferenceExpression<L, R, C>(lhs.derived(), rhs.derived());
+  }
+
+  template <typename E, typename C>
+  inline ScaledExpression<E, C>
+  operator*(typename C::Scalar lhs, const Expression<E, C>& rhs)
+  {
+    return ScaledExpression<E, C>(lhs, rhs.derived());
+  }
+
+  template <typename E, typename C>
+  inline ScaledExpression<E, C>
+  operator*(const Expression<E, C>& lhs, typename C::Scalar rhs)
+  {
+    return ScaledExpression<E, C>(rhs, lhs.derived());
+  }
+
+  template <typename E, typename C>
+  inline QuotientExpression<E, C>
+  operator/(const Expression<E, C>& lhs, typename C::Scalar rhs)
+  {
+    return QuotientExpression<E, C>(lhs.derived(), rhs);
+  }
+
+  // Implementation
+
+  template <typename C, unsigned int S>
+  inline typename LinearCombinationExpression<C, S>::Value
+  LinearCombinationExpression<C, S>::operator[](std::size_t i) const
+  {
+    Value ret = m_y[i];
+    LinearCombinationTerms<S>::add(ret, *this, i);
+    return ret;
+  }
+
+  template <typename C, unsigned int S>
+  inline void
+  LinearCombinationExpression<C, S>::addTerm(Value& ret, unsigned int j,
+                                             std::size_t i) const
+  {
+    if (m_a[j] != Scalar(0)) {
+      ret += m_h*m_a[j]*m_k[j][i];
+    }
+  }
+
+  template <typename C, unsigned int S>
+  inline typename WeightedSumExpression<C, S>::Value
+  WeightedSumExpression<C, S>::operator[](std::size_t i) const
+  {
+    Value ret = m_h*m_a[0]*m_k[0][i];
+    LinearCombinationTerms<S - 1>::add(
+      ret, TailTerms<WeightedSumExpression>(*this), i
+    );
+    return ret;
+  }
+
+  template <typename C, unsigned int S>
+  inline void
+  WeightedSumExpression<C, S>::addTerm(Value& ret, unsigned int j,
+                                       std::size_t i) const
+  {
+    if (m_a[j] != Scalar(0)) {
+      ret += m_h*m_a[j]*m_k[j][i];
+    }
+  }
+}
+
+#endif // VZ_EXPRESSION_HPP
@@ -0,0 +1,422 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_GBS_HPP
+#define VZ_GBS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace vZ
+{
+  // Gragg-Bulirsch-Stoer extrapolation, for smooth problems at tight
+  // tolerances
+  //
+  // Row j of the extrapolation table (j == 1, 2, ...) takes a step of H
+  // with n[j] == 2*j substeps of Gragg's modified midpoint rule:
+  //   z[0] == y, z[1] == y + h*f(x, y),
+  //   z[i + 1] == z[i - 1] + 2*h*f(x + i*h, z[i]),
+  // with h == H/n[j].  Unlike the RK midpoint method in Midpoint.hpp, this
+  // leapfrog scheme is symmetric, so z[n[j]] has an error expansion in even
+  // powers of h, and each Aitken-Neville extrapolation
+  //   T[j][k + 1] == T[j][k] + (T[j][k] - T[j - 1][k])/((n[j]/n[j - k])^2 - 1)
+  // gains two orders: T[k][k] is of order 2*k.  The error of column k is
+  // measured by T[k][k] - T[k][k - 1].
+  //
+  // The order and step size are chosen as in Hairer and Wanner's ODEX, by
+  // minimizing the work per unit step (HNW II.9), and a step is accepted at
+  // the first of the columns order()/2 - 1, order()/2, order()/2 + 1 whose
+  // error is acceptable; controller() isn't used.  A step costs
+  // 1 + (n[1] - 1) + ... + (n[k] - 1) evaluations of f, for k rows.
+  //
+  // The rows are independent, so given a ThreadPool they're computed
+  // concurrently, largest first.  Then every row the step might need is
+  // computed up front, instead of one at a time until the error is
+  // acceptable, which wastes at most a row when the step converges early.
+  // The solution is the same either way, though evaluations() counts the
+  // extra rows.  f must be safe to call from several threads at once.
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericGBSIntegrator
+    : public GenericStaticIntegrator<Y, GenericGBSIntegrator<Y, F> >,
+      public GenericErrorControl<Y, GenericGBSIntegrator<Y, F> >
+  {
+    typedef GenericStaticIntegrator<Y, GenericGBSIntegrator> Base;
+    typedef GenericErrorControl<Y, GenericGBSIntegrator>     Control;
+    friend class GenericStaticIntegrator<Y, GenericGBSIntegrator>;
+
+  public:
+    typedef typename Base::Scalar Scalar;
+    typedef F                     Function;
+
+    GenericGBSIntegrator(Function f);
+    ~GenericGBSIntegrator() { }
+
+    // The function being integrated, e.g. to change its parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
+
+    // The most rows of the extrapolation table, at least 3, so the highest
+    // order is 2*rows().  The default is 9.
+    GenericGBSIntegrator& rows(unsigned int rows);
+    unsigned int rows() const { return m_rows; }
+
+    // The order aimed at for the next step
+    unsigned int order() const { return 2*m_k; }
+
+    // The pool to compute the rows on, or NULL (the default) to compute
+    // them on the calling thread
+    GenericGBSIntegrator& threadPool(ThreadPool* pool)
+      { m_pool = pool; return *this; }
+    ThreadPool* threadPool() const { return m_pool; }
+
+    // Also forgets the rejections and the order, which is chosen afresh
+    // from the tolerance
+    void reset();
+
+  protected:
+    // Evaluate f(x, y) for the first step, and choose h if it's 0
+    void start();
+    void step();
+
+  private:
+    // Computes row last - 1 - i, so the largest rows start first
+    class RowTask
+    {
+    public:
+      RowTask(GenericGBSIntegrator& integrator, unsigned int last)
+        : m_integrator(integrator), m_last(last) { }
+
+      void operator()(unsigned int i)
+        { m_integrator.calculateRow(m_last - 1 - i); }
+
+    private:
+      GenericGBSIntegrator& m_integrator;
+      unsigned int m_last;
+    };
+
+    // The number of substeps of row j, counting from 0
+    static unsigned int substeps(unsigned int j) { return 2*(j + 1); }
+
+    // Evaluate f(x, y), unless it's known already
+    void calculateF0();
+
+    // Compute z[n[j]] for row j into m_base[j]
+    void calculateRow(unsigned int j);
+
+    // Make sure the table has at least k rows, computing any missing ones
+    void extend(unsigned int k);
+
+    // Extrapolate row j, and measure its error if it has a second column
+    void extrapolate(unsigned int j);
+
+    // The step size for column k with error err, and the work per unit step
+    // it would take
+    Scalar columnStep(Scalar err, unsigned int k) const;
+    Scalar work(unsigned int k) const;
+
+    // The initial order, from the tolerance
+    unsigned int initialColumn() const;
+
+    Function m_f;
+    unsigned int m_rows, m_k;
+    ThreadPool* m_pool;
+
+    // Whether the last step was rejected
+    bool m_rejected;
+
+    // f(x, y) at the start of the step
+    Y m_f0;
+    bool m_f0Set;
+
+    // The current step, and how many rows of it have been computed and
+    // extrapolated
+    Scalar m_h;
+    unsigned int m_computed, m_extrapolated;
+
+    // The first column of each row, the current row of the table, and the
+    // scratch space of each row
+    std::vector<Y> m_base, m_t, m_z, m_fz;
+    Y m_e;
+
+    // The error of column k and the step size it suggests
+    std::vector<Scalar> m_err, m_columnH;
+  };
+
+  // Type alias
+  typedef GenericGBSIntegrator<double> GBSIntegrator;
+
+  // Implementation
+
+  template <typename Y, typename F>
+  GenericGBSIntegrator<Y, F>::GenericGBSIntegrator(Function f)
+    : m_f(f), m_rows(0), m_k(0), m_pool(0), m_rejected(false),
+      m_f0Set(false)
+  {
+    rows(9);
+  }
+
+  template <typename Y, typename F>
+  GenericGBSIntegrator<Y, F>&
+  GenericGBSIntegrator<Y, F>::rows(unsigned int rows)
+  {
+    m_rows = rows < 3 ? 3 : rows;
+    m_base.resize(m_rows);
+    m_t.resize(m_rows);
+    m_z.resize(m_rows);
+    m_fz.resize(m_rows);
+    m_err.resize(m_rows + 1);
+    m_columnH.resize(m_rows + 1);
+    if (m_k > m_rows - 1) {
+      m_k = m_rows - 1;
+    }
+    return *this;
+  }
+
+  template <typename Y, typename F>
+  void
+  GenericGBSIntegrator<Y, F>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    m_k = 0;
+    m_rejected = false;
+    m_f0Set = false;
+  }
+
+  template <typename Y, typename F>
+  unsigned int
+  GenericGBSIntegrator<Y, F>::initialColumn() const
+  {
+    // As in ODEX
+    using std::log10;
+    Scalar digits = -log10(this->rtol() + Scalar(1e-40));
+    int k = static_cast<int>(digits*Scalar(0.6) + Scalar(1.5));
+    return std::max(2, std::min(static_cast<int>(m_rows) - 1, k));
+  }
+
+  template <typename Y, typename F>
+  inline void
+  GenericGBSIntegrator<Y, F>::calculateF0()
+  {
+    if (!m_f0Set) {
+      evaluate(m_f, this->x(), this->y(), m_f0);
+      this->evaluations(this->evaluations() + 1);
+      m_f0Set = true;
+    }
+  }
+
+  template <typename Y, typename F>
+  inline void
+  GenericGBSIntegrator<Y, F>::start()
+  {
+    if (m_k == 0) {
+      m_k = initialColumn();
+    }
+
+    calculateF0();
+    if (this->h() == Scalar(0)) {
+      this->h(this->initialStep(m_f, this->x(), this->y(), m_f0, m_z[0],
+                                m_fz[0], 2*m_k - 1));
+      this->evaluations(this->evaluations() + 1);
+    }
+  }
+
+  template <typename Y, typename F>
+  void
+  GenericGBSIntegrator<Y, F>::step()
+  {
+    static const Scalar shrink = Scalar(8)/Scalar(10);
+    static const Scalar grow = Scalar(9)/Scalar(10);
+
+    calculateF0();
+
+    unsigned int k;
+    while (true) {
+      m_h = this->h();
+      m_computed = 0;
+      m_extrapolated = 0;
+
+      if (m_pool) {
+        unsigned int rows = std::min(m_k + 1, m_rows);
+        RowTask task(*this, rows);
+        m_pool->run(rows, task);
+        for (; m_computed < rows; ++m_computed) {
+          this->evaluations(this->evaluations() + substeps(m_computed) - 1);
+        }
+      }
+
+      // The convergence monitor: a step is accepted at column m_k - 1, m_k,
+      // or m_k + 1, and rejected early if convergence by column m_k + 1
+      // looks unlikely
+      bool accepted = false;
+      for (k = std::max(m_k - 1, 2U); k <= m_k + 1; ++k) {
+        extend(k);
+        Scalar err = m_err[k];
+        if (err <= Scalar(1)) {
+          accepted = true;
+          break;
+        }
+
+        Scalar ratio = Scalar(m_k + 1);
+        if (k == m_k - 1) {
+          ratio *= Scalar(m_k);
+        }
+        if (k == m_k + 1 || err > ratio*ratio) {
+          break;
+        }
+      }
+
+      if (accepted) {
+        break;
+      }
+
+      // Retry at the best order no higher than this one
+      unsigned int newK = std::min(m_k, k);
+      if (newK >= 3 && work(newK - 1) < shrink*work(newK)) {
+        --newK;
+      }
+      this->h(m_columnH[newK]);
+      m_k = newK;
+      m_rejected = true;
+      this->countRejection();
+    }
+
+    this->y(m_t[0]);
+    this->x(this->x() + m_h);
+    m_f0Set = false;
+
+    // Choose the next order, and the step size that goes with it
+    unsigned int newK = k;
+    if (k == m_k + 1) {
+      newK = m_k;
+      if (m_k >= 3 && work(m_k - 1) < shrink*work(m_k)) {
+        newK = m_k - 1;
+      }
+      if (work(k) < grow*work(newK)) {
+        newK = k;
+      }
+    } else if (k >= 3 && work(k - 1) < shrink*work(k)) {
+      newK = k - 1;
+    } else if (!m_rejected && (k == 2 || work(k) < grow*work(k - 1))) {
+      newK = k + 1;
+    }
+    newK = std::max(2U, std::min(newK, m_rows - 1));
+
+    if (newK <= k) {
+      this->h(m_columnH[newK]);
+    } else {
+      // The next column wasn't computed, so assume it would take the same
+      // work per unit step
+      Scalar a = Scalar(1), aNew;
+      for (unsigned int j = 0; j < k; ++j) {
+        a += Scalar(substeps(j) - 1);
+      }
+      aNew = a + Scalar(substeps(k) - 1);
+      this->h(m_columnH[k]*aNew/a);
+    }
+    m_k = newK;
+    m_rejected = false;
+  }
+
+  template <typename Y, typename F>
+  inline void
+  GenericGBSIntegrator<Y, F>::extend(unsigned int k)
+  {
+    for (unsigned int j = m_extrapolated; j < k; ++j) {
+      if (j >= m_computed) {
+        calculateRow(j);
+        this->evaluations(this->evaluations() + substeps(j) - 1);
+        ++m_computed;
+      }
+      extrapolate(j);
+    }
+    m_extrapolated = std::max(m_extrapolated, k);
+  }
+
+  template <typename Y, typename F>
+  inline void
+  GenericGBSIntegrator<Y, F>::calculateRow(unsigned int j)
+  {
+    unsigned int n = substeps(j);
+    Scalar h = m_h/Scalar(n), x = this->x();
+
+    // Leapfrog between the two buffers, ending in m_base[j] since n - 1 is
+    // odd
+    Y* previous = &m_base[j];
+    Y* current = &m_z[j];
+    *previous = this->y();
+    *current = this->y() + h*m_f0;
+    for (unsigned int i = 1; i < n; ++i) {
+      evaluate(m_f, x + Scalar(i)*h, *current, m_fz[j]);
+      *previous += (Scalar(2)*h)*m_fz[j];
+      std::swap(previous, current);
+    }
+  }
+
+  template <typename Y, typename F>
+  inline void
+  GenericGBSIntegrator<Y, F>::extrapolate(unsigned int j)
+  {
+    // m_t[l] holds T[j - 1][j - l] on entry, and T[j][j - l + 1] on exit
+    m_t[j] = m_base[j];
+    for (unsigned int l = j; l > 0; --l) {
+      Scalar ratio = Scalar(substeps(j))/Scalar(substeps(l - 1));
+      m_t[l - 1] = m_t[l] + (m_t[l] - m_t[l - 1])/(ratio*ratio - Scalar(1));
+    }
+
+    if (j > 0) {
+      m_e = m_t[0] - m_t[1];
+      m_err[j + 1] = this->errorNorm(m_e, m_t[0], this->y());
+      m_columnH[j + 1] = m_h*columnStep(m_err[j + 1], j + 1);
+    }
+  }
+
+  template <typename Y, typename F>
+  inline typename GenericGBSIntegrator<Y, F>::Scalar
+  GenericGBSIntegrator<Y, F>::columnStep(Scalar err, unsigned int k) const
+  {
+    // ODEX's safety factors and limits
+    using std::pow;
+    static const Scalar safety1 = Scalar(65)/Scalar(100);
+    static const Scalar safety2 = Scalar(94)/Scalar(100);
+    static const Scalar minFactor = Scalar(2)/Scalar(100);
+    static const Scalar maxFactor = Scalar(4);
+
+    if (err == Scalar(0)) {
+      return maxFactor;
+    }
+    Scalar factor = safety2*pow(safety1/err, Scalar(1)/Scalar(2*k - 1));
+    return std::max(minFactor, std::min(maxFactor, factor));
+  }
+
+  template <typename Y, typename F>
+  inline typename GenericGBSIntegrator<Y, F>::Scalar
+  GenericGBSIntegrator<Y, F>::work(unsigned int k) const
+  {
+    Scalar a = Scalar(1);
+    for (unsigned int j = 0; j < k; ++j) {
+      a += Scalar(substeps(j) - 1);
+    }
+    return a/m_columnH[k];
+  }
+}
+
+#endif // VZ_GBS_HPP
@@ -34,28 +34,35 @@ namespace vZ
   //   b  | 1/2  1/2
   //   b* | 1    0
   template <typename Y>
-  class GenericHE12Integrator : public GenericAdaptiveIntegrator<Y>
+  class HE12Tableau
   {
   public:
-    typedef typename GenericAdaptiveIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericAdaptiveIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericHE12Integrator(Function f)
-      : GenericAdaptiveIntegrator<Y>(f, 2, s_a, s_b, s_bStar) { }
-    ~GenericHE12Integrator() { }
+    static const unsigned int s_stages = 2;
+    static const unsigned int s_order  = 2;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericAdaptiveIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericAdaptiveIntegrator<Y>::BCoefficients BCoefficients;
+    HE12Tableau();
+  };
+
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericHE12Integrator
+    : public GenericAdaptiveIntegrator<Y, HE12Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, HE12Tableau<Y>, F> Base;
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
-    static BCoefficients s_bStar;
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
 
-    static Scalar s_a2Arr[1];
-    static std::vector<Scalar> s_aArr[1];
-    static Scalar s_bArr[2];
-    static Scalar s_bStarArr[2];
+    GenericHE12Integrator(Function f) : Base(f) { }
+    ~GenericHE12Integrator() { }
   };
 
   // Type alias
@@ -64,40 +71,23 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericHE12Integrator<Y>::Scalar
-  GenericHE12Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)
-  };
-
-  template <typename Y>
-  std::vector<typename GenericHE12Integrator<Y>::Scalar>
-  GenericHE12Integrator<Y>::s_aArr[1] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1)
-  };
-
-  template <typename Y>
-  typename GenericHE12Integrator<Y>::ACoefficients
-  GenericHE12Integrator<Y>::s_a(s_aArr, s_aArr + 1);
-
-  template <typename Y>
-  typename GenericHE12Integrator<Y>::Scalar
-  GenericHE12Integrator<Y>::s_bArr[2] = {
-    Scalar(1)/Scalar(2), Scalar(1)/Scalar(2)
+  const typename HE12Tableau<Y>::Scalar
+  HE12Tableau<Y>::s_a[2][2] = {
+    { Scalar(0) },
+    { Scalar(1) }
   };
 
   template <typename Y>
-  typename GenericHE12Integrator<Y>::BCoefficients
-  GenericHE12Integrator<Y>::s_b(s_bArr, s_bArr + 2);
+  const typename HE12Tableau<Y>::Scalar
+  HE12Tableau<Y>::s_b[2] = { Scalar(1)/Scalar(2), Scalar(1)/Scalar(2) };
 
   template <typename Y>
-  typename GenericHE12Integrator<Y>::Scalar
-  GenericHE12Integrator<Y>::s_bStarArr[2] = {
-    Scalar(1), Scalar(0)
-  };
+  const typename HE12Tableau<Y>::Scalar
+  HE12Tableau<Y>::s_bStar[2] = { Scalar(1), Scalar(0) };
 
   template <typename Y>
-  typename GenericHE12Integrator<Y>::BCoefficients
-  GenericHE12Integrator<Y>::s_bStar(s_bStarArr, s_bStarArr + 2);
+  const typename HE12Tableau<Y>::Scalar
+  HE12Tableau<Y>::s_c[2] = { Scalar(0), Scalar(1) };
 }
 
 #endif // VZ_HE12_HPP
@@ -34,26 +34,33 @@ namespace vZ
   //   --+---------
   //   b | 1/2 1/2
   template <typename Y>
-  class GenericHeunIntegrator : public GenericSimpleIntegrator<Y>
+  class HeunTableau
   {
   public:
-    typedef typename GenericSimpleIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericSimpleIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericHeunIntegrator(Function f)
-      : GenericSimpleIntegrator<Y>(f, s_a, s_b) { }
-    ~GenericHeunIntegrator() { }
+    static const unsigned int s_stages = 2;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericSimpleIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericSimpleIntegrator<Y>::BCoefficients BCoefficients;
+    HeunTableau();
+  };
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericHeunIntegrator
+    : public GenericSimpleIntegrator<Y, HeunTableau<Y>, F>
+  {
+    typedef GenericSimpleIntegrator<Y, HeunTableau<Y>, F> Base;
 
-    static Scalar s_a2Arr[1];
-    static std::vector<Scalar> s_aArr[1];
-    static Scalar s_bArr[2];
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericHeunIntegrator(Function f) : Base(f) { }
+    ~GenericHeunIntegrator() { }
   };
 
   // Type alias
@@ -62,30 +69,19 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericHeunIntegrator<Y>::Scalar
-  GenericHeunIntegrator<Y>::s_a2Arr[1] = {
-    Scalar(1)
+  const typename HeunTableau<Y>::Scalar
+  HeunTableau<Y>::s_a[2][2] = {
+    { Scalar(0) },
+    { Scalar(1) }
   };
 
   template <typename Y>
-  std::vector<typename GenericHeunIntegrator<Y>::Scalar>
-  GenericHeunIntegrator<Y>::s_aArr[1] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1)
-  };
-
-  template <typename Y>
-  typename GenericHeunIntegrator<Y>::ACoefficients
-  GenericHeunIntegrator<Y>::s_a(s_aArr, s_aArr + 1);
-
-  template <typename Y>
-  typename GenericHeunIntegrator<Y>::Scalar
-  GenericHeunIntegrator<Y>::s_bArr[2] = {
-    Scalar(1)/Scalar(2), Scalar(1)/Scalar(2)
-  };
+  const typename HeunTableau<Y>::Scalar
+  HeunTableau<Y>::s_b[2] = { Scalar(1)/Scalar(2), Scalar(1)/Scalar(2) };
 
   template <typename Y>
-  typename GenericHeunIntegrator<Y>::BCoefficients
-  GenericHeunIntegrator<Y>::s_b(s_bArr, s_bArr + 2);
+  const typename HeunTableau<Y>::Scalar
+  HeunTableau<Y>::s_c[2] = { Scalar(0), Scalar(1) };
 }
 
 #endif // VZ_HEUN_HPP
@@ -23,6 +23,7 @@
 
 #include <tr1/functional>
 #include <algorithm>
+#include <stdexcept>
 
 namespace vZ
 {
@@ -32,57 +33,278 @@ namespace vZ
   // If the initial value problem is specified as
   //   y' = f(x, y); y(x0) = y0
   // then an Integrator could be constructed as Integrator(f, dt).y(y0).x(x0)
+  //
+  // The integration methods take the type of f as a template parameter,
+  // which defaults to Function.  Passing the type of a function pointer,
+  // functor or lambda instead avoids the type-erased call through Function
+  // and lets f be inlined into the stage loops.
+  //
+  // f may also have the in-place form f(x, y, dydx), which writes y' into a
+  // stage buffer owned by the integrator instead of returning it.  For large
+  // systems that saves a copy of y and of the result per stage; see
+  // evaluate() below for which types of f are recognized.
   template <typename Y>
   class GenericIntegrator
   {
   public:
+    typedef Y                          State;
     typedef typename Traits<Y>::Scalar Scalar;
     typedef std::tr1::function<Y (Scalar, Y)> Function;
+    typedef std::tr1::function<void (Scalar, const Y&, Y&)> InPlaceFunction;
+
+    // The implicit methods can also be given the derivatives of f as
+    // jacobian(x, y, dfdy, dfdx); see Rosenbrock.hpp
+    typedef typename LinearAlgebra<Y>::Jacobian Jacobian;
+    typedef std::tr1::function<void (Scalar, const Y&, Jacobian&, Y&)>
+      JacobianFunction;
 
-    // By default, y, t, and h start UNDEFINED
-    GenericIntegrator(Function f)
-      : m_f(f),m_iterations(0) { }
+    // By default, y and x start UNDEFINED.  h starts at 0, which tells the
+    // adaptive integrators to choose the first step size themselves.
+    GenericIntegrator() : m_h(0), m_iterations(0), m_evaluations(0) { }
     virtual ~GenericIntegrator() { }
 
-    GenericIntegrator& y(Y y)      { m_y = y; return *this; }
-    GenericIntegrator& x(Scalar x) { m_x = x; return *this; }
-    GenericIntegrator& h(Scalar h) { m_h = h; return *this; }
+    GenericIntegrator& y(const Y& y) { m_y = y; return *this; }
+    GenericIntegrator& x(Scalar x)   { m_x = x; return *this; }
+    GenericIntegrator& h(Scalar h)   { m_h = h; return *this; }
 
-    Y      y() const { return m_y; }
-    Scalar x() const { return m_x; }
-    Scalar h() const { return m_h; }
+    const Y& y() const { return m_y; }
+    Scalar   x() const { return m_x; }
+    Scalar   h() const { return m_h; }
 
     unsigned int iterations() const { return m_iterations; }
+    // The number of evaluations of f
+    unsigned int evaluations() const { return m_evaluations; }
+
+    // Forget everything carried over from previous calls to integrate(), so
+    // the integrator can be reused for an unrelated trajectory.  y, x, and h
+    // are left alone.
+    virtual void reset() { m_iterations = 0; m_evaluations = 0; }
 
     // Integrate until x == x_final
-    void integrate(Scalar x_final);
+    //
+    // This and reset() are the only virtual calls; the step loop itself is
+    // implemented by GenericStaticIntegrator
+    virtual void integrate(Scalar x_final) = 0;
 
   protected:
-    virtual void step() = 0;
-
-    const Function& f() const { return m_f; }
+    void iterations(unsigned int iterations) { m_iterations = iterations; }
+    void evaluations(unsigned int evaluations)
+      { m_evaluations = evaluations; }
 
   private:
-    Function m_f;
     Y m_y;
     Scalar m_x, m_h;
-    unsigned int m_iterations;
+    unsigned int m_iterations, m_evaluations;
   };
 
   // Type alias
   typedef GenericIntegrator<double> Integrator;
 
+  // Make y the same size as like, for runtime-sized types.  This is a no-op
+  // for other types.
+  template <typename Y>
+  inline void
+  matchSize(Y&, const Y&)
+  {
+  }
+
+  // Evaluate dydx = f(x, y)
+  //
+  // The in-place form f(x, y, dydx) is used for function pointers and
+  // InPlaceFunction, and under C++11 for any f which accepts it; otherwise f
+  // must return y'.
+#if __cplusplus >= 201103L
+  template <typename F, typename Scalar, typename Y>
+  inline auto
+  evaluate(F& f, Scalar x, const Y& y, Y& dydx, int)
+    -> decltype(f(x, y, dydx), void())
+  {
+    matchSize(dydx, y);
+    f(x, y, dydx);
+  }
+
+  template <typename F, typename Scalar, typename Y>
+  inline void
+  evaluate(F& f, Scalar x, const Y& y, Y& dydx, long)
+  {
+    dydx = f(x, y);
+  }
+
+  template <typename F, typename Scalar, typename Y>
+  inline void
+  evaluate(F& f, Scalar x, const Y& y, Y& dydx)
+  {
+    evaluate(f, x, y, dydx, 0);
+  }
+#else
+  template <typename F, typename Scalar, typename Y>
+  inline void
+  evaluate(F& f, Scalar x, const Y& y, Y& dydx)
+  {
+    dydx = f(x, y);
+  }
+#endif
+
+  template <typename Scalar, typename Y>
+  inline void
+  evaluate(void (*f)(Scalar, const Y&, Y&), Scalar x, const Y& y, Y& dydx)
+  {
+    matchSize(dydx, y);
+    f(x, y, dydx);
+  }
+
+  template <typename Scalar, typename Y>
+  inline void
+  evaluate(std::tr1::function<void (Scalar, const Y&, Y&)>& f, Scalar x,
+           const Y& y, Y& dydx)
+  {
+    matchSize(dydx, y);
+    f(x, y, dydx);
+  }
+
+  // Statically polymorphic integrator
+  //
+  // Derived must provide a step() function, which this class calls directly
+  // rather than through a virtual function, so the step can be inlined into
+  // the integration loop.  Derived may also hide start(), which is called
+  // before stepping, and observe(), to change how the output points of the
+  // grid integrate() overloads are reached.
+  template <typename Y, typename Derived>
+  class GenericStaticIntegrator : public GenericIntegrator<Y>
+  {
+  public:
+    typedef typename GenericIntegrator<Y>::Scalar Scalar;
+
+    // Integrate until x == x_final
+    void integrate(Scalar x_final);
+
+    // Integrate over a grid of output points, calling observer(x, y) at
+    // each one, and stopping at the last
+    //
+    // The points must be increasing, and not before x().  Methods with
+    // dense output step freely past the points and interpolate them, so the
+    // step size isn't disturbed; others take a shortened step to reach each
+    // point, then go back to their old h.  Returns how many steps this saved
+    // over calling integrate(x) for each point, which takes at least one
+    // step per point.
+    template <typename ForwardIterator, typename Observer>
+    unsigned int integrate(ForwardIterator first, ForwardIterator last,
+                           Observer observer);
+
+    // The same, for the grid x() + stride, x() + 2*stride, ..., x_final.
+    // stride must be positive, or std::invalid_argument is thrown.
+    template <typename Observer>
+    unsigned int integrate(Scalar x_final, Scalar stride, Observer observer);
+
+    // Take a single step, shortened if necessary to stop at x_final
+    void advance(Scalar x_final);
+
+  protected:
+    GenericStaticIntegrator() { }
+    virtual ~GenericStaticIntegrator() { }
+
+    Derived& derived() { return static_cast<Derived&>(*this); }
+
+    // Prepare to take steps
+    void start() { }
+
+    // Reach the output point x (on the way to x_final), and pass the
+    // solution there to observer.  y is scratch space.
+    template <typename Observer>
+    void observe(Scalar x, Scalar x_final, Y& y, Observer& observer);
+
+  private:
+    static unsigned int saved(unsigned int points, unsigned int steps)
+    { return points > steps ? points - steps : 0; }
+  };
+
   // Implementations
 
-  template <typename Y>
-  void
-  GenericIntegrator<Y>::integrate(Scalar x_final)
+  template <typename Y, typename Derived>
+  inline void
+  GenericStaticIntegrator<Y, Derived>::integrate(Scalar x_final)
   {
-    while (m_x < x_final) {
-      m_h = std::min(m_h, x_final - m_x);
-      step();
-      ++m_iterations;
+    derived().start();
+
+    unsigned int iterations = this->iterations();
+    while (this->x() < x_final) {
+      this->h(std::min(this->h(), x_final - this->x()));
+      derived().step();
+      ++iterations;
     }
+    this->iterations(iterations);
+  }
+
+  template <typename Y, typename Derived>
+  template <typename ForwardIterator, typename Observer>
+  unsigned int
+  GenericStaticIntegrator<Y, Derived>::integrate(ForwardIterator first,
+                                                 ForwardIterator last,
+                                                 Observer observer)
+  {
+    if (first == last) {
+      return 0;
+    }
+
+    Scalar x_final = *first;
+    for (ForwardIterator i = first; i != last; ++i) {
+      x_final = *i;
+    }
+
+    Y y;
+    unsigned int iterations = this->iterations(), points = 0;
+    for (; first != last; ++first, ++points) {
+      derived().observe(*first, x_final, y, observer);
+    }
+    return saved(points, this->iterations() - iterations);
+  }
+
+  template <typename Y, typename Derived>
+  template <typename Observer>
+  unsigned int
+  GenericStaticIntegrator<Y, Derived>::integrate(Scalar x_final,
+                                                 Scalar stride,
+                                                 Observer observer)
+  {
+    if (!(stride > Scalar(0))) {
+      throw std::invalid_argument("vZ: the output stride must be positive");
+    }
+
+    // Multiples of stride, rather than repeated sums, so the grid doesn't
+    // drift
+    Scalar x0 = this->x();
+    Y y;
+    unsigned int iterations = this->iterations(), points = 1;
+    for (; x0 + points*stride < x_final; ++points) {
+      derived().observe(x0 + points*stride, x_final, y, observer);
+    }
+    derived().observe(x_final, x_final, y, observer);
+    return saved(points, this->iterations() - iterations);
+  }
+
+  template <typename Y, typename Derived>
+  template <typename Observer>
+  inline void
+  GenericStaticIntegrator<Y, Derived>::observe(Scalar x, Scalar, Y&,
+                                               Observer& observer)
+  {
+    Scalar h = this->h();
+    while (this->x() < x) {
+      advance(x);
+    }
+    this->h(h);
+
+    observer(this->x(), this->y());
+  }
+
+  template <typename Y, typename Derived>
+  inline void
+  GenericStaticIntegrator<Y, Derived>::advance(Scalar x_final)
+  {
+    derived().start();
+    this->h(std::min(this->h(), x_final - this->x()));
+    derived().step();
+    this->iterations(this->iterations() + 1);
   }
 }
 
@@ -0,0 +1,212 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_LANES_HPP
+#define VZ_LANES_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace vZ
+{
+  // W values of T, operated on element-wise
+  //
+  // Lanes are the scalars of the blocks integrated by
+  // GenericEnsembleIntegrator, one lane per trajectory.  Every operation is a
+  // loop of fixed length W, which the compiler turns into SIMD instructions.
+  // A T converts implicitly to Lanes with every lane equal to it.
+  template <typename T, std::size_t W>
+  class Lanes
+  {
+  public:
+    Lanes() { }
+    Lanes(T x) { std::fill(m_values, m_values + W, x); }
+
+    // Copied whole SIMD registers at a time
+    Lanes(const Lanes& x) { simdCopy(m_values, x.m_values, W); }
+    Lanes&
+    operator=(const Lanes& x)
+    {
+      simdCopy(m_values, x.m_values, W);
+      return *this;
+    }
+
+    static Lanes load(const T* p);
+    void store(T* p) const { std::copy(m_values, m_values + W, p); }
+
+    T&       operator[](std::size_t i)       { return m_values[i]; }
+    const T& operator[](std::size_t i) const { return m_values[i]; }
+
+    Lanes& operator+=(const Lanes& rhs) { return *this = *this + rhs; }
+    Lanes& operator-=(const Lanes& rhs) { return *this = *this - rhs; }
+    Lanes& operator*=(const Lanes& rhs) { return *this = *this*rhs; }
+    Lanes& operator/=(const Lanes& rhs) { return *this = *this/rhs; }
+
+    // Friends, so that Ts convert implicitly
+    friend Lanes
+    operator+(const Lanes& lhs, const Lanes& rhs)
+    {
+      Lanes ret;
+      for (std::size_t i = 0; i < W; ++i) {
+        ret.m_values[i] = lhs.m_values[i] + rhs.m_values[i];
+      }
+      return ret;
+    }
+
+    friend Lanes
+    operator-(const Lanes& lhs, const Lanes& rhs)
+    {
+      Lanes ret;
+      for (std::size_t i = 0; i < W; ++i) {
+        ret.m_values[i] = lhs.m_values[i] - rhs.m_values[i];
+      }
+      return ret;
+    }
+
+    friend Lanes
+    operator*(const Lanes& lhs, const Lanes& rhs)
+    {
+      Lanes ret;
+      for (std::size_t i = 0; i < W; ++i) {
+        ret.m_values[i] = lhs.m_values[i]*rhs.m_values[i];
+      }
+      return ret;
+    }
+
+    friend Lanes
+    operator/(const Lanes& lhs, const Lanes& rhs)
+    {
+      Lanes ret;
+      for (std::size_t i = 0; i < W; ++i) {
+        ret.m_values[i] = lhs.m_values[i]/rhs.m_values[i];
+      }
+      return ret;
+    }
+
+  private:
+    VZ_SIMD_ALIGNAS(T, W) T m_values[W];
+  };
+
+  // The number of Ts in a SIMD register, or 1 without SIMD
+  template <typename T>
+  class SIMDLanes
+  {
+  public:
+    static const std::size_t s_lanes
+      = VZ_SIMD_ALIGNMENT/sizeof(T) > 1 ? VZ_SIMD_ALIGNMENT/sizeof(T) : 1;
+
+  private:
+    SIMDLanes();
+  };
+
+  // Element-wise functions
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  operator+(const Lanes<T, W>& rhs)
+  {
+    return rhs;
+  }
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  operator-(const Lanes<T, W>& rhs)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      ret[i] = -rhs[i];
+    }
+    return ret;
+  }
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  abs(const Lanes<T, W>& x)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      using std::abs;
+      ret[i] = abs(x[i]);
+    }
+    return ret;
+  }
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  sqrt(const Lanes<T, W>& x)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      using std::sqrt;
+      ret[i] = sqrt(x[i]);
+    }
+    return ret;
+  }
+
+  // Like std::min() and std::max() in each lane
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  min(const Lanes<T, W>& lhs, const Lanes<T, W>& rhs)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      ret[i] = std::min(lhs[i], rhs[i]);
+    }
+    return ret;
+  }
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  max(const Lanes<T, W>& lhs, const Lanes<T, W>& rhs)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      ret[i] = std::max(lhs[i], rhs[i]);
+    }
+    return ret;
+  }
+
+  // mask ? lhs : rhs, in each lane
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  select(const Lanes<bool, W>& mask, const Lanes<T, W>& lhs,
+         const Lanes<T, W>& rhs)
+  {
+    Lanes<T, W> ret;
+    for (std::size_t i = 0; i < W; ++i) {
+      ret[i] = mask[i] ? lhs[i] : rhs[i];
+    }
+    return ret;
+  }
+
+  // Implementation
+
+  template <typename T, std::size_t W>
+  inline Lanes<T, W>
+  Lanes<T, W>::load(const T* p)
+  {
+    Lanes ret;
+    std::copy(p, p + W, ret.m_values);
+    return ret;
+  }
+}
+
+#endif // VZ_LANES_HPP
@@ -0,0 +1,340 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_MATRIX_HPP
+#define VZ_MATRIX_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace vZ
+{
+  // A dense square matrix, e.g. the Jacobian of a system of ODEs
+  //
+  // The elements are stored by rows, in place, so Matrices don't allocate
+  // any memory.  N == 0 gives a matrix whose size is set at runtime by
+  // resize() instead.
+  template <std::size_t N, typename T = double>
+  class Matrix
+  {
+  public:
+    typedef T Value;
+
+    Matrix() { }
+
+    std::size_t size() const { return N; }
+    void resize(std::size_t) { }
+    void fill(const T& value);
+
+    T&       operator()(std::size_t i, std::size_t j)
+      { return m_values[i*N + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const
+      { return m_values[i*N + j]; }
+
+    T*       data()       { return m_values; }
+    const T* data() const { return m_values; }
+
+  private:
+    T m_values[N*N];
+  };
+
+  // Runtime-sized specialization
+  template <typename T>
+  class Matrix<0, T>
+  {
+  public:
+    typedef T Value;
+
+    Matrix() : m_size(0) { }
+    explicit Matrix(std::size_t n) : m_size(n), m_values(n*n) { }
+
+    std::size_t size() const { return m_size; }
+    // Only allocates when the size grows
+    void resize(std::size_t n) { m_size = n; m_values.resize(n*n); }
+    void fill(const T& value);
+
+    T&       operator()(std::size_t i, std::size_t j)
+      { return m_values[i*m_size + j]; }
+    const T& operator()(std::size_t i, std::size_t j) const
+      { return m_values[i*m_size + j]; }
+
+    T*       data()       { return &m_values[0]; }
+    const T* data() const { return &m_values[0]; }
+
+  private:
+    std::size_t m_size;
+    std::vector<T> m_values;
+  };
+
+  // LU decomposition with partial pivoting, for solving linear systems
+  //
+  // factor() returns false if the matrix is singular, in which case solve()
+  // must not be called.  The iteration matrices of implicit methods, of the
+  // form c*I - J, are factored without forming them separately.
+  template <std::size_t N, typename T = double>
+  class LU
+  {
+  public:
+    LU() { }
+
+    // Factor a, or c*I - a
+    bool factor(const Matrix<N, T>& a);
+    bool factor(T c, const Matrix<N, T>& a);
+
+    // Solve A*x == b in place, where b has N contiguous values
+    void solve(T* b) const;
+
+  private:
+    Matrix<N, T> m_lu;
+    std::size_t m_pivots[N];
+  };
+
+  // Runtime-sized specialization
+  template <typename T>
+  class LU<0, T>
+  {
+  public:
+    LU() { }
+
+    bool factor(const Matrix<0, T>& a);
+    bool factor(T c, const Matrix<0, T>& a);
+
+    void solve(T* b) const;
+
+  private:
+    Matrix<0, T> m_lu;
+    std::vector<std::size_t> m_pivots;
+  };
+
+  // Max-norm, i.e. the largest row sum
+  template <std::size_t N, typename T>
+  typename Traits<T>::Scalar abs(const Matrix<N, T>& m);
+
+  // Factor the n*n matrix a in place, by Gaussian elimination with partial
+  // pivoting.  The unit lower triangle of L is stored below the diagonal of
+  // a, and U on and above it.  Returns false if a is singular.
+  template <typename T>
+  bool luFactor(T* a, std::size_t* pivots, std::size_t n);
+
+  // Solve L*U*x == b in place, given the output of luFactor()
+  template <typename T>
+  void luSolve(const T* lu, const std::size_t* pivots, std::size_t n, T* b);
+
+  // How implicit methods solve linear systems for the state type Y
+  //
+  // Jacobian is the type of df/dy, and Factorization holds the decomposition
+  // of the iteration matrix c*I - df/dy.  component(y, i) and
+  // element(J, i, j) give the real-valued components for finite
+  // differences.  The generic version treats Y as a single component, whose
+  // Jacobian is a Y; container types specialize this.
+  template <typename Y>
+  class LinearAlgebra
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+    typedef Y                          Jacobian;
+    typedef Y                          Factorization;
+
+    static std::size_t size(const Y&) { return 1; }
+    static Y&       component(Y& y, std::size_t)       { return y; }
+    static const Y& component(const Y& y, std::size_t) { return y; }
+
+    static void resize(Jacobian&, std::size_t) { }
+    static void zero(Jacobian& jac) { jac = Scalar(0); }
+    static Y& element(Jacobian& jac, std::size_t, std::size_t) { return jac; }
+
+    // Factor c*I - jac; false if it's singular
+    static bool factor(Factorization& lu, Scalar c, const Jacobian& jac)
+      { lu = c - jac; return lu != Scalar(0); }
+    // b = (c*I - jac)^-1 * b
+    static void solve(const Factorization& lu, Y& b) { b /= lu; }
+
+  private:
+    LinearAlgebra();
+  };
+
+  // Implementations
+
+  template <std::size_t N, typename T>
+  inline void
+  Matrix<N, T>::fill(const T& value)
+  {
+    for (std::size_t i = 0; i < N*N; ++i) {
+      m_values[i] = value;
+    }
+  }
+
+  template <typename T>
+  inline void
+  Matrix<0, T>::fill(const T& value)
+  {
+    for (std::size_t i = 0; i < m_size*m_size; ++i) {
+      m_values[i] = value;
+    }
+  }
+
+  template <std::size_t N, typename T>
+  typename Traits<T>::Scalar
+  abs(const Matrix<N, T>& m)
+  {
+    using std::abs;
+
+    typename Traits<T>::Scalar ret(0);
+    for (std::size_t i = 0; i < m.size(); ++i) {
+      typename Traits<T>::Scalar sum(0);
+      for (std::size_t j = 0; j < m.size(); ++j) {
+        sum += abs(m(i, j));
+      }
+      ret = std::max(ret, sum);
+    }
+    return ret;
+  }
+
+  template <std::size_t N, typename T>
+  inline bool
+  LU<N, T>::factor(const Matrix<N, T>& a)
+  {
+    m_lu = a;
+    return luFactor(m_lu.data(), m_pivots, N);
+  }
+
+  template <std::size_t N, typename T>
+  inline bool
+  LU<N, T>::factor(T c, const Matrix<N, T>& a)
+  {
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+        m_lu(i, j) = -a(i, j);
+      }
+      m_lu(i, i) += c;
+    }
+    return luFactor(m_lu.data(), m_pivots, N);
+  }
+
+  template <std::size_t N, typename T>
+  inline void
+  LU<N, T>::solve(T* b) const
+  {
+    luSolve(m_lu.data(), m_pivots, N, b);
+  }
+
+  template <typename T>
+  inline bool
+  LU<0, T>::factor(const Matrix<0, T>& a)
+  {
+    m_lu = a;
+    m_pivots.resize(a.size());
+    return a.size() == 0 || luFactor(m_lu.data(), &m_pivots[0], a.size());
+  }
+
+  template <typename T>
+  inline bool
+  LU<0, T>::factor(T c, const Matrix<0, T>& a)
+  {
+    std::size_t n = a.size();
+    m_lu.resize(n);
+    m_pivots.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t j = 0; j < n; ++j) {
+        m_lu(i, j) = -a(i, j);
+      }
+      m_lu(i, i) += c;
+    }
+    return n == 0 || luFactor(m_lu.data(), &m_pivots[0], n);
+  }
+
+  template <typename T>
+  inline void
+  LU<0, T>::solve(T* b) const
+  {
+    if (m_lu.size() > 0) {
+      luSolve(m_lu.data(), &m_pivots[0], m_lu.size(), b);
+    }
+  }
+
+  template <typename T>
+  bool
+  luFactor(T* a, std::size_t* pivots, std::size_t n)
+  {
+    using std::abs;
+
+    for (std::size_t k = 0; k < n; ++k) {
+      // Pivot on the largest element of column k
+      std::size_t p = k;
+      for (std::size_t i = k + 1; i < n; ++i) {
+        if (abs(a[i*n + k]) > abs(a[p*n + k])) {
+          p = i;
+        }
+      }
+      pivots[k] = p;
+
+      if (a[p*n + k] == T(0)) {
+        return false;
+      }
+      if (p != k) {
+        for (std::size_t j = 0; j < n; ++j) {
+          std::swap(a[k*n + j], a[p*n + j]);
+        }
+      }
+
+      // Eliminate below the pivot
+      T pivot = a[k*n + k];
+      for (std::size_t i = k + 1; i < n; ++i) {
+        T l = a[i*n + k]/pivot;
+        a[i*n + k] = l;
+        if (l != T(0)) {
+          for (std::size_t j = k + 1; j < n; ++j) {
+            a[i*n + j] -= l*a[k*n + j];
+          }
+        }
+      }
+    }
+    return true;
+  }
+
+  template <typename T>
+  void
+  luSolve(const T* lu, const std::size_t* pivots, std::size_t n, T* b)
+  {
+    // The rows of L were swapped along with the rest, so all the swaps are
+    // applied before forward substitution with L
+    for (std::size_t k = 0; k < n; ++k) {
+      std::swap(b[k], b[pivots[k]]);
+    }
+    for (std::size_t k = 0; k < n; ++k) {
+      for (std::size_t i = k + 1; i < n; ++i) {
+        b[i] -= lu[i*n + k]*b[k];
+      }
+    }
+
+    // Back substitution with U
+    for (std::size_t i = n; i-- > 0;) {
+      T sum = b[i];
+      for (std::size_t j = i + 1; j < n; ++j) {
+        sum -= lu[i*n + j]*b[j];
+      }
+      b[i] = sum/lu[i*n + i];
+    }
+  }
+}
+
+#endif // VZ_MATRIX_HPP
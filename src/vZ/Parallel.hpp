@@ -0,0 +1,294 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_PARALLEL_HPP
+#define VZ_PARALLEL_HPP
+
+#include <cstddef>
+#include <vector>
+#if __cplusplus >= 201103L
+#  include <algorithm>
+#  include <exception>
+#  include <memory>
+#  include <mutex>
+#  include <thread>
+#endif
+
+namespace vZ
+{
+  // Integrates many independent trajectories on a pool of threads
+  //
+  // Integrator may be any vZ integrator type.  Each thread makes one copy of
+  // the prototype passed to the constructor (so tolerances set on it carry
+  // over), and reuses it for every trajectory it runs, calling reset() in
+  // between.
+  //
+  // The trajectories are dealt out to the threads in contiguous ranges.  A
+  // thread which runs out of work steals the upper half of another thread's
+  // remaining range, so a few expensive trajectories (e.g. ones which reject
+  // many steps) don't leave the other threads idle.  Every trajectory is
+  // integrated exactly as it would be on its own, so the results don't
+  // depend on the number of threads, or on which thread ran what.
+  //
+  // Without C++11, the trajectories are integrated one after another on the
+  // calling thread.
+  template <typename Integrator>
+  class ParallelEnsemble
+  {
+  public:
+    typedef typename Integrator::State    Y;
+    typedef typename Integrator::Scalar   Scalar;
+    typedef typename Integrator::Function Function;
+
+    // By default, x starts UNDEFINED, h starts at 0 (see GenericIntegrator),
+    // and one thread is used per hardware thread
+    explicit ParallelEnsemble(const Integrator& prototype);
+    ~ParallelEnsemble() { }
+
+    // The initial x and h of every trajectory
+    ParallelEnsemble& x(Scalar x) { m_x = x; return *this; }
+    ParallelEnsemble& h(Scalar h) { m_h = h; return *this; }
+
+    Scalar x() const { return m_x; }
+    Scalar h() const { return m_h; }
+
+    ParallelEnsemble& threads(unsigned int threads)
+      { m_threads = threads; return *this; }
+    unsigned int threads() const { return m_threads; }
+
+    // Integrate trajectory i from y0[i] until x == x_final, with the
+    // prototype's function
+    void integrate(const std::vector<Y>& y0, Scalar x_final);
+
+    // Same, with the function Function(p[i]) for trajectory i, e.g. a
+    // functor constructed from its parameters
+    template <typename P>
+    void integrate(const std::vector<Y>& y0, const std::vector<P>& p,
+                   Scalar x_final);
+
+    // The results of the last integrate() call
+    std::size_t size() const { return m_y.size(); }
+    const Y& y(std::size_t i) const { return m_y[i]; }
+    unsigned int iterations(std::size_t i) const { return m_iterations[i]; }
+
+  private:
+    // Stands in for p when every trajectory uses the prototype's function
+    class NoParameters { };
+
+    // Install the function for trajectory i
+    template <typename P>
+    static void function(Integrator& integrator, const std::vector<P>& p,
+                         std::size_t i)
+      { integrator.f() = Function(p[i]); }
+    static void function(Integrator&, NoParameters, std::size_t) { }
+
+    template <typename Parameters>
+    void run(const std::vector<Y>& y0, const Parameters& p, Scalar x_final);
+
+    template <typename Parameters>
+    void integrate(Integrator& integrator, std::size_t i,
+                   const std::vector<Y>& y0, const Parameters& p,
+                   Scalar x_final);
+
+#if __cplusplus >= 201103L
+    // The trajectories [begin, end) left to a thread
+    class Range
+    {
+    public:
+      std::mutex mutex;
+      std::size_t begin, end;
+    };
+
+    // Take the next trajectory for thread t, stealing if necessary
+    static bool next(Range* ranges, unsigned int threads, unsigned int t,
+                     std::size_t& i);
+
+    template <typename Parameters>
+    void work(Range* ranges, unsigned int threads, unsigned int t,
+              const std::vector<Y>& y0, const Parameters& p, Scalar x_final);
+#endif
+
+    Integrator m_prototype;
+    Scalar m_x, m_h;
+    unsigned int m_threads;
+
+    std::vector<Y> m_y;
+    std::vector<unsigned int> m_iterations;
+  };
+
+  // Implementation
+
+  template <typename Integrator>
+  ParallelEnsemble<Integrator>::ParallelEnsemble(const Integrator& prototype)
+    : m_prototype(prototype), m_h(0), m_threads(1)
+  {
+#if __cplusplus >= 201103L
+    m_threads = std::max(std::thread::hardware_concurrency(), 1U);
+#endif
+  }
+
+  template <typename Integrator>
+  inline void
+  ParallelEnsemble<Integrator>::integrate(const std::vector<Y>& y0,
+                                          Scalar x_final)
+  {
+    run(y0, NoParameters(), x_final);
+  }
+
+  template <typename Integrator>
+  template <typename P>
+  inline void
+  ParallelEnsemble<Integrator>::integrate(const std::vector<Y>& y0,
+                                          const std::vector<P>& p,
+                                          Scalar x_final)
+  {
+    run(y0, p, x_final);
+  }
+
+  template <typename Integrator>
+  template <typename Parameters>
+  void
+  ParallelEnsemble<Integrator>::run(const std::vector<Y>& y0,
+                                    const Parameters& p, Scalar x_final)
+  {
+    std::size_t size = y0.size();
+    m_y = y0;
+    m_iterations.assign(size, 0);
+
+#if __cplusplus >= 201103L
+    unsigned int threads = std::max<std::size_t>(
+      std::min<std::size_t>(m_threads, size), 1
+    );
+    std::unique_ptr<Range[]> ranges(new Range[threads]);
+    for (unsigned int t = 0; t < threads; ++t) {
+      ranges[t].begin = size*t/threads;
+      ranges[t].end   = size*(t + 1)/threads;
+    }
+
+    // The calling thread is thread 0.  The first exception thrown by any
+    // thread is rethrown here, once they have all finished.
+    std::vector<std::thread> pool;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    auto worker = [&](unsigned int t) {
+      try {
+        work(ranges.get(), threads, t, y0, p, x_final);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    };
+
+    for (unsigned int t = 1; t < threads; ++t) {
+      pool.push_back(std::thread(worker, t));
+    }
+    worker(0);
+    for (std::size_t t = 0; t < pool.size(); ++t) {
+      pool[t].join();
+    }
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+#else
+    Integrator integrator(m_prototype);
+    for (std::size_t i = 0; i < size; ++i) {
+      integrate(integrator, i, y0, p, x_final);
+    }
+#endif
+  }
+
+  template <typename Integrator>
+  template <typename Parameters>
+  inline void
+  ParallelEnsemble<Integrator>::integrate(Integrator& integrator,
+                                          std::size_t i,
+                                          const std::vector<Y>& y0,
+                                          const Parameters& p,
+                                          Scalar x_final)
+  {
+    integrator.reset();
+    function(integrator, p, i);
+    integrator.y(y0[i]).x(m_x).h(m_h);
+    integrator.integrate(x_final);
+
+    m_y[i] = integrator.y();
+    m_iterations[i] = integrator.iterations();
+  }
+
+#if __cplusplus >= 201103L
+  template <typename Integrator>
+  bool
+  ParallelEnsemble<Integrator>::next(Range* ranges, unsigned int threads,
+                                     unsigned int t, std::size_t& i)
+  {
+    {
+      std::lock_guard<std::mutex> lock(ranges[t].mutex);
+      if (ranges[t].begin < ranges[t].end) {
+        i = ranges[t].begin++;
+        return true;
+      }
+    }
+
+    // Steal from the other threads in turn, starting with the next one
+    for (unsigned int v = 1; v < threads; ++v) {
+      Range& victim = ranges[(t + v)%threads];
+      std::size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.begin >= victim.end) {
+          continue;
+        }
+
+        // The upper half, rounded up so a single trajectory can be stolen
+        end = victim.end;
+        begin = end - (end - victim.begin + 1)/2;
+        victim.end = begin;
+      }
+
+      std::lock_guard<std::mutex> lock(ranges[t].mutex);
+      i = begin;
+      ranges[t].begin = begin + 1;
+      ranges[t].end = end;
+      return true;
+    }
+
+    return false;
+  }
+
+  template <typename Integrator>
+  template <typename Parameters>
+  void
+  ParallelEnsemble<Integrator>::work(Range* ranges, unsigned int threads,
+                                     unsigned int t, const std::vector<Y>& y0,
+                                     const Parameters& p, Scalar x_final)
+  {
+    Integrator integrator(m_prototype);
+    std::size_t i;
+    while (next(ranges, threads, t, i)) {
+      integrate(integrator, i, y0, p, x_final);
+    }
+  }
+#endif
+}
+
+#endif // VZ_PARALLEL_HPP
@@ -0,0 +1,283 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_PARAREAL_HPP
+#define VZ_PARAREAL_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace vZ
+{
+  // Parallel-in-time integration of a single trajectory, by Parareal
+  //
+  // [x(), x_final] is cut into slices() equal slices.  Coarse is a cheap
+  // integrator, e.g. RK4 with a large fixed h, and Fine an accurate one,
+  // e.g. DP45; call them G and F.  A coarse sweep gives a first guess U[n]
+  // at the start of every slice, and then each iteration integrates every
+  // slice with F at once, and corrects the guesses in a sequential coarse
+  // sweep:
+  //   U[n + 1] == G(U[n]) + F(U_old[n]) - G(U_old[n]).
+  // After k iterations the first k slices match integrating them with F one
+  // after another, so slices() iterations always give the sequential fine
+  // solution; the hope is that far fewer do.  Iteration stops once no U[n]
+  // moves by more than tol().
+  //
+  // Only the fine integrations run concurrently, so the wall-clock time is
+  // roughly that of the coarse sweeps plus the slowest slice of each
+  // iteration (see criticalEvaluations()).  That beats sequential Fine only
+  // if the iterations needed are well under slices(), and the coarse
+  // integrator tracks the solution well enough over a slice, which is
+  // easier for dissipative problems than for long oscillatory ones.  Coarse
+  // must at least be stable at its step size, or the guesses blow up.
+  //
+  // Both integrators are copied from the prototypes given to the
+  // constructor, and reset() before every slice, so tolerances and step
+  // sizes set on them carry over.  Given a ThreadPool, the fine slices are
+  // shared out on it, and f must be safe to call from several threads at
+  // once; the solution is the same either way.
+  template <typename Coarse, typename Fine>
+  class Parareal
+  {
+  public:
+    typedef typename Fine::State  Y;
+    typedef typename Fine::Scalar Scalar;
+
+    // By default, x starts UNDEFINED, with 16 slices, tol() of 1e-6, no
+    // bound on the iterations but slices(), and no ThreadPool
+    Parareal(const Coarse& coarse, const Fine& fine);
+    ~Parareal() { }
+
+    Parareal& x(Scalar x) { m_x = x; return *this; }
+    Scalar x() const { return m_x; }
+
+    Parareal& slices(unsigned int slices);
+    unsigned int slices() const { return m_slices; }
+
+    // The largest change in any U[n] allowed to stop iterating, measured by
+    // abs().  It should be above the error of Fine, whose solutions shift by
+    // about that much whenever U does.  0 always runs maxIterations()
+    // iterations.
+    Parareal& tol(Scalar tol) { m_tol = tol; return *this; }
+    Scalar tol() const { return m_tol; }
+
+    // At most this many iterations are run, or slices() if it's 0
+    Parareal& maxIterations(unsigned int n)
+      { m_maxIterations = n; return *this; }
+    unsigned int maxIterations() const { return m_maxIterations; }
+
+    // The pool to integrate the fine slices on, or NULL (the default) to
+    // integrate them on the calling thread
+    Parareal& threadPool(ThreadPool* pool) { m_pool = pool; return *this; }
+    ThreadPool* threadPool() const { return m_pool; }
+
+    // Integrate from y0 at x() until x == x_final
+    void integrate(const Y& y0, Scalar x_final);
+
+    // The results of the last integrate() call: the solution at x_final,
+    // and at the start of slice n (y(slices()) is y())
+    const Y& y() const { return m_u.back(); }
+    const Y& y(unsigned int n) const { return m_u[n]; }
+
+    // The iterations run, and how far U moved in iteration k, which shows
+    // how fast Parareal converged
+    unsigned int iterations() const { return m_changes.size(); }
+    Scalar change(unsigned int k) const { return m_changes[k]; }
+
+    // The evaluations of f in total, and along the critical path: the
+    // coarse sweeps plus the most expensive fine slice of each iteration.
+    // With a thread per slice, the speedup over integrating with Fine alone
+    // is about the evaluations that takes over criticalEvaluations().
+    unsigned int evaluations() const { return m_evaluations; }
+    unsigned int criticalEvaluations() const
+      { return m_criticalEvaluations; }
+
+  private:
+    // Integrates fine slice first + i
+    class SliceTask
+    {
+    public:
+      SliceTask(Parareal& parareal, unsigned int first)
+        : m_parareal(parareal), m_first(first) { }
+
+      void operator()(unsigned int i) { m_parareal.fine(m_first + i); }
+
+    private:
+      Parareal& m_parareal;
+      unsigned int m_first;
+    };
+
+    // The start of slice n
+    Scalar boundary(unsigned int n) const;
+
+    // Integrate slice n from U[n] with Coarse into g, counting the
+    // evaluations
+    void coarse(unsigned int n, Y& g);
+
+    // Integrate slice n from U[n] with Fine into m_f[n]
+    void fine(unsigned int n);
+
+    Coarse m_coarse;
+    Fine m_prototype;
+    std::vector<Fine> m_fine;
+    Scalar m_x, m_xFinal, m_tol;
+    unsigned int m_slices, m_maxIterations;
+    ThreadPool* m_pool;
+
+    // U, G(U_old), and F(U_old) for each slice, and F's evaluations
+    std::vector<Y> m_u, m_g, m_f;
+    std::vector<unsigned int> m_fineEvaluations;
+    Y m_gNew;
+
+    std::vector<Scalar> m_changes;
+    unsigned int m_evaluations, m_criticalEvaluations;
+  };
+
+  // Implementation
+
+  template <typename Coarse, typename Fine>
+  Parareal<Coarse, Fine>::Parareal(const Coarse& coarse, const Fine& fine)
+    : m_coarse(coarse), m_prototype(fine), m_tol(1e-6), m_slices(0),
+      m_maxIterations(0), m_pool(0), m_evaluations(0),
+      m_criticalEvaluations(0)
+  {
+    slices(16);
+  }
+
+  template <typename Coarse, typename Fine>
+  Parareal<Coarse, Fine>&
+  Parareal<Coarse, Fine>::slices(unsigned int slices)
+  {
+    m_slices = slices < 1 ? 1 : slices;
+    m_fine.clear();
+    m_fine.reserve(m_slices);
+    for (unsigned int n = 0; n < m_slices; ++n) {
+      m_fine.push_back(m_prototype);
+    }
+    return *this;
+  }
+
+  template <typename Coarse, typename Fine>
+  void
+  Parareal<Coarse, Fine>::integrate(const Y& y0, Scalar x_final)
+  {
+    unsigned int n, slices = m_slices;
+    m_xFinal = x_final;
+    m_u.assign(slices + 1, y0);
+    m_g.resize(slices);
+    m_f.resize(slices);
+    m_fineEvaluations.assign(slices, 0);
+    m_changes.clear();
+    m_evaluations = 0;
+
+    // The first guess
+    for (n = 0; n < slices; ++n) {
+      coarse(n, m_g[n]);
+      m_u[n + 1] = m_g[n];
+    }
+    m_criticalEvaluations = m_evaluations;
+
+    unsigned int maxIterations = m_maxIterations;
+    if (maxIterations == 0 || maxIterations > slices) {
+      maxIterations = slices;
+    }
+
+    // U[0..k] are final at the start of iteration k
+    for (unsigned int k = 0; k < maxIterations; ++k) {
+      SliceTask task(*this, k);
+      if (m_pool) {
+        m_pool->run(slices - k, task);
+      } else {
+        for (n = k; n < slices; ++n) {
+          task(n - k);
+        }
+      }
+
+      unsigned int slowest = 0;
+      for (n = k; n < slices; ++n) {
+        m_evaluations += m_fineEvaluations[n];
+        slowest = std::max(slowest, m_fineEvaluations[n]);
+      }
+      m_criticalEvaluations += slowest;
+
+      // G(U[k]) == G(U_old[k]) since U[k] is final, so U[k + 1] == F(U[k])
+      using std::abs;
+      Scalar change = abs(m_f[k] - m_u[k + 1]);
+      m_u[k + 1] = m_f[k];
+
+      unsigned int before = m_evaluations;
+      for (n = k + 1; n < slices; ++n) {
+        coarse(n, m_gNew);
+        Y u = m_gNew + m_f[n] - m_g[n];
+        change = std::max(change, abs(u - m_u[n + 1]));
+        m_u[n + 1] = u;
+        m_g[n] = m_gNew;
+      }
+      m_criticalEvaluations += m_evaluations - before;
+
+      m_changes.push_back(change);
+      if (change <= m_tol) {
+        break;
+      }
+    }
+  }
+
+  template <typename Coarse, typename Fine>
+  inline typename Parareal<Coarse, Fine>::Scalar
+  Parareal<Coarse, Fine>::boundary(unsigned int n) const
+  {
+    if (n == m_slices) {
+      return m_xFinal;
+    } else {
+      return m_x + (m_xFinal - m_x)*n/m_slices;
+    }
+  }
+
+  template <typename Coarse, typename Fine>
+  void
+  Parareal<Coarse, Fine>::coarse(unsigned int n, Y& g)
+  {
+    Scalar h = m_coarse.h();
+    m_coarse.reset();
+    m_coarse.y(m_u[n]).x(boundary(n));
+    m_coarse.integrate(boundary(n + 1));
+    g = m_coarse.y();
+    m_evaluations += m_coarse.evaluations();
+    m_coarse.h(h);
+  }
+
+  template <typename Coarse, typename Fine>
+  void
+  Parareal<Coarse, Fine>::fine(unsigned int n)
+  {
+    Fine& integrator = m_fine[n];
+    Scalar h = integrator.h();
+    integrator.reset();
+    integrator.y(m_u[n]).x(boundary(n));
+    integrator.integrate(boundary(n + 1));
+    m_f[n] = integrator.y();
+    m_fineEvaluations[n] = integrator.evaluations();
+    integrator.h(h);
+  }
+}
+
+#endif // VZ_PARAREAL_HPP
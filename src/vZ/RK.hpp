@@ -21,100 +21,147 @@
 #ifndef VZ_RK_HPP
 #define VZ_RK_HPP
 
-#include <vector>
-
 namespace vZ
 {
   // Base class for Runge-Kutta type algorithms
-  template <typename Y>
-  class GenericRKIntegrator : public GenericIntegrator<Y>
+  //
+  // The Tableau parameter describes the method.  It must provide
+  //   s_stages:       the number of stages, as a compile-time constant
+  //   s_a[i][j]:      the (lower triangular) coefficient matrix
+  //   s_b[i]:         the weights of the solution
+  //   s_c[i]:         the nodes, i.e. the row sums of s_a
+  // Adaptive methods additionally provide s_order and s_bStar[i].  All of
+  // these are static, so the stage loops below have fixed trip counts and
+  // constant coefficients.
+  //
+  // F is the type of the function f(x, y) being integrated, which may have
+  // the in-place form f(x, y, dydx) (see Integrator.hpp), and Derived
+  // implements step().  In-place functions write straight into the stage
+  // buffers.
+  template <typename Y, typename Tableau, typename F, typename Derived>
+  class GenericRKIntegrator : public GenericStaticIntegrator<Y, Derived>
   {
   public:
-    typedef typename GenericIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericIntegrator<Y>::Function Function;
+    typedef typename GenericStaticIntegrator<Y, Derived>::Scalar Scalar;
+    typedef F                                                    Function;
 
-  protected:
-    // Coefficients in the tableau representation of the RK algorithm
-    typedef std::vector<std::vector<Scalar> > ACoefficients;
-    typedef std::vector<Scalar>               BCoefficients;
+    // The function being integrated, e.g. to change its parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
 
-    // Result vectors
-    typedef std::vector<Y> KVector;
+  protected:
+    // Weights of the stages in a solution
+    typedef Scalar BCoefficients[Tableau::s_stages];
 
-    GenericRKIntegrator(Function f) : GenericIntegrator<Y>(f) { }
+    GenericRKIntegrator(Function f) : m_f(f) { }
     virtual ~GenericRKIntegrator() { }
 
     // Perform the stages of an RK integration
-    KVector calculateK(const ACoefficients& a) const;
-    KVector calculateK(Y& y, const ACoefficients& a) const;
-    KVector calculateK(Y k1, Y& y, const ACoefficients& a) const;
-    Y calculateY(const KVector& k, const BCoefficients& b) const;
+    //
+    // The stages are stored in k(0)..k(s - 1), which are owned by the
+    // integrator and reused across steps and retries.  calculateK1() sets
+    // k(0) = f(x, y), which doesn't depend on h; calculateK() computes the
+    // rest, leaving the argument of the last stage in y.
+    void calculateK1();
+    void calculateK(Y& y);
+    void calculateY(Y& y, const BCoefficients& b) const;
+
+    Y&       k(unsigned int i)       { return m_k[i]; }
+    const Y& k(unsigned int i) const { return m_k[i]; }
+
+  private:
+    // Compile-time stage index, to unroll the stage loop
+    template <unsigned int I>
+    class Stage { };
+
+    template <unsigned int I>
+    void calculateK(Y& y, Stage<I>);
+    void calculateK(Y&, Stage<Tableau::s_stages>) { }
+
+    Function m_f;
+    Y m_k[Tableau::s_stages];
   };
 
-  // Type alias
-  typedef GenericRKIntegrator<double> RKIntegrator;
-
-  // Implementation
-
-  template <typename Y>
-  typename GenericRKIntegrator<Y>::KVector
-  GenericRKIntegrator<Y>::calculateK(const ACoefficients& a) const
+  // y = y0 + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1])
+  //
+  // Terms with zero coefficients are skipped.  Container types overload this
+  // to evaluate the whole combination in a single pass.
+  template <unsigned int S, typename Y, typename Scalar>
+  inline void
+  linearCombination(Y& y, const Y& y0, Scalar h, const Scalar* a, const Y* k)
   {
-    Y ytemp; // Ignored
-    return calculateK(ytemp, a);
+    y = y0;
+    for (unsigned int j = 0; j < S; ++j) {
+      if (a[j] != Scalar(0)) {
+        y += h*a[j]*k[j];
+      }
+    }
   }
 
-  template <typename Y>
-  typename GenericRKIntegrator<Y>::KVector
-  GenericRKIntegrator<Y>::calculateK(Y& y, const ACoefficients& a) const
+  // e = h*(d[0]*k[0] + ... + d[S - 1]*k[S - 1])
+  template <unsigned int S, typename Y, typename Scalar>
+  inline void
+  weightedSum(Y& e, Scalar h, const Scalar* d, const Y* k)
   {
-    return calculateK(this->f()(this->x(), this->y()), y, a);
+    e = h*d[0]*k[0];
+    for (unsigned int j = 1; j < S; ++j) {
+      if (d[j] != Scalar(0)) {
+        e += h*d[j]*k[j];
+      }
+    }
   }
 
-  template <typename Y>
-  typename GenericRKIntegrator<Y>::KVector
-  GenericRKIntegrator<Y>::calculateK(Y k1, Y& y, const ACoefficients& a) const
+  // y = y0 + h*(b[0]*k[0] + ...) and e = h*(d[0]*k[0] + ...)
+  //
+  // Container types overload this to compute both in a single pass over the
+  // stages.
+  template <unsigned int S, typename Y, typename Scalar>
+  inline void
+  combineWithError(Y& y, Y& e, const Y& y0, Scalar h, const Scalar* b,
+                   const Scalar* d, const Y* k)
   {
-    KVector k;
-    k.reserve(a.size() + 1);
-
-    // k1
-    k.push_back(k1);
+    linearCombination<S>(y, y0, h, b, k);
+    weightedSum<S>(e, h, d, k);
+  }
 
-    // k2..n
-    Scalar h(this->h());
-    for (typename ACoefficients::const_iterator i = a.begin();
-         i != a.end();
-         ++i)
-    {
-      Scalar c(0);
-      y = this->y();
-      for (typename std::vector<Scalar>::size_type j = 0; j < i->size(); ++j) {
-        Scalar aij = i->at(j);
-        c += aij;
-
-        y += h*aij*k.at(j);
-      }
+  // Implementation
 
-      k.push_back(this->f()(this->x() + h*c, y));
-    }
+  template <typename Y, typename Tableau, typename F, typename Derived>
+  inline void
+  GenericRKIntegrator<Y, Tableau, F, Derived>::calculateK1()
+  {
+    evaluate(m_f, this->x(), this->y(), m_k[0]);
+    this->evaluations(this->evaluations() + 1);
+  }
 
-    return k;
+  template <typename Y, typename Tableau, typename F, typename Derived>
+  inline void
+  GenericRKIntegrator<Y, Tableau, F, Derived>::calculateK(Y& y)
+  {
+    // k2..n
+    calculateK(y, Stage<1>());
+    this->evaluations(this->evaluations() + Tableau::s_stages - 1);
   }
 
-  template <typename Y>
-  Y
-  GenericRKIntegrator<Y>::calculateY(const KVector& k, const BCoefficients& b)
-    const
+  template <typename Y, typename Tableau, typename F, typename Derived>
+  template <unsigned int I>
+  inline void
+  GenericRKIntegrator<Y, Tableau, F, Derived>::calculateK(Y& y, Stage<I>)
   {
-    Y y(this->y());
     Scalar h(this->h());
+    linearCombination<I>(y, this->y(), h, Tableau::s_a[I], m_k);
+    evaluate(m_f, this->x() + h*Tableau::s_c[I], y, m_k[I]);
 
-    for (typename std::vector<Scalar>::size_type i = 0; i < k.size(); ++i) {
-      y += h*b.at(i)*k.at(i);
-    }
+    calculateK(y, Stage<I + 1>());
+  }
 
-    return y;
+  template <typename Y, typename Tableau, typename F, typename Derived>
+  inline void
+  GenericRKIntegrator<Y, Tableau, F, Derived>::calculateY(
+    Y& y, const BCoefficients& b
+  ) const
+  {
+    linearCombination<Tableau::s_stages>(y, this->y(), this->h(), b, m_k);
   }
 }
 
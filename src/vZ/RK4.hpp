@@ -36,28 +36,33 @@ namespace vZ
   //   ----+----------------
   //   b   | 1/6 1/3 1/3 1/6
   template <typename Y>
-  class GenericRK4Integrator : public GenericSimpleIntegrator<Y>
+  class RK4Tableau
   {
   public:
-    typedef typename GenericSimpleIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericSimpleIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericRK4Integrator(Function f)
-      : GenericSimpleIntegrator<Y>(f, s_a, s_b) { }
-    ~GenericRK4Integrator() { }
+    static const unsigned int s_stages = 4;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericSimpleIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericSimpleIntegrator<Y>::BCoefficients BCoefficients;
+    RK4Tableau();
+  };
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericRK4Integrator
+    : public GenericSimpleIntegrator<Y, RK4Tableau<Y>, F>
+  {
+    typedef GenericSimpleIntegrator<Y, RK4Tableau<Y>, F> Base;
 
-    static Scalar s_a2Arr[1];
-    static Scalar s_a3Arr[2];
-    static Scalar s_a4Arr[3];
-    static std::vector<Scalar> s_aArr[3];
-    static Scalar s_bArr[4];
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericRK4Integrator(Function f) : Base(f) { }
+    ~GenericRK4Integrator() { }
   };
 
   // Type alias
@@ -66,36 +71,17 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericRK4Integrator<Y>::Scalar
-  GenericRK4Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)/Scalar(2)
-  };
-  template <typename Y>
-  typename GenericRK4Integrator<Y>::Scalar
-  GenericRK4Integrator<Y>::s_a3Arr[2] = {
-    Scalar(0), Scalar(1)/Scalar(2)
+  const typename RK4Tableau<Y>::Scalar
+  RK4Tableau<Y>::s_a[4][4] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(2) },
+    { Scalar(0), Scalar(1)/Scalar(2) },
+    { Scalar(0), Scalar(0), Scalar(1) }
   };
-  template <typename Y>
-  typename GenericRK4Integrator<Y>::Scalar
-  GenericRK4Integrator<Y>::s_a4Arr[3] = {
-    Scalar(0), Scalar(0), Scalar(1)
-  };
-
-  template <typename Y>
-  std::vector<typename GenericRK4Integrator<Y>::Scalar>
-  GenericRK4Integrator<Y>::s_aArr[3] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1),
-    std::vector<Scalar>(s_a3Arr, s_a3Arr + 2),
-    std::vector<Scalar>(s_a4Arr, s_a4Arr + 3)
-  };
-
-  template <typename Y>
-  typename GenericRK4Integrator<Y>::ACoefficients
-  GenericRK4Integrator<Y>::s_a(s_aArr, s_aArr + 3);
 
   template <typename Y>
-  typename GenericRK4Integrator<Y>::Scalar
-  GenericRK4Integrator<Y>::s_bArr[4] = {
+  const typename RK4Tableau<Y>::Scalar
+  RK4Tableau<Y>::s_b[4] = {
     Scalar(1)/Scalar(6),
     Scalar(1)/Scalar(3),
     Scalar(1)/Scalar(3),
@@ -103,8 +89,13 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericRK4Integrator<Y>::BCoefficients
-  GenericRK4Integrator<Y>::s_b(s_bArr, s_bArr + 4);
+  const typename RK4Tableau<Y>::Scalar
+  RK4Tableau<Y>::s_c[4] = {
+    Scalar(0),
+    Scalar(1)/Scalar(2),
+    Scalar(1)/Scalar(2),
+    Scalar(1)
+  };
 }
 
 #endif // VZ_RK4_HPP
@@ -38,32 +38,35 @@ namespace vZ
   //   b     | 25/216      0          1408/2565   2197/4104   -1/5   0
   //   b*    | 16/135      0          6656/12825  28561/56430 -9/50  2/55
   template <typename Y>
-  class GenericRKF45Integrator : public GenericAdaptiveIntegrator<Y>
+  class RKF45Tableau
   {
   public:
-    typedef typename GenericAdaptiveIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericAdaptiveIntegrator<Y>::Function Function;
+    typedef typename Traits<Y>::Scalar Scalar;
 
-    GenericRKF45Integrator(Function f)
-      : GenericAdaptiveIntegrator<Y>(f, 5, s_a, s_b, s_bStar) { }
-    ~GenericRKF45Integrator() { }
+    static const unsigned int s_stages = 6;
+    static const unsigned int s_order  = 5;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
 
   private:
-    typedef typename GenericAdaptiveIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericAdaptiveIntegrator<Y>::BCoefficients BCoefficients;
+    RKF45Tableau();
+  };
 
-    static ACoefficients s_a;
-    static BCoefficients s_b;
-    static BCoefficients s_bStar;
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericRKF45Integrator
+    : public GenericAdaptiveIntegrator<Y, RKF45Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, RKF45Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
 
-    static Scalar s_a2Arr[1];
-    static Scalar s_a3Arr[2];
-    static Scalar s_a4Arr[3];
-    static Scalar s_a5Arr[4];
-    static Scalar s_a6Arr[5];
-    static std::vector<Scalar> s_aArr[5];
-    static Scalar s_bArr[6];
-    static Scalar s_bStarArr[6];
+    GenericRKF45Integrator(Function f) : Base(f) { }
+    ~GenericRKF45Integrator() { }
   };
 
   // Type alias
@@ -72,72 +75,45 @@ namespace vZ
   // Implementation
 
   template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_a2Arr[1] = {
-    Scalar(1)/Scalar(4)
-  };
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_a3Arr[2] = {
-    Scalar(3)/Scalar(32), Scalar(9)/Scalar(32)
-  };
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_a4Arr[3] = {
-     Scalar(1932)/Scalar(2197),
-    -Scalar(7200)/Scalar(2197),
-     Scalar(7296)/Scalar(2197)
-  };
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_a5Arr[4] = {
-     Scalar(439)/Scalar(216),
-    -Scalar(8),
-     Scalar(3680)/Scalar(513),
-    -Scalar(845)/Scalar(4104),
-  };
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_a6Arr[5] = {
-    -Scalar(8)/Scalar(27),
-     Scalar(2),
-    -Scalar(3544)/Scalar(2565),
-     Scalar(1859)/Scalar(4104),
-    -Scalar(11)/Scalar(40)
-  };
-
-  template <typename Y>
-  std::vector<typename GenericRKF45Integrator<Y>::Scalar>
-  GenericRKF45Integrator<Y>::s_aArr[5] = {
-    std::vector<Scalar>(s_a2Arr, s_a2Arr + 1),
-    std::vector<Scalar>(s_a3Arr, s_a3Arr + 2),
-    std::vector<Scalar>(s_a4Arr, s_a4Arr + 3),
-    std::vector<Scalar>(s_a5Arr, s_a5Arr + 4),
-    std::vector<Scalar>(s_a6Arr, s_a6Arr + 5)
+  const typename RKF45Tableau<Y>::Scalar
+  RKF45Tableau<Y>::s_a[6][6] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(4) },
+    { Scalar(3)/Scalar(32), Scalar(9)/Scalar(32) },
+    {
+       Scalar(1932)/Scalar(2197),
+      -Scalar(7200)/Scalar(2197),
+       Scalar(7296)/Scalar(2197)
+    },
+    {
+       Scalar(439)/Scalar(216),
+      -Scalar(8),
+       Scalar(3680)/Scalar(513),
+      -Scalar(845)/Scalar(4104)
+    },
+    {
+      -Scalar(8)/Scalar(27),
+       Scalar(2),
+      -Scalar(3544)/Scalar(2565),
+       Scalar(1859)/Scalar(4104),
+      -Scalar(11)/Scalar(40)
+    }
   };
 
   template <typename Y>
-  typename GenericRKF45Integrator<Y>::ACoefficients
-  GenericRKF45Integrator<Y>::s_a(s_aArr, s_aArr + 5);
-
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_bArr[6] = {
+  const typename RKF45Tableau<Y>::Scalar
+  RKF45Tableau<Y>::s_b[6] = {
      Scalar(16)/Scalar(135),
      Scalar(0),
      Scalar(6656)/Scalar(12825),
      Scalar(28561)/Scalar(56430),
     -Scalar(9)/Scalar(50),
-     Scalar(2)/Scalar(55),
+     Scalar(2)/Scalar(55)
   };
 
   template <typename Y>
-  typename GenericRKF45Integrator<Y>::BCoefficients
-  GenericRKF45Integrator<Y>::s_b(s_bArr, s_bArr + 6);
-
-  template <typename Y>
-  typename GenericRKF45Integrator<Y>::Scalar
-  GenericRKF45Integrator<Y>::s_bStarArr[6] = {
+  const typename RKF45Tableau<Y>::Scalar
+  RKF45Tableau<Y>::s_bStar[6] = {
      Scalar(25)/Scalar(216),
      Scalar(0),
      Scalar(1408)/Scalar(2565),
@@ -147,8 +123,15 @@ namespace vZ
   };
 
   template <typename Y>
-  typename GenericRKF45Integrator<Y>::BCoefficients
-  GenericRKF45Integrator<Y>::s_bStar(s_bStarArr, s_bStarArr + 6);
+  const typename RKF45Tableau<Y>::Scalar
+  RKF45Tableau<Y>::s_c[6] = {
+    Scalar(0),
+    Scalar(1)/Scalar(4),
+    Scalar(3)/Scalar(8),
+    Scalar(12)/Scalar(13),
+    Scalar(1),
+    Scalar(1)/Scalar(2)
+  };
 }
 
 #endif // VZ_RKF45_HPP
@@ -0,0 +1,235 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_RKN_HPP
+#define VZ_RKN_HPP
+
+#include <algorithm>
+
+namespace vZ
+{
+  // Base class for adaptive Runge-Kutta-Nystrom methods
+  //
+  // These integrate second-order systems y'' == f(x, y) directly, rather
+  // than the first-order system (y, y')' == (y', f(x, y)) that the other
+  // integrators need.  The state is a PhaseSpace<Y> (see Symplectic.hpp),
+  // with q() == y and p() == y', so f only sees the positions and there's
+  // no stage work for the trivial half y' == v.  An s-stage method takes
+  //   Y[i] == y + c[i]*h*y' + h^2*(a[i][0]*k[0] + ...)
+  //   k[i] == f(x + c[i]*h, Y[i])
+  // and
+  //   y(x + h)  == y + h*y' + h^2*(bBar[0]*k[0] + ...)
+  //   y'(x + h) == y' + h*(b[0]*k[0] + ...)
+  //
+  // The Tableau parameter must provide
+  //   s_stages, s_order:  as for the adaptive RK methods
+  //   s_errorOrder:       the order of the error estimate, for the
+  //                       step size controller
+  //   s_a[i][j], s_c[i]:  the (strictly lower triangular) coefficients and
+  //                       the nodes
+  //   s_bBar[i], s_b[i]:  the weights of y and y'
+  //   s_bBarStar[i], s_bStar[i]:  the same for the embedded solution
+  // The error of a step is the larger of those of y and y'.  Methods whose
+  // last stage is evaluated at the new y are FSAL, which is detected as for
+  // the RK methods.
+  template <typename Y, typename Tableau, typename F>
+  class GenericRKNIntegrator
+    : public GenericStaticIntegrator<
+        PhaseSpace<Y>, GenericRKNIntegrator<Y, Tableau, F>
+      >,
+      public GenericErrorControl<Y, GenericRKNIntegrator<Y, Tableau, F> >
+  {
+    typedef GenericStaticIntegrator<PhaseSpace<Y>, GenericRKNIntegrator>
+      Base;
+    typedef GenericErrorControl<Y, GenericRKNIntegrator> Control;
+    friend class GenericStaticIntegrator<PhaseSpace<Y>, GenericRKNIntegrator>;
+
+  public:
+    typedef typename Base::Scalar Scalar;
+    typedef F                     Function;
+
+    // The function being integrated, e.g. to change its parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
+
+    // y and y'
+    const Y& q() const { return this->y().q(); }
+    const Y& p() const { return this->y().p(); }
+
+    // Also forgets the rejections, the controller's history, and the cached
+    // FSAL stage, which must be done after changing y() by hand
+    void reset();
+
+  protected:
+    GenericRKNIntegrator(Function f);
+    virtual ~GenericRKNIntegrator() { }
+
+    // Evaluate f(x, y) for the first step, and choose h if it's 0
+    void start();
+    void step();
+
+  private:
+    // Compile-time stage index, to unroll the stage loop
+    template <unsigned int I>
+    class Stage { };
+
+    // k[0] = f(x, y), unless it's known already
+    void calculateK1();
+
+    // Compute k[1]..k[s - 1], leaving the argument of the last stage in y
+    template <unsigned int I>
+    void calculateK(Y& y, Stage<I>);
+    void calculateK(Y&, Stage<Tableau::s_stages>) { }
+
+    Function m_f;
+    Y m_k[Tableau::s_stages];
+    bool m_fsal, m_k1Set;
+
+    // The weights of the error estimates of y and y'
+    Scalar m_dBar[Tableau::s_stages], m_d[Tableau::s_stages];
+
+    // The candidate solution and its error estimates
+    PhaseSpace<Y> m_yNew;
+    Y m_yErr, m_vErr;
+  };
+
+  // Implementations
+
+  template <typename Y, typename Tableau, typename F>
+  GenericRKNIntegrator<Y, Tableau, F>::GenericRKNIntegrator(Function f)
+    : m_f(f), m_fsal(true), m_k1Set(false)
+  {
+    static const unsigned int last = Tableau::s_stages - 1;
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      m_dBar[i] = Tableau::s_bBar[i] - Tableau::s_bBarStar[i];
+      m_d[i] = Tableau::s_b[i] - Tableau::s_bStar[i];
+    }
+
+    // First Same As Last: the last stage is evaluated at the new y
+    for (unsigned int i = 0; i < last; ++i) {
+      if (Tableau::s_a[last][i] != Tableau::s_bBar[i]) {
+        m_fsal = false;
+      }
+    }
+    if (Tableau::s_bBar[last] != Scalar(0)
+        || Tableau::s_c[last] != Scalar(1)) {
+      m_fsal = false;
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  void
+  GenericRKNIntegrator<Y, Tableau, F>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    m_k1Set = false;
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericRKNIntegrator<Y, Tableau, F>::start()
+  {
+    calculateK1();
+    if (this->h() != Scalar(0)) {
+      return;
+    }
+
+    // y'' is already known, so unlike for first-order systems, choosing
+    // the step size costs no extra evaluations
+    Scalar y0 = this->errorNorm(q(), q(), q());
+    Scalar f0 = this->errorNorm(p(), q(), q());
+    Scalar h0 = initialStepGuess(y0, f0, Scalar(1));
+    Scalar df = h0*this->errorNorm(m_k[0], q(), q());
+    this->h(initialStep(h0, f0, df, Scalar(1), Tableau::s_errorOrder));
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericRKNIntegrator<Y, Tableau, F>::step()
+  {
+    static const unsigned int s = Tableau::s_stages;
+    Scalar newH = this->h();
+
+    calculateK1();
+    while (true) {
+      Scalar h = this->h();
+
+      calculateK(m_yNew.q(), Stage<1>());
+      this->evaluations(this->evaluations() + s - 1);
+      if (!m_fsal) {
+        linearCombination<s>(m_yNew.q(), q(), h*h, Tableau::s_bBar, m_k);
+        m_yNew.q() += h*p();
+      }
+      linearCombination<s>(m_yNew.p(), p(), h, Tableau::s_b, m_k);
+
+      weightedSum<s>(m_yErr, h*h, m_dBar, m_k);
+      weightedSum<s>(m_vErr, h, m_d, m_k);
+      Scalar err = std::max(this->errorNorm(m_yErr, m_yNew.q(), q()),
+                            this->errorNorm(m_vErr, m_yNew.p(), p()));
+      if (err == Scalar(0)) {
+        break;
+      }
+
+      if (err > Scalar(1)) {
+        this->h(this->reject(h, err, Tableau::s_errorOrder));
+      } else {
+        newH = this->accept(h, err, Tableau::s_errorOrder);
+        break;
+      }
+    }
+
+    this->y(m_yNew);
+    this->x(this->x() + this->h());
+    this->h(newH);
+
+    if (m_fsal) {
+      m_k[0] = m_k[s - 1];
+    } else {
+      m_k1Set = false;
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericRKNIntegrator<Y, Tableau, F>::calculateK1()
+  {
+    if (!m_k1Set) {
+      evaluate(m_f, this->x(), q(), m_k[0]);
+      this->evaluations(this->evaluations() + 1);
+      m_k1Set = true;
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  template <unsigned int I>
+  inline void
+  GenericRKNIntegrator<Y, Tableau, F>::calculateK(Y& y, Stage<I>)
+  {
+    Scalar h(this->h());
+    linearCombination<I>(y, q(), h*h, Tableau::s_a[I], m_k);
+    y += (Tableau::s_c[I]*h)*p();
+    evaluate(m_f, this->x() + h*Tableau::s_c[I], y, m_k[I]);
+
+    calculateK(y, Stage<I + 1>());
+  }
+}
+
+#endif // VZ_RKN_HPP
@@ -0,0 +1,179 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_RODAS4_HPP
+#define VZ_RODAS4_HPP
+
+namespace vZ
+{
+  // Hairer and Wanner's RODAS4 method
+  //
+  // Fourth-order Rosenbrock method with embedded third-order, and six
+  // stages.  It's L-stable and stiffly accurate: the solution is the
+  // argument of a final stage, so it damps very stiff components completely.
+  // The error estimate is just that stage's u.  The coefficients are those
+  // of Hairer and Wanner's RODAS (IV.7), with gamma == 1/4.
+  template <typename Y>
+  class RODAS4Tableau
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+
+    static const unsigned int s_stages = 6;
+    static const unsigned int s_order  = 4;
+
+    static const Scalar s_gamma;
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_c[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_alpha[s_stages];
+    static const Scalar s_gammaSum[s_stages];
+
+  private:
+    RODAS4Tableau();
+  };
+
+  template <typename Y,
+            typename F = typename GenericIntegrator<Y>::Function,
+            typename J = typename GenericIntegrator<Y>::JacobianFunction>
+  class GenericRODAS4Integrator
+    : public GenericRosenbrockIntegrator<Y, RODAS4Tableau<Y>, F, J>
+  {
+    typedef GenericRosenbrockIntegrator<Y, RODAS4Tableau<Y>, F, J> Base;
+
+  public:
+    typedef typename Base::Scalar           Scalar;
+    typedef typename Base::Function         Function;
+    typedef typename Base::JacobianFunction JacobianFunction;
+
+    GenericRODAS4Integrator(Function f) : Base(f) { }
+    GenericRODAS4Integrator(Function f, JacobianFunction jacobian)
+      : Base(f, jacobian) { }
+    ~GenericRODAS4Integrator() { }
+  };
+
+  // Type alias
+  typedef GenericRODAS4Integrator<double> RODAS4Integrator;
+
+  // Implementation
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_gamma = Scalar(1)/Scalar(4);
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_a[6][6] = {
+    { Scalar(0) },
+    { Scalar(1.544) },
+    { Scalar(0.9466785280815826), Scalar(0.2557011698983284) },
+    {
+      Scalar(3.314825187068521),
+      Scalar(2.896124015972201),
+      Scalar(0.9986419139977817)
+    },
+    {
+      Scalar(1.221224509226641),
+      Scalar(6.019134481288629),
+      Scalar(12.53708332932087),
+      Scalar(-0.6878860361058950)
+    },
+    {
+      Scalar(1.221224509226641),
+      Scalar(6.019134481288629),
+      Scalar(12.53708332932087),
+      Scalar(-0.6878860361058950),
+      Scalar(1)
+    }
+  };
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_c[6][6] = {
+    { Scalar(0) },
+    { Scalar(-5.6688) },
+    { Scalar(-2.430093356833875), Scalar(-0.2063599157091915) },
+    {
+      Scalar(-0.1073529058151375),
+      Scalar(-9.594562251023355),
+      Scalar(-20.47028614809616)
+    },
+    {
+      Scalar(7.496443313967647),
+      Scalar(-10.24680431464352),
+      Scalar(-33.99990352819905),
+      Scalar(11.70890893206160)
+    },
+    {
+      Scalar(8.083246795921522),
+      Scalar(-7.981132988064893),
+      Scalar(-31.52159432874371),
+      Scalar(16.31930543123136),
+      Scalar(-6.058818238834054)
+    }
+  };
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_b[6] = {
+    Scalar(1.221224509226641),
+    Scalar(6.019134481288629),
+    Scalar(12.53708332932087),
+    Scalar(-0.6878860361058950),
+    Scalar(1),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_bStar[6] = {
+    Scalar(1.221224509226641),
+    Scalar(6.019134481288629),
+    Scalar(12.53708332932087),
+    Scalar(-0.6878860361058950),
+    Scalar(1),
+    Scalar(0)
+  };
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_alpha[6] = {
+    Scalar(0),
+    Scalar(0.386),
+    Scalar(0.21),
+    Scalar(0.63),
+    Scalar(1),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename RODAS4Tableau<Y>::Scalar
+  RODAS4Tableau<Y>::s_gammaSum[6] = {
+    Scalar(0.25),
+    Scalar(-0.1043),
+    Scalar(0.1035),
+    Scalar(-0.0362),
+    Scalar(0),
+    Scalar(0)
+  };
+}
+
+#endif // VZ_RODAS4_HPP
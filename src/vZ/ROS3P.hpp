@@ -0,0 +1,131 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_ROS3P_HPP
+#define VZ_ROS3P_HPP
+
+namespace vZ
+{
+  // Lang and Verwer's ROS3P method
+  //
+  // Third-order Rosenbrock method with embedded second-order, and three
+  // stages, of which the last two share their argument, so a step costs
+  // only two evaluations of f besides the Jacobian.  It's A-stable, and
+  // keeps its order on semi-discretized PDEs.  gamma == 1/2 + sqrt(3)/6,
+  // and the coefficients are irrational, so they're given to 20 digits.
+  template <typename Y>
+  class ROS3PTableau
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+
+    static const unsigned int s_stages = 3;
+    static const unsigned int s_order  = 3;
+
+    static const Scalar s_gamma;
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_c[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_alpha[s_stages];
+    static const Scalar s_gammaSum[s_stages];
+
+  private:
+    ROS3PTableau();
+  };
+
+  template <typename Y,
+            typename F = typename GenericIntegrator<Y>::Function,
+            typename J = typename GenericIntegrator<Y>::JacobianFunction>
+  class GenericROS3PIntegrator
+    : public GenericRosenbrockIntegrator<Y, ROS3PTableau<Y>, F, J>
+  {
+    typedef GenericRosenbrockIntegrator<Y, ROS3PTableau<Y>, F, J> Base;
+
+  public:
+    typedef typename Base::Scalar           Scalar;
+    typedef typename Base::Function         Function;
+    typedef typename Base::JacobianFunction JacobianFunction;
+
+    GenericROS3PIntegrator(Function f) : Base(f) { }
+    GenericROS3PIntegrator(Function f, JacobianFunction jacobian)
+      : Base(f, jacobian) { }
+    ~GenericROS3PIntegrator() { }
+  };
+
+  // Type alias
+  typedef GenericROS3PIntegrator<double> ROS3PIntegrator;
+
+  // Implementation
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_gamma = Scalar(0.78867513459481288225);
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_a[3][3] = {
+    { Scalar(0) },
+    { Scalar(1.2679491924311227065) },
+    { Scalar(1.2679491924311227065), Scalar(0) }
+  };
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_c[3][3] = {
+    { Scalar(0) },
+    { Scalar(-1.6076951545867362388) },
+    { Scalar(-3.4641016151377545871), Scalar(-1.7320508075688772935) }
+  };
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_b[3] = {
+    Scalar(2),
+    Scalar(0.57735026918962576451),
+    Scalar(0.42264973081037423549)
+  };
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_bStar[3] = {
+    Scalar(2.1132486540518711775),
+    Scalar(1),
+    Scalar(0.42264973081037423549)
+  };
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_alpha[3] = {
+    Scalar(0),
+    Scalar(1),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename ROS3PTableau<Y>::Scalar
+  ROS3PTableau<Y>::s_gammaSum[3] = {
+    Scalar(0.78867513459481288225),
+    Scalar(-0.21132486540518711775),
+    Scalar(-1.0773502691896257645)
+  };
+}
+
+#endif // VZ_ROS3P_HPP
@@ -0,0 +1,378 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_ROSENBROCK_HPP
+#define VZ_ROSENBROCK_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vZ
+{
+  // Approximate dfdy at (x, y) by forward differences, given f0 == f(x, y),
+  // with increments after Hairer and Wanner's RODAS.  This costs n
+  // evaluations of f for an n-component system; y1 and f1 are scratch space.
+  template <typename F, typename Scalar, typename Y>
+  void
+  differenceJacobian(F& f, Scalar x, const Y& y, const Y& f0,
+                     typename LinearAlgebra<Y>::Jacobian& dfdy, Y& y1, Y& f1)
+  {
+    typedef LinearAlgebra<Y> Algebra;
+    using std::abs;
+    using std::sqrt;
+
+    static const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    static const Scalar small = Scalar(1)/Scalar(100000);
+
+    std::size_t n = Algebra::size(y);
+    y1 = y;
+    for (std::size_t j = 0; j < n; ++j) {
+      Scalar delta = sqrt(eps*std::max(small, abs(Algebra::component(y, j))));
+      Algebra::component(y1, j) += delta;
+      evaluate(f, x, y1, f1);
+      Algebra::component(y1, j) = Algebra::component(y, j);
+
+      for (std::size_t i = 0; i < n; ++i) {
+        Algebra::element(dfdy, i, j)
+          = (Algebra::component(f1, i) - Algebra::component(f0, i))/delta;
+      }
+    }
+  }
+
+  // Base class for Rosenbrock (linearly implicit) methods, for stiff systems
+  //
+  // In the form of Hairer and Wanner (IV.7.25), an s-stage method solves
+  //   (I/(h*gamma) - J)*u[i] == f(x + alpha[i]*h, y + a[i][0]*u[0] + ...)
+  //                             + (c[i][0]*u[0] + ...)/h + gamma[i]*h*f_x
+  // for i = 0..s - 1 in turn, where J == df/dy and f_x == df/dx at (x, y),
+  // and then
+  //   y(x + h) == y + b[0]*u[0] + ... + b[s - 1]*u[s - 1]
+  // So a step costs one Jacobian, one LU factorization (another for each
+  // rejection), and s linear solves, but no Newton iterations.
+  //
+  // The Tableau parameter must provide
+  //   s_stages, s_order:     as for the adaptive RK methods
+  //   s_gamma:               the diagonal
+  //   s_a[i][j], s_c[i][j]:  the (strictly lower triangular) couplings
+  //   s_b[i], s_bStar[i]:    the weights of the solution and the embedded
+  //                          solution, which give the error estimate
+  //   s_alpha[i]:            the nodes
+  //   s_gammaSum[i]:         the weights of f_x
+  //
+  // The Jacobian is taken from the J function jacobian(x, y, dfdy, dfdx) if
+  // one is given, which receives dfdy and dfdx zeroed.  Otherwise it's
+  // approximated by forward differences, which cost n + 1 evaluations of f
+  // for an n-component system.  The linear algebra is done by
+  // LinearAlgebra<Y>, so Y may be a scalar, an EquationSystem, a Vector, or
+  // a DynamicEquationSystem.
+  template <typename Y, typename Tableau, typename F, typename J>
+  class GenericRosenbrockIntegrator
+    : public GenericStaticIntegrator<
+        Y, GenericRosenbrockIntegrator<Y, Tableau, F, J>
+      >,
+      public GenericErrorControl<
+        Y, GenericRosenbrockIntegrator<Y, Tableau, F, J>
+      >
+  {
+    typedef GenericStaticIntegrator<Y, GenericRosenbrockIntegrator> Base;
+    typedef GenericErrorControl<Y, GenericRosenbrockIntegrator>     Control;
+    friend class GenericStaticIntegrator<Y, GenericRosenbrockIntegrator>;
+
+  public:
+    typedef typename Base::Scalar               Scalar;
+    typedef F                                   Function;
+    typedef J                                   JacobianFunction;
+    typedef typename LinearAlgebra<Y>::Jacobian Jacobian;
+
+    // The functions being integrated, e.g. to change their parameters
+    Function&       f()       { return m_f; }
+    const Function& f() const { return m_f; }
+
+    JacobianFunction&       jacobian()       { return m_jacobian; }
+    const JacobianFunction& jacobian() const { return m_jacobian; }
+
+    // The number of Jacobians computed and LU factorizations made
+    unsigned int jacobians()      const { return m_jacobians; }
+    unsigned int factorizations() const { return m_factorizations; }
+
+    // An upper bound for h*|lambda| over the last step, where lambda is the
+    // dominant eigenvalue of df/dy: the step size times the max-norm of the
+    // Jacobian
+    Scalar stiffness() const;
+
+    // Also forgets the counts, the rejections, and the controller's
+    // history.  If h() is 0, a step size is chosen from f at the start.
+    void reset();
+
+  protected:
+    // With a finite-difference Jacobian
+    GenericRosenbrockIntegrator(Function f);
+    GenericRosenbrockIntegrator(Function f, JacobianFunction jacobian);
+    virtual ~GenericRosenbrockIntegrator() { }
+
+    // Choose h if it's 0, like the adaptive RK methods
+    void start();
+    void step();
+
+  private:
+    typedef LinearAlgebra<Y>                Algebra;
+    typedef typename Algebra::Factorization Factorization;
+
+    // Compile-time stage index, to unroll the stage loop
+    template <unsigned int I>
+    class Stage { };
+
+    // Solve for u[I] and the stages after it
+    template <unsigned int I>
+    void calculateU(Stage<I>);
+    void calculateU(Stage<Tableau::s_stages>) { }
+
+    // Precompute m_d and m_reuse
+    void initialize();
+
+    // df/dy and df/dx at (x(), y()), given m_f0
+    void calculateJacobian();
+
+    Function m_f;
+    JacobianFunction m_jacobian;
+    bool m_hasJacobian;
+
+    // f(x(), y()), if it's been evaluated by start()
+    Y m_f0;
+    bool m_f0Set;
+
+    Jacobian m_dfdy;
+    Y m_dfdx;
+    Scalar m_hLast;
+    Factorization m_lu;
+
+    // The weights b[i] - b*[i] of the error estimate
+    Scalar m_d[Tableau::s_stages];
+    // Whether stage i has the same argument as stage i - 1, so f need not
+    // be evaluated again
+    bool m_reuse[Tableau::s_stages];
+
+    // The stages, the last evaluation of f, the candidate solution, and its
+    // error estimate, reused across steps
+    Y m_u[Tableau::s_stages];
+    Y m_k, m_yNew, m_yErr;
+
+    unsigned int m_jacobians, m_factorizations;
+  };
+
+  // Implementations
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::GenericRosenbrockIntegrator(
+    Function f
+  )
+    : m_f(f), m_jacobian(), m_hasJacobian(false), m_f0Set(false),
+      m_hLast(0), m_jacobians(0), m_factorizations(0)
+  {
+    initialize();
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::GenericRosenbrockIntegrator(
+    Function f, JacobianFunction jacobian
+  )
+    : m_f(f), m_jacobian(jacobian), m_hasJacobian(true), m_f0Set(false),
+      m_hLast(0), m_jacobians(0), m_factorizations(0)
+  {
+    initialize();
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::initialize()
+  {
+    static const unsigned int S = Tableau::s_stages;
+
+    for (unsigned int i = 0; i < S; ++i) {
+      m_d[i] = Tableau::s_b[i] - Tableau::s_bStar[i];
+    }
+
+    // The first stage is f(x, y) itself, which is kept separately, so only
+    // the later ones can be reused
+    m_reuse[0] = false;
+    if (S > 1) {
+      m_reuse[1] = false;
+    }
+    for (unsigned int i = 2; i < S; ++i) {
+      const Scalar* a = Tableau::s_a[i];
+      const Scalar* aPrev = Tableau::s_a[i - 1];
+      m_reuse[i] = Tableau::s_alpha[i] == Tableau::s_alpha[i - 1]
+        && std::equal(a, a + i - 1, aPrev) && a[i - 1] == Scalar(0);
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::reset()
+  {
+    Base::reset();
+    this->resetErrorControl();
+    m_f0Set = false;
+    m_hLast = 0;
+    m_jacobians = 0;
+    m_factorizations = 0;
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  inline typename GenericRosenbrockIntegrator<Y, Tableau, F, J>::Scalar
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::stiffness() const
+  {
+    using std::abs;
+    return m_hLast*abs(m_dfdy);
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  inline void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::start()
+  {
+    if (this->h() != Scalar(0)) {
+      return;
+    }
+
+    if (!m_f0Set) {
+      evaluate(m_f, this->x(), this->y(), m_f0);
+      m_f0Set = true;
+      this->evaluations(this->evaluations() + 1);
+    }
+
+    // The explicit estimate is cautious for stiff problems, which is what
+    // the first step needs anyway
+    this->h(this->initialStep(m_f, this->x(), this->y(), m_f0, m_yNew, m_k,
+                              Tableau::s_order));
+    this->evaluations(this->evaluations() + 1);
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  inline void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::step()
+  {
+    Scalar newH = this->h();
+
+    // f(x, y) and its derivatives are the same for every attempt
+    if (!m_f0Set) {
+      evaluate(m_f, this->x(), this->y(), m_f0);
+      this->evaluations(this->evaluations() + 1);
+    }
+    m_f0Set = false;
+    calculateJacobian();
+
+    // Attempt the integration step in a loop
+    while (true) {
+      Scalar h = this->h();
+      if (!Algebra::factor(m_lu, Scalar(1)/(h*Tableau::s_gamma), m_dfdy)) {
+        this->h(this->fail(h));
+        continue;
+      }
+      ++m_factorizations;
+
+      calculateU(Stage<0>());
+      combineWithError<Tableau::s_stages>(m_yNew, m_yErr, this->y(),
+                                          Scalar(1), Tableau::s_b, m_d, m_u);
+
+      // Get an error estimate
+      Scalar err = this->errorNorm(m_yErr, m_yNew, this->y());
+      if (err == Scalar(0)) {
+        break;
+      }
+
+      if (err > Scalar(1)) {
+        // Reject the step
+        this->h(this->reject(h, err, Tableau::s_order));
+      } else {
+        newH = this->accept(h, err, Tableau::s_order);
+        break;
+      }
+    }
+
+    // Update x and y
+    m_hLast = this->h();
+    this->y(m_yNew);
+    this->x(this->x() + this->h());
+
+    // Adjust the stepsize for the next iteration
+    this->h(newH);
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  template <unsigned int I>
+  inline void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::calculateU(Stage<I>)
+  {
+    Scalar h = this->h();
+    if (I > 0 && !m_reuse[I]) {
+      linearCombination<I>(m_yNew, this->y(), Scalar(1), Tableau::s_a[I],
+                           m_u);
+      evaluate(m_f, this->x() + h*Tableau::s_alpha[I], m_yNew, m_k);
+      this->evaluations(this->evaluations() + 1);
+    }
+
+    // The right-hand side, solved in place
+    Y& u = m_u[I];
+    linearCombination<I>(u, I == 0 ? m_f0 : m_k, Scalar(1)/h,
+                         Tableau::s_c[I], m_u);
+    if (Tableau::s_gammaSum[I] != Scalar(0)) {
+      u += (h*Tableau::s_gammaSum[I])*m_dfdx;
+    }
+    Algebra::solve(m_lu, u);
+
+    calculateU(Stage<I + 1>());
+  }
+
+  template <typename Y, typename Tableau, typename F, typename J>
+  void
+  GenericRosenbrockIntegrator<Y, Tableau, F, J>::calculateJacobian()
+  {
+    using std::abs;
+    using std::sqrt;
+
+    const Y& y = this->y();
+    Scalar x = this->x();
+    std::size_t n = Algebra::size(y);
+    Algebra::resize(m_dfdy, n);
+    ++m_jacobians;
+
+    if (m_hasJacobian) {
+      Algebra::zero(m_dfdy);
+      m_dfdx = Scalar(0)*y;
+      m_jacobian(x, y, m_dfdy, m_dfdx);
+      return;
+    }
+
+    // Forward differences, and df/dx by the same rule
+    differenceJacobian(m_f, x, y, m_f0, m_dfdy, m_yNew, m_k);
+
+    static const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    static const Scalar small = Scalar(1)/Scalar(100000);
+    Scalar delta = sqrt(eps*std::max(small, abs(x)));
+    evaluate(m_f, x + delta, y, m_dfdx);
+    m_dfdx -= m_f0;
+    m_dfdx *= Scalar(1)/delta;
+
+    this->evaluations(this->evaluations() + n + 1);
+  }
+}
+
+#endif // VZ_ROSENBROCK_HPP
@@ -0,0 +1,538 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_SIMD_HPP
+#define VZ_SIMD_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// The instruction set is selected at compile time, from the widest one the
+// compiler targets (e.g. with -march=native).  Define VZ_NO_SIMD to always
+// use the scalar loops.
+#if !defined(VZ_NO_SIMD)
+#  if defined(__AVX512F__)
+#    include <immintrin.h>
+#    define VZ_SIMD_ALIGNMENT 64
+#  elif defined(__AVX__)
+#    include <immintrin.h>
+#    define VZ_SIMD_ALIGNMENT 32
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define VZ_SIMD_ALIGNMENT 16
+#  endif
+#endif
+
+#ifndef VZ_SIMD_ALIGNMENT
+#  define VZ_SIMD_ALIGNMENT 0
+#endif
+
+// Aligns an array T[N] to the SIMD width, if possible.  Only done when new
+// respects over-alignment (C++17), so aligned types are safe on the heap.
+#if VZ_SIMD_ALIGNMENT && defined(__cpp_aligned_new)
+#  define VZ_SIMD_ALIGNAS(T, N)                                               \
+     alignas(T) alignas(vZ::SIMDAlignment<(N)*sizeof(T)>::s_alignment)
+#else
+#  define VZ_SIMD_ALIGNAS(T, N)
+#endif
+
+namespace vZ
+{
+  // The strongest alignment, up to the SIMD width, that an array of the given
+  // size can have without being padded, or 1 if it's too small to benefit
+  template <std::size_t Bytes, std::size_t Alignment = VZ_SIMD_ALIGNMENT>
+  class SIMDAlignment
+  {
+  public:
+    static const std::size_t s_alignment
+      = Bytes%Alignment == 0
+          ? Alignment
+          : SIMDAlignment<Bytes, Alignment/2>::s_alignment;
+
+  private:
+    SIMDAlignment();
+  };
+
+  template <std::size_t Bytes>
+  class SIMDAlignment<Bytes, 8>
+  {
+  public:
+    static const std::size_t s_alignment = 1;
+
+  private:
+    SIMDAlignment();
+  };
+
+  template <std::size_t Bytes>
+  class SIMDAlignment<Bytes, 0>
+  {
+  public:
+    static const std::size_t s_alignment = 1;
+
+  private:
+    SIMDAlignment();
+  };
+
+  // Element-wise kernels for the containers
+  //
+  // The generic versions are plain loops; the overloads for double use SIMD
+  // instructions when available.
+
+  // y = x
+  template <typename T>
+  inline void
+  simdCopy(T* y, const T* x, std::size_t n)
+  {
+    std::copy(x, x + n, y);
+  }
+
+  // y += a*x
+  template <typename T, typename Scalar>
+  inline void
+  simdAxpy(T* y, Scalar a, const T* x, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] += a*x[i];
+    }
+  }
+
+  // y *= a
+  template <typename T, typename Scalar>
+  inline void
+  simdScale(T* y, Scalar a, std::size_t n)
+  {
+    for (std::size_t i = 0; i < n; ++i) {
+      y[i] *= a;
+    }
+  }
+
+  // x . y
+  template <typename T>
+  inline typename Traits<T>::Scalar
+  simdDot(const T* x, const T* y, std::size_t n)
+  {
+    typename Traits<T>::Scalar res(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      res += x[i]*y[i];
+    }
+    return res;
+  }
+
+  // max(|x[i]|)
+  template <typename T>
+  inline typename Traits<T>::Scalar
+  simdMaxAbs(const T* x, std::size_t n)
+  {
+    typename Traits<T>::Scalar ret(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      using std::abs;
+      ret = std::max(ret, abs(x[i]));
+    }
+    return ret;
+  }
+
+  // max(|x[i] - y[i]|)
+  template <typename T>
+  inline typename Traits<T>::Scalar
+  simdMaxAbsDifference(const T* x, const T* y, std::size_t n)
+  {
+    typename Traits<T>::Scalar ret(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      using std::abs;
+      ret = std::max(ret, abs(x[i] - y[i]));
+    }
+    return ret;
+  }
+
+  // sum((|e[i]|/(atol[i] + max(|u[i]|, |v[i]|)*rtol[i]))^2), the square of
+  // the adaptive integrators' weighted RMS error norm, times n
+  template <typename T>
+  inline typename Traits<T>::Scalar
+  simdWeightedSquares(const T* e, const T* u, const T* v,
+                      const typename Traits<T>::Scalar* atol,
+                      const typename Traits<T>::Scalar* rtol, std::size_t n)
+  {
+    typedef typename Traits<T>::Scalar Scalar;
+    Scalar ret(0);
+    for (std::size_t i = 0; i < n; ++i) {
+      using std::abs;
+      Scalar r = abs(e[i])/(atol[i] + std::max(abs(u[i]), abs(v[i]))*rtol[i]);
+      ret += r*r;
+    }
+    return ret;
+  }
+
+#if VZ_SIMD_ALIGNMENT
+  // A SIMD register full of doubles
+  class SIMDPack
+  {
+  public:
+#  if defined(__AVX512F__)
+    typedef __m512d Register;
+#  elif defined(__AVX__)
+    typedef __m256d Register;
+#  else
+    typedef __m128d Register;
+#  endif
+
+    static const std::size_t s_size = sizeof(Register)/sizeof(double);
+
+    SIMDPack(Register r) : m_r(r) { }
+
+    static SIMDPack zero();
+    static SIMDPack broadcast(double x);
+    static SIMDPack load(const double* p);
+    void store(double* p) const;
+
+    Register r() const { return m_r; }
+
+    // Horizontal sum and maximum
+    double sum() const;
+    double max() const;
+
+  private:
+    Register m_r;
+  };
+
+  inline SIMDPack operator+(SIMDPack lhs, SIMDPack rhs);
+  inline SIMDPack operator-(SIMDPack lhs, SIMDPack rhs);
+  inline SIMDPack operator*(SIMDPack lhs, SIMDPack rhs);
+  inline SIMDPack operator/(SIMDPack lhs, SIMDPack rhs);
+  // Like std::max(rhs, lhs), ignoring NaNs in lhs
+  inline SIMDPack max(SIMDPack lhs, SIMDPack rhs);
+  inline SIMDPack abs(SIMDPack x);
+
+  // Kernels
+
+  // Whole registers at a time, so that copies of small arrays are not split
+  // into pieces which defeat store forwarding
+  inline void
+  simdCopy(double* y, const double* x, std::size_t n)
+  {
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      SIMDPack::load(x + i).store(y + i);
+    }
+    std::copy(x + end, x + n, y + end);
+  }
+
+  inline void
+  simdAxpy(double* y, double a, const double* x, std::size_t n)
+  {
+    SIMDPack pa = SIMDPack::broadcast(a);
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      (SIMDPack::load(y + i) + pa*SIMDPack::load(x + i)).store(y + i);
+    }
+    for (std::size_t i = end; i < n; ++i) {
+      y[i] += a*x[i];
+    }
+  }
+
+  inline void
+  simdScale(double* y, double a, std::size_t n)
+  {
+    SIMDPack pa = SIMDPack::broadcast(a);
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      (SIMDPack::load(y + i)*pa).store(y + i);
+    }
+    for (std::size_t i = end; i < n; ++i) {
+      y[i] *= a;
+    }
+  }
+
+  inline double
+  simdDot(const double* x, const double* y, std::size_t n)
+  {
+    SIMDPack acc = SIMDPack::zero();
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      acc = acc + SIMDPack::load(x + i)*SIMDPack::load(y + i);
+    }
+    double res = acc.sum();
+    for (std::size_t i = end; i < n; ++i) {
+      res += x[i]*y[i];
+    }
+    return res;
+  }
+
+  inline double
+  simdMaxAbs(const double* x, std::size_t n)
+  {
+    SIMDPack acc = SIMDPack::zero();
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      acc = max(abs(SIMDPack::load(x + i)), acc);
+    }
+    double ret = acc.max();
+    for (std::size_t i = end; i < n; ++i) {
+      ret = std::max(ret, std::abs(x[i]));
+    }
+    return ret;
+  }
+
+  inline double
+  simdMaxAbsDifference(const double* x, const double* y, std::size_t n)
+  {
+    SIMDPack acc = SIMDPack::zero();
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      acc = max(abs(SIMDPack::load(x + i) - SIMDPack::load(y + i)), acc);
+    }
+    double ret = acc.max();
+    for (std::size_t i = end; i < n; ++i) {
+      ret = std::max(ret, std::abs(x[i] - y[i]));
+    }
+    return ret;
+  }
+
+  inline double
+  simdWeightedSquares(const double* e, const double* u, const double* v,
+                      const double* atol, const double* rtol, std::size_t n)
+  {
+    SIMDPack acc = SIMDPack::zero();
+    std::size_t end = n - n%SIMDPack::s_size;
+    for (std::size_t i = 0; i < end; i += SIMDPack::s_size) {
+      SIMDPack scale = SIMDPack::load(atol + i)
+        + max(abs(SIMDPack::load(u + i)), abs(SIMDPack::load(v + i)))
+          *SIMDPack::load(rtol + i);
+      SIMDPack r = abs(SIMDPack::load(e + i))/scale;
+      acc = acc + r*r;
+    }
+    double ret = acc.sum();
+    for (std::size_t i = end; i < n; ++i) {
+      double r = std::abs(e[i])/(atol[i] + std::max(std::abs(u[i]),
+                                                    std::abs(v[i]))*rtol[i]);
+      ret += r*r;
+    }
+    return ret;
+  }
+
+  // Implementation
+
+#  if defined(__AVX512F__)
+
+  inline SIMDPack SIMDPack::zero() { return _mm512_setzero_pd(); }
+  inline SIMDPack SIMDPack::broadcast(double x) { return _mm512_set1_pd(x); }
+  inline SIMDPack
+  SIMDPack::load(const double* p)
+  {
+    return _mm512_loadu_pd(p);
+  }
+
+  inline void SIMDPack::store(double* p) const { _mm512_storeu_pd(p, m_r); }
+
+  // _mm512_reduce_*_pd() trigger spurious -Wmaybe-uninitialized warnings
+  // with some versions of GCC, so reduce by hand
+
+  inline double
+  SIMDPack::sum() const
+  {
+    __m256d zero = _mm256_setzero_pd();
+    __m256d quarter = _mm256_add_pd(
+      _mm512_mask_extractf64x4_pd(zero, 0xFF, m_r, 0),
+      _mm512_mask_extractf64x4_pd(zero, 0xFF, m_r, 1)
+    );
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(quarter),
+                              _mm256_extractf128_pd(quarter, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+
+  inline double
+  SIMDPack::max() const
+  {
+    __m256d zero = _mm256_setzero_pd();
+    __m256d quarter = _mm256_max_pd(
+      _mm512_mask_extractf64x4_pd(zero, 0xFF, m_r, 0),
+      _mm512_mask_extractf64x4_pd(zero, 0xFF, m_r, 1)
+    );
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(quarter),
+                              _mm256_extractf128_pd(quarter, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+
+  inline SIMDPack
+  operator+(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm512_add_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator-(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm512_sub_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator*(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm512_mul_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator/(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm512_div_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  max(SIMDPack lhs, SIMDPack rhs)
+  {
+    // Masked to avoid the same warning as above
+    return _mm512_maskz_max_pd(0xFF, lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  abs(SIMDPack x)
+  {
+    return _mm512_abs_pd(x.r());
+  }
+
+#  elif defined(__AVX__)
+
+  inline SIMDPack SIMDPack::zero() { return _mm256_setzero_pd(); }
+  inline SIMDPack SIMDPack::broadcast(double x) { return _mm256_set1_pd(x); }
+  inline SIMDPack
+  SIMDPack::load(const double* p)
+  {
+    return _mm256_loadu_pd(p);
+  }
+
+  inline void SIMDPack::store(double* p) const { _mm256_storeu_pd(p, m_r); }
+
+  inline double
+  SIMDPack::sum() const
+  {
+    __m128d half = _mm_add_pd(_mm256_castpd256_pd128(m_r),
+                              _mm256_extractf128_pd(m_r, 1));
+    return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+
+  inline double
+  SIMDPack::max() const
+  {
+    __m128d half = _mm_max_pd(_mm256_castpd256_pd128(m_r),
+                              _mm256_extractf128_pd(m_r, 1));
+    return _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+  }
+
+  inline SIMDPack
+  operator+(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm256_add_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator-(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm256_sub_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator*(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm256_mul_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator/(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm256_div_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  max(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm256_max_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  abs(SIMDPack x)
+  {
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x.r());
+  }
+
+#  else
+
+  inline SIMDPack SIMDPack::zero() { return _mm_setzero_pd(); }
+  inline SIMDPack SIMDPack::broadcast(double x) { return _mm_set1_pd(x); }
+  inline SIMDPack
+  SIMDPack::load(const double* p)
+  {
+    return _mm_loadu_pd(p);
+  }
+
+  inline void SIMDPack::store(double* p) const { _mm_storeu_pd(p, m_r); }
+
+  inline double
+  SIMDPack::sum() const
+  {
+    return _mm_cvtsd_f64(_mm_add_sd(m_r, _mm_unpackhi_pd(m_r, m_r)));
+  }
+
+  inline double
+  SIMDPack::max() const
+  {
+    return _mm_cvtsd_f64(_mm_max_sd(m_r, _mm_unpackhi_pd(m_r, m_r)));
+  }
+
+  inline SIMDPack
+  operator+(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm_add_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator-(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm_sub_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator*(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm_mul_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  operator/(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm_div_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  max(SIMDPack lhs, SIMDPack rhs)
+  {
+    return _mm_max_pd(lhs.r(), rhs.r());
+  }
+
+  inline SIMDPack
+  abs(SIMDPack x)
+  {
+    return _mm_andnot_pd(_mm_set1_pd(-0.0), x.r());
+  }
+
+#  endif
+#endif // VZ_SIMD_ALIGNMENT
+}
+
+#endif // VZ_SIMD_HPP
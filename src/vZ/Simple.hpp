@@ -21,42 +21,57 @@
 #ifndef VZ_SIMPLE_HPP
 #define VZ_SIMPLE_HPP
 
+#include <stdexcept>
+
 namespace vZ
 {
   // Base class for non-adaptive RK-style algorithms
-  template <typename Y>
-  class GenericSimpleIntegrator : public GenericRKIntegrator<Y>
+  //
+  // These can't choose a step size, so h must be set to a positive value
+  // before integrating, or std::invalid_argument is thrown
+  template <typename Y, typename Tableau, typename F>
+  class GenericSimpleIntegrator
+    : public GenericRKIntegrator<Y, Tableau, F,
+                                 GenericSimpleIntegrator<Y, Tableau, F> >
   {
+    typedef GenericRKIntegrator<Y, Tableau, F, GenericSimpleIntegrator> Base;
+    friend class GenericStaticIntegrator<Y, GenericSimpleIntegrator>;
+
   public:
-    typedef typename GenericRKIntegrator<Y>::Scalar   Scalar;
-    typedef typename GenericRKIntegrator<Y>::Function Function;
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
 
   protected:
-    typedef typename GenericRKIntegrator<Y>::ACoefficients ACoefficients;
-    typedef typename GenericRKIntegrator<Y>::BCoefficients BCoefficients;
-    typedef typename GenericRKIntegrator<Y>::KVector       KVector;
-
-    GenericSimpleIntegrator(Function f, ACoefficients a, BCoefficients b)
-      : GenericRKIntegrator<Y>(f), m_a(a), m_b(b) { }
+    GenericSimpleIntegrator(Function f) : Base(f) { }
     virtual ~GenericSimpleIntegrator() { }
 
+    // Check that h was given
+    void start();
     void step();
 
   private:
-    ACoefficients m_a;
-    BCoefficients m_b;
+    Y m_yNew;
   };
 
-  // Type alias
-  typedef GenericSimpleIntegrator<double> SimpleIntegrator;
-
   // Implementations
 
-  template <typename Y>
-  void
-  GenericSimpleIntegrator<Y>::step()
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericSimpleIntegrator<Y, Tableau, F>::start()
+  {
+    if (!(this->h() > Scalar(0))) {
+      throw std::invalid_argument("vZ: fixed-step integrators need h > 0");
+    }
+  }
+
+  template <typename Y, typename Tableau, typename F>
+  inline void
+  GenericSimpleIntegrator<Y, Tableau, F>::step()
   {
-    this->y(this->calculateY(this->calculateK(m_a), m_b));
+    this->calculateK1();
+    this->calculateK(m_yNew);
+    this->calculateY(m_yNew, Tableau::s_b);
+    this->y(m_yNew);
     this->x(this->x() + this->h());
   }
 }
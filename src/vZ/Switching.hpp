@@ -0,0 +1,366 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_SWITCHING_HPP
+#define VZ_SWITCHING_HPP
+
+#include <vector>
+
+namespace vZ
+{
+  // Integrator which switches between an explicit method and an implicit
+  // one, as the problem becomes stiff and stops being stiff
+  //
+  // Each integrator estimates h*|lambda| for its last step with stiffness(),
+  // where lambda is the dominant eigenvalue of df/dy.  The explicit method's
+  // estimate is Hairer's (see GenericAdaptiveIntegrator), and the
+  // problem is taken to be stiff after s_detections accepted steps with it
+  // beyond limit(), the edge of the explicit method's stability region, as
+  // in Hairer and Wanner's DOPRI5.  Only consecutive detections count, but
+  // a few stray steps inside the limit are forgiven.  Likewise, the implicit
+  // method hands back after s_detections consecutive steps which the
+  // explicit method could have taken stably.
+  //
+  // Explicit must be constructible from f, and Implicit from f or from f
+  // and the Jacobian function.  The default pair is DP45 and RODAS4.
+  template <typename Y,
+            typename F = typename GenericIntegrator<Y>::Function,
+            typename J = typename GenericIntegrator<Y>::JacobianFunction,
+            typename Explicit = GenericDP45Integrator<Y, F>,
+            typename Implicit = GenericRODAS4Integrator<Y, F, J> >
+  class GenericSwitchingIntegrator
+    : public GenericStaticIntegrator<
+        Y, GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>
+      >
+  {
+    typedef GenericStaticIntegrator<Y, GenericSwitchingIntegrator> Base;
+    friend class GenericStaticIntegrator<Y, GenericSwitchingIntegrator>;
+
+  public:
+    typedef typename Base::Scalar         Scalar;
+    typedef F                             Function;
+    typedef J                             JacobianFunction;
+    typedef GenericStepController<Scalar> StepController;
+
+    // How many consecutive detections it takes to switch
+    static const unsigned int s_detections = 15;
+
+    // With a finite-difference Jacobian for the implicit method
+    GenericSwitchingIntegrator(Function f);
+    GenericSwitchingIntegrator(Function f, JacobianFunction jacobian);
+    ~GenericSwitchingIntegrator() { }
+
+    // The tolerances and the controller are given to both methods
+    GenericSwitchingIntegrator& tol(Scalar tol)
+      { return atol(tol).rtol(tol); }
+    GenericSwitchingIntegrator& atol(Scalar tol);
+    GenericSwitchingIntegrator& rtol(Scalar tol);
+    GenericSwitchingIntegrator& atol(const std::vector<Scalar>& tol);
+    GenericSwitchingIntegrator& rtol(const std::vector<Scalar>& tol);
+    GenericSwitchingIntegrator& controller(const StepController& controller);
+
+    // The edge of the explicit method's stability region, in terms of
+    // h*|lambda|.  The default, 3.25, is DP45's.
+    GenericSwitchingIntegrator& limit(Scalar limit)
+      { m_limit = limit; return *this; }
+    Scalar limit() const { return m_limit; }
+
+    // The two methods, e.g. to read their own counters, which are reset
+    // whenever they're switched to
+    Explicit&       nonstiff()       { return m_nonstiff; }
+    const Explicit& nonstiff() const { return m_nonstiff; }
+    Implicit&       stiff()          { return m_stiff; }
+    const Implicit& stiff()    const { return m_stiff; }
+
+    // Whether the implicit method is in use
+    bool isStiff() const { return m_isStiff; }
+
+    // The number of switches to the implicit method and back
+    unsigned int stiffSwitches()    const { return m_stiffSwitches; }
+    unsigned int nonstiffSwitches() const { return m_nonstiffSwitches; }
+
+    // The number of steps taken, and the length of x covered, by each method
+    unsigned int stiffSteps()    const { return m_stiffSteps; }
+    unsigned int nonstiffSteps() const { return m_nonstiffSteps; }
+    Scalar stiffLength()    const { return m_stiffLength; }
+    Scalar nonstiffLength() const { return m_nonstiffLength; }
+
+    // Rejected steps of both methods
+    unsigned int rejections() const { return m_rejections; }
+
+    // Also forgets the counters, and goes back to the explicit method
+    void reset();
+
+  protected:
+    // Hand y(), x(), and h() to the method in use, which chooses h if it's
+    // 0
+    void start();
+    void step();
+
+  private:
+    // How many steps inside the limit reset the count of detections
+    static const unsigned int s_misses = 6;
+
+    // Hand y(), x(), and h() to integrator, and let it choose h if it's 0
+    template <typename Integrator>
+    void start(Integrator& integrator);
+
+    // Take a step with integrator, and collect its counts
+    template <typename Integrator>
+    Scalar step(Integrator& integrator);
+
+    // Switch to the other method, which continues from y(), x(), and h()
+    template <typename Integrator>
+    void switchTo(Integrator& integrator, bool isStiff);
+
+    Explicit m_nonstiff;
+    Implicit m_stiff;
+    bool m_isStiff;
+
+    Scalar m_limit;
+    // Consecutive detections of stiffness (or of its absence, when stiff),
+    // and the steps inside the limit since the last one
+    unsigned int m_detections, m_misses;
+
+    unsigned int m_stiffSwitches, m_nonstiffSwitches;
+    unsigned int m_stiffSteps, m_nonstiffSteps;
+    Scalar m_stiffLength, m_nonstiffLength;
+    unsigned int m_rejections;
+  };
+
+  // Type alias
+  typedef GenericSwitchingIntegrator<double> SwitchingIntegrator;
+
+  // Implementations
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::
+  GenericSwitchingIntegrator(Function f)
+    : m_nonstiff(f), m_stiff(f), m_isStiff(false),
+      m_limit(Scalar(13)/Scalar(4)), m_detections(0), m_misses(0),
+      m_stiffSwitches(0), m_nonstiffSwitches(0),
+      m_stiffSteps(0), m_nonstiffSteps(0),
+      m_stiffLength(0), m_nonstiffLength(0), m_rejections(0)
+  {
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::
+  GenericSwitchingIntegrator(Function f, JacobianFunction jacobian)
+    : m_nonstiff(f), m_stiff(f, jacobian), m_isStiff(false),
+      m_limit(Scalar(13)/Scalar(4)), m_detections(0), m_misses(0),
+      m_stiffSwitches(0), m_nonstiffSwitches(0),
+      m_stiffSteps(0), m_nonstiffSteps(0),
+      m_stiffLength(0), m_nonstiffLength(0), m_rejections(0)
+  {
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>&
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::atol(Scalar tol)
+  {
+    m_nonstiff.atol(tol);
+    m_stiff.atol(tol);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>&
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::rtol(Scalar tol)
+  {
+    m_nonstiff.rtol(tol);
+    m_stiff.rtol(tol);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>&
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::atol(
+    const std::vector<Scalar>& tol
+  )
+  {
+    m_nonstiff.atol(tol);
+    m_stiff.atol(tol);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>&
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::rtol(
+    const std::vector<Scalar>& tol
+  )
+  {
+    m_nonstiff.rtol(tol);
+    m_stiff.rtol(tol);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>&
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::controller(
+    const StepController& controller
+  )
+  {
+    m_nonstiff.controller(controller);
+    m_stiff.controller(controller);
+    return *this;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  void
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::reset()
+  {
+    Base::reset();
+    m_nonstiff.reset();
+    m_stiff.reset();
+    m_isStiff = false;
+    m_detections = 0;
+    m_misses = 0;
+    m_stiffSwitches = 0;
+    m_nonstiffSwitches = 0;
+    m_stiffSteps = 0;
+    m_nonstiffSteps = 0;
+    m_stiffLength = 0;
+    m_nonstiffLength = 0;
+    m_rejections = 0;
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  inline void
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::start()
+  {
+    if (m_isStiff) {
+      start(m_stiff);
+    } else {
+      start(m_nonstiff);
+    }
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  template <typename Integrator>
+  inline void
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::start(
+    Integrator& integrator
+  )
+  {
+    integrator.y(this->y()).x(this->x()).h(this->h());
+
+    if (this->h() == Scalar(0)) {
+      // Integrating up to x() lets the method choose h without stepping
+      unsigned int evaluations = integrator.evaluations();
+      integrator.integrate(this->x());
+      this->h(integrator.h());
+      this->evaluations(this->evaluations()
+                        + integrator.evaluations() - evaluations);
+    }
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  inline void
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::step()
+  {
+    Scalar x = this->x();
+
+    if (m_isStiff) {
+      Scalar stiffness = step(m_stiff);
+      ++m_stiffSteps;
+      m_stiffLength += this->x() - x;
+
+      // The explicit method would have been stable here too
+      if (stiffness <= m_limit) {
+        if (++m_detections == s_detections) {
+          switchTo(m_nonstiff, false);
+          ++m_nonstiffSwitches;
+        }
+      } else {
+        m_detections = 0;
+      }
+    } else {
+      Scalar stiffness = step(m_nonstiff);
+      ++m_nonstiffSteps;
+      m_nonstiffLength += this->x() - x;
+
+      if (stiffness > m_limit) {
+        m_misses = 0;
+        if (++m_detections == s_detections) {
+          switchTo(m_stiff, true);
+          ++m_stiffSwitches;
+        }
+      } else if (++m_misses == s_misses) {
+        m_detections = 0;
+      }
+    }
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  template <typename Integrator>
+  inline typename GenericSwitchingIntegrator<Y, F, J, Explicit,
+                                             Implicit>::Scalar
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::step(
+    Integrator& integrator
+  )
+  {
+    unsigned int evaluations = integrator.evaluations();
+    unsigned int rejections = integrator.rejections();
+
+    // h has already been shortened to stop at the end of the integration
+    integrator.h(this->h());
+    integrator.advance(this->x() + this->h());
+
+    this->y(integrator.y());
+    this->x(integrator.x());
+    this->h(integrator.h());
+    this->evaluations(this->evaluations()
+                      + integrator.evaluations() - evaluations);
+    m_rejections += integrator.rejections() - rejections;
+
+    return integrator.stiffness();
+  }
+
+  template <typename Y, typename F, typename J, typename Explicit,
+            typename Implicit>
+  template <typename Integrator>
+  void
+  GenericSwitchingIntegrator<Y, F, J, Explicit, Implicit>::switchTo(
+    Integrator& integrator, bool isStiff
+  )
+  {
+    // The new method may have cached stages from an older trajectory
+    integrator.reset();
+    integrator.y(this->y()).x(this->x()).h(this->h());
+    m_isStiff = isStiff;
+    m_detections = 0;
+    m_misses = 0;
+  }
+}
+
+#endif // VZ_SWITCHING_HPP
@@ -0,0 +1,205 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_SYMPLECTIC_HPP
+#define VZ_SYMPLECTIC_HPP
+
+#include <stdexcept>
+
+namespace vZ
+{
+  // A point (q, p) in phase space, the state of a separable Hamiltonian
+  // system.  Q and P are the types of the positions and momenta, e.g.
+  // EquationSystem<N, Vector<3> > for N bodies.
+  template <typename Q, typename P = Q>
+  class PhaseSpace
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    // The right-hand sides q' == velocity(x, p) and p' == force(x, q); see
+    // GenericSymplecticIntegrator below
+    typedef std::tr1::function<Q (Scalar, P)> VelocityFunction;
+    typedef std::tr1::function<P (Scalar, Q)> ForceFunction;
+
+    PhaseSpace() { }
+    PhaseSpace(const Q& q, const P& p) : m_q(q), m_p(p) { }
+
+    Q&       q()       { return m_q; }
+    const Q& q() const { return m_q; }
+
+    P&       p()       { return m_p; }
+    const P& p() const { return m_p; }
+
+  private:
+    Q m_q;
+    P m_p;
+  };
+
+  // Traits specialization
+  template <typename Q, typename P>
+  class Traits<PhaseSpace<Q, P> >
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+  private:
+    Traits();
+  };
+
+  // Base class for symplectic splitting methods
+  //
+  // For a separable Hamiltonian H(q, p) == T(p) + V(q), the system
+  //   q' == dT/dp == velocity(x, p)
+  //   p' == -dV/dq == force(x, q)
+  // splits into two parts which are solved exactly: a drift, which moves q
+  // with p held fixed, and a kick, which moves p with q held fixed.  An
+  // s-stage method takes the step
+  //   drift(a[0]*h), kick(b[0]*h), ..., kick(b[s - 1]*h), drift(a[s]*h)
+  // which is the exact flow of a nearby Hamiltonian, so the energy error
+  // stays bounded over any number of steps instead of drifting, provided
+  // h is fixed.  x advances with the drifts, so time-dependent forces are
+  // handled as in the extended phase space.
+  //
+  // The Tableau parameter must provide s_stages, s_order, s_a[s_stages + 1]
+  // and s_b[s_stages].  A step costs s_stages evaluations of the force,
+  // which are what evaluations() counts, and s_stages + 1 of the velocity,
+  // which is assumed to be cheap.
+  //
+  // h is never adapted, since that would destroy the conservation, so it
+  // must be set to a positive value before integrating, or
+  // std::invalid_argument is thrown.  A step shortened to reach the end of
+  // integrate() doesn't change h, and the grid integrate() overloads reach
+  // the output points by a separate short step from a copy of the state, so
+  // the trajectory itself stays on multiples of h.
+  template <typename Q, typename P, typename Tableau, typename V, typename A>
+  class GenericSymplecticIntegrator
+    : public GenericStaticIntegrator<
+        PhaseSpace<Q, P>, GenericSymplecticIntegrator<Q, P, Tableau, V, A>
+      >
+  {
+    typedef PhaseSpace<Q, P>                                        Y;
+    typedef GenericStaticIntegrator<Y, GenericSymplecticIntegrator> Base;
+    friend class GenericStaticIntegrator<Y, GenericSymplecticIntegrator>;
+
+  public:
+    typedef typename Base::Scalar Scalar;
+    typedef V                     VelocityFunction;
+    typedef A                     ForceFunction;
+
+    // The functions being integrated, e.g. to change their parameters
+    VelocityFunction&       velocity()       { return m_velocity; }
+    const VelocityFunction& velocity() const { return m_velocity; }
+
+    ForceFunction&       force()       { return m_force; }
+    const ForceFunction& force() const { return m_force; }
+
+    // The positions and momenta
+    const Q& q() const { return this->y().q(); }
+    const P& p() const { return this->y().p(); }
+
+  protected:
+    GenericSymplecticIntegrator(VelocityFunction velocity,
+                                ForceFunction force)
+      : m_velocity(velocity), m_force(force) { }
+    virtual ~GenericSymplecticIntegrator() { }
+
+    // Check that h was given, and remember it
+    void start();
+    void step();
+
+    template <typename Observer>
+    void observe(Scalar x, Scalar x_final, Y& y, Observer& observer);
+
+  private:
+    // Advance y from x by a step of h
+    void flow(Y& y, Scalar x, Scalar h);
+
+    VelocityFunction m_velocity;
+    ForceFunction m_force;
+    Scalar m_h;
+    Y m_y;
+  };
+
+  // Implementations
+
+  template <typename Q, typename P, typename Tableau, typename V, typename A>
+  inline void
+  GenericSymplecticIntegrator<Q, P, Tableau, V, A>::start()
+  {
+    if (!(this->h() > Scalar(0))) {
+      throw std::invalid_argument("vZ: symplectic integrators need h > 0");
+    }
+    m_h = this->h();
+  }
+
+  template <typename Q, typename P, typename Tableau, typename V, typename A>
+  inline void
+  GenericSymplecticIntegrator<Q, P, Tableau, V, A>::step()
+  {
+    m_y = this->y();
+    flow(m_y, this->x(), this->h());
+    this->y(m_y);
+    this->x(this->x() + this->h());
+    this->h(m_h);
+  }
+
+  template <typename Q, typename P, typename Tableau, typename V, typename A>
+  template <typename Observer>
+  inline void
+  GenericSymplecticIntegrator<Q, P, Tableau, V, A>::observe(
+    Scalar x, Scalar x_final, Y& y, Observer& observer)
+  {
+    if (x == x_final) {
+      Base::observe(x, x_final, y, observer);
+      return;
+    }
+
+    start();
+    while (this->x() + m_h <= x) {
+      this->advance(x);
+    }
+
+    if (this->x() == x) {
+      observer(x, this->y());
+    } else {
+      y = this->y();
+      flow(y, this->x(), x - this->x());
+      observer(x, static_cast<const Y&>(y));
+    }
+  }
+
+  template <typename Q, typename P, typename Tableau, typename V, typename A>
+  inline void
+  GenericSymplecticIntegrator<Q, P, Tableau, V, A>::flow(Y& y, Scalar x,
+                                                         Scalar h)
+  {
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      y.q() += (Tableau::s_a[i]*h)*m_velocity(x, y.p());
+      x += Tableau::s_a[i]*h;
+      y.p() += (Tableau::s_b[i]*h)*m_force(x, y.q());
+    }
+    y.q() += (Tableau::s_a[Tableau::s_stages]*h)*m_velocity(x, y.p());
+
+    this->evaluations(this->evaluations() + Tableau::s_stages);
+  }
+}
+
+#endif // VZ_SYMPLECTIC_HPP
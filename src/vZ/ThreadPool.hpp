@@ -0,0 +1,208 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_THREADPOOL_HPP
+#define VZ_THREADPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+#if __cplusplus >= 201103L
+#  include <algorithm>
+#  include <atomic>
+#  include <condition_variable>
+#  include <exception>
+#  include <functional>
+#  include <mutex>
+#  include <thread>
+#endif
+
+namespace vZ
+{
+  // A persistent pool of threads, for parallelism within a single
+  // trajectory
+  //
+  // Unlike ParallelEnsemble, which starts its threads once per call, the
+  // threads here wait between calls to run(), so they can be handed work as
+  // small as the rows of one extrapolation step.  Waking them still costs a
+  // few microseconds, so this only pays when each task evaluates f many
+  // times or f itself is expensive.
+  //
+  // Without C++11, run() calls the tasks one after another on the calling
+  // thread.
+  class ThreadPool
+  {
+  public:
+    // threads counts the calling thread; 0 means one per hardware thread
+    explicit ThreadPool(unsigned int threads = 0);
+    ~ThreadPool();
+
+    unsigned int threads() const { return m_threads; }
+
+    // Call task(i) for i in [0, n), on the calling thread and the pool, and
+    // wait for them all.  Lower i are started first.  The first exception
+    // thrown by any task is rethrown here.  Concurrent calls from different
+    // threads take turns.
+    template <typename Task>
+    void run(unsigned int n, Task& task);
+
+  private:
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator=(const ThreadPool&);
+
+    unsigned int m_threads;
+
+#if __cplusplus >= 201103L
+    // Take tasks until there are none left
+    void drain();
+    void work();
+
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex, m_runMutex;
+    std::condition_variable m_start, m_done;
+
+    std::function<void (unsigned int)> m_task;
+    unsigned int m_size;
+    std::atomic<unsigned int> m_next;
+    unsigned int m_busy;
+    unsigned long m_generation;
+    bool m_stop;
+    std::exception_ptr m_error;
+#endif
+  };
+
+  // Implementation
+
+#if __cplusplus >= 201103L
+  inline
+  ThreadPool::ThreadPool(unsigned int threads)
+    : m_threads(threads), m_size(0), m_next(0), m_busy(0), m_generation(0),
+      m_stop(false)
+  {
+    if (m_threads == 0) {
+      m_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    for (unsigned int t = 1; t < m_threads; ++t) {
+      m_workers.push_back(std::thread(&ThreadPool::work, this));
+    }
+  }
+
+  inline
+  ThreadPool::~ThreadPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stop = true;
+    }
+    m_start.notify_all();
+    for (std::size_t t = 0; t < m_workers.size(); ++t) {
+      m_workers[t].join();
+    }
+  }
+
+  template <typename Task>
+  void
+  ThreadPool::run(unsigned int n, Task& task)
+  {
+    std::lock_guard<std::mutex> runLock(m_runMutex);
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_task = [&task](unsigned int i) { task(i); };
+      m_size = n;
+      m_next = 0;
+      m_busy = m_workers.size();
+      m_error = std::exception_ptr();
+      ++m_generation;
+    }
+    m_start.notify_all();
+
+    drain();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_busy == 0; });
+    m_task = std::function<void (unsigned int)>();
+    if (m_error) {
+      std::rethrow_exception(m_error);
+    }
+  }
+
+  inline void
+  ThreadPool::drain()
+  {
+    unsigned int i;
+    while ((i = m_next++) < m_size) {
+      try {
+        m_task(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_error) {
+          m_error = std::current_exception();
+        }
+      }
+    }
+  }
+
+  inline void
+  ThreadPool::work()
+  {
+    unsigned long generation = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_start.wait(lock, [&] {
+          return m_stop || m_generation != generation;
+        });
+        if (m_stop) {
+          return;
+        }
+        generation = m_generation;
+      }
+
+      drain();
+
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (--m_busy == 0) {
+        m_done.notify_one();
+      }
+    }
+  }
+#else
+  inline
+  ThreadPool::ThreadPool(unsigned int)
+    : m_threads(1)
+  {
+  }
+
+  inline
+  ThreadPool::~ThreadPool()
+  {
+  }
+
+  template <typename Task>
+  void
+  ThreadPool::run(unsigned int n, Task& task)
+  {
+    for (unsigned int i = 0; i < n; ++i) {
+      task(i);
+    }
+  }
+#endif
+}
+
+#endif // VZ_THREADPOOL_HPP
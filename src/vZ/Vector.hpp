@@ -29,16 +29,21 @@
 namespace vZ
 {
   // An N-dimensional vector
+  //
+  // Arithmetic on Vectors is lazily evaluated; see Expression.hpp
   template <std::size_t N, typename T = double>
-  class Vector
+  class Vector : public Expression<Vector<N, T>, Vector<N, T> >
   {
   public:
     typedef typename Traits<T>::Scalar Scalar;
+    typedef T                          Value;
 
     Vector()              { }
     explicit Vector(T x)  { m_values[0] = x; }
     Vector(T x, T y)      { m_values[0] = x; m_values[1] = y; }
     Vector(T x, T y, T z) { m_values[0] = x; m_values[1] = y; m_values[2] = z; }
+    template <typename E>
+    Vector(const Expression<E, Vector>& e) { *this = e; }
     // Vector(const Vector& v);
     // ~Vector();
 
@@ -46,21 +51,32 @@ namespace vZ
 
     // Component access
 
+    std::size_t size() const { return N; }
+
     T&       operator[](std::size_t i)       { return m_values[i]; }
     const T& operator[](std::size_t i) const { return m_values[i]; }
 
+    T*       data()       { return m_values; }
+    const T* data() const { return m_values; }
+
     T x() const { return m_values[0]; }
     T y() const { return m_values[1]; }
     T z() const { return m_values[2]; }
 
     // Operators
-    inline Vector& operator+=(const Vector& rhs);
-    inline Vector& operator-=(const Vector& rhs);
+    template <typename E>
+    inline Vector& operator=(const Expression<E, Vector>& rhs);
+    template <typename E>
+    inline Vector& operator+=(const Expression<E, Vector>& rhs);
+    template <typename E>
+    inline Vector& operator-=(const Expression<E, Vector>& rhs);
+    inline Vector& operator+=(const ScaledExpression<Vector, Vector>& rhs);
+    inline Vector& operator-=(const ScaledExpression<Vector, Vector>& rhs);
     inline Vector& operator*=(Scalar rhs);
     inline Vector& operator/=(Scalar rhs);
 
   private:
-    T m_values[N];
+    VZ_SIMD_ALIGNAS(T, N) T m_values[N];
   };
 
   // Disallow 0-sized Vectors
@@ -78,120 +94,130 @@ namespace vZ
     Traits();
   };
 
-  // Unary operators
-
+  // LinearAlgebra specialization
   template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator+(const Vector<N, T>& rhs)
+  class LinearAlgebra<Vector<N, T> >
   {
-    return rhs;
-  }
+  public:
+    typedef typename Traits<T>::Scalar Scalar;
+    typedef Vector<N, T>               Y;
+    typedef Matrix<N, T>               Jacobian;
+    typedef LU<N, T>                   Factorization;
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator-(const Vector<N, T>& rhs)
+    static std::size_t size(const Y& y) { return y.size(); }
+    static T&       component(Y& y, std::size_t i)       { return y[i]; }
+    static const T& component(const Y& y, std::size_t i) { return y[i]; }
+
+    static void resize(Jacobian&, std::size_t) { }
+    static void zero(Jacobian& jac) { jac.fill(T(0)); }
+    static T& element(Jacobian& jac, std::size_t i, std::size_t j)
+      { return jac(i, j); }
+
+    static bool factor(Factorization& lu, Scalar c, const Jacobian& jac)
+      { return lu.factor(c, jac); }
+    static void solve(const Factorization& lu, Y& b) { lu.solve(b.data()); }
+
+  private:
+    LinearAlgebra();
+  };
+
+  // Products
+
+  template <typename L, typename R, std::size_t N, typename T>
+  inline typename Vector<N, T>::Scalar
+  dot(const Expression<L, Vector<N, T> >& lhs,
+      const Expression<R, Vector<N, T> >& rhs)
   {
-    Vector<N, T> res;
+    const L& l = lhs.derived();
+    const R& r = rhs.derived();
+    typename Vector<N, T>::Scalar res(0);
     for (std::size_t i = 0; i < N; ++i) {
-      res[i] = -rhs[i];
+      res += l[i]*r[i];
     }
     return res;
   }
 
   template <std::size_t N, typename T>
   inline typename Vector<N, T>::Scalar
-  norm(const Vector<N, T>& v)
+  dot(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
   {
-    using std::sqrt;
-    return sqrt(dot(v, v));
+    return simdDot(lhs.data(), rhs.data(), N);
   }
 
-  template <std::size_t N, typename T>
-  inline typename Vector<N, T>::Scalar
-  abs(const Vector<N, T>& v)
+  template <typename L, typename R, typename T>
+  inline Vector<3, T>
+  cross(const Expression<L, Vector<3, T> >& lhs,
+        const Expression<R, Vector<3, T> >& rhs)
   {
-    return norm(v);
+    Vector<3, T> l(lhs), r(rhs);
+    return Vector<3, T>(l.y()*r.z() - l.z()*r.y(),
+                        l.z()*r.x() - l.x()*r.z(),
+                        l.x()*r.y() - l.y()*r.x());
   }
 
-  // Binary operators
+  // Norms
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator+(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
+  template <typename E, std::size_t N, typename T>
+  inline typename Vector<N, T>::Scalar
+  norm(const Expression<E, Vector<N, T> >& v)
   {
-    Vector<N, T> res = lhs;
-    res += rhs;
-    return res;
+    using std::sqrt;
+    return sqrt(dot(v.derived(), v.derived()));
   }
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator-(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
+  template <typename E, std::size_t N, typename T>
+  inline typename Vector<N, T>::Scalar
+  abs(const Expression<E, Vector<N, T> >& v)
   {
-    Vector<N, T> res = lhs;
-    res -= rhs;
-    return res;
+    return norm(v);
   }
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator*(typename Vector<N, T>::Scalar lhs,
-            const Vector<N, T>& rhs)
+  // y = y0 + h*(a[0]*k[0] + ... + a[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  linearCombination(Vector<N, T>& y, const Vector<N, T>& y0, Scalar h,
+                    const Scalar* a, const Vector<N, T>* k)
   {
-    Vector<N, T> res = rhs;
-    res *= lhs;
-    return res;
+    y = LinearCombinationExpression<Vector<N, T>, S>(y0, h, a, k);
   }
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator*(const Vector<N, T>& lhs,
-            typename Vector<N, T>::Scalar rhs)
+  // e = h*(d[0]*k[0] + ... + d[S - 1]*k[S - 1]), in a single pass
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  weightedSum(Vector<N, T>& e, Scalar h, const Scalar* d,
+              const Vector<N, T>* k)
   {
-    Vector<N, T> res = lhs;
-    res *= rhs;
-    return res;
+    e = WeightedSumExpression<Vector<N, T>, S>(h, d, k);
   }
 
-  template <std::size_t N, typename T>
-  inline Vector<N, T>
-  operator/(const Vector<N, T>& lhs,
-            typename Vector<N, T>::Scalar rhs)
+  // y = y0 + h*(b[0]*k[0] + ...) and e = h*(d[0]*k[0] + ...), reading each
+  // stage once
+  template <unsigned int S, std::size_t N, typename T, typename Scalar>
+  inline void
+  combineWithError(Vector<N, T>& y, Vector<N, T>& e,
+                   const Vector<N, T>& y0, Scalar h, const Scalar* b,
+                   const Scalar* d, const Vector<N, T>* k)
   {
-    Vector<N, T> res = lhs;
-    res /= rhs;
-    return res;
-  }
-
-  template <std::size_t N, typename T>
-  inline typename Vector<N, T>::Scalar
-  dot(const Vector<N, T>& lhs, const Vector<N, T>& rhs)
-  {
-    typename Vector<N, T>::Scalar res(0);
-    for (std::size_t i = 0; i < N; ++i) {
-      res += lhs[i]*rhs[i];
+    typedef Vector<N, T> C;
+    LinearCombinationExpression<C, S> solution(y0, h, b, k);
+    WeightedSumExpression<C, S> error(h, d, k);
+    for (std::size_t i = 0; i < y0.size(); ++i) {
+      typename C::Value yi = solution[i], ei = error[i];
+      y[i] = yi;
+      e[i] = ei;
     }
-    return res;
-  }
-
-  template <typename T>
-  inline Vector<3, T>
-  cross(const Vector<3, T>& lhs, const Vector<3, T>& rhs)
-  {
-    return Vector<3, T>(lhs.y()*rhs.z() - lhs.z()*rhs.y(),
-                        lhs.z()*rhs.x() - lhs.x()*rhs.z(),
-                        lhs.x()*rhs.y() - lhs.y()*rhs.x());
   }
 
   // Stream output
 
-  template <std::size_t N, typename T>
+  template <typename E, std::size_t N, typename T>
   std::ostream&
-  operator<<(std::ostream& ostr, const Vector<N, T>& v)
+  operator<<(std::ostream& ostr, const Expression<E, Vector<N, T> >& v)
   {
-    ostr << "(" << v[0];
+    const E& e = v.derived();
+    ostr << "(" << e[0];
     for (std::size_t i = 1; i < N; ++i) {
-      ostr << ", " << v[i];
+      ostr << ", " << e[i];
     }
     return ostr << ")";
   }
@@ -199,35 +225,65 @@ namespace vZ
   // Implementation
 
   template <std::size_t N, typename T>
+  template <typename E>
   inline Vector<N, T>&
-  Vector<N, T>::operator+=(const Vector<N, T>& rhs)
+  Vector<N, T>::operator=(const Expression<E, Vector>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] += rhs.m_values[i];
+      m_values[i] = e[i];
     }
     return *this;
   }
 
   template <std::size_t N, typename T>
+  template <typename E>
   inline Vector<N, T>&
-  Vector<N, T>::operator-=(const Vector<N, T>& rhs)
+  Vector<N, T>::operator+=(const Expression<E, Vector>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] -= rhs.m_values[i];
+      m_values[i] += e[i];
     }
     return *this;
   }
 
   template <std::size_t N, typename T>
+  template <typename E>
   inline Vector<N, T>&
-  Vector<N, T>::operator*=(typename Vector<N, T>::Scalar rhs)
+  Vector<N, T>::operator-=(const Expression<E, Vector>& rhs)
   {
+    const E& e = rhs.derived();
     for (std::size_t i = 0; i < N; ++i) {
-      m_values[i] *= rhs;
+      m_values[i] -= e[i];
     }
     return *this;
   }
 
+  template <std::size_t N, typename T>
+  inline Vector<N, T>&
+  Vector<N, T>::operator+=(const ScaledExpression<Vector, Vector>& rhs)
+  {
+    simdAxpy(m_values, rhs.lhs(), rhs.rhs().data(), N);
+    return *this;
+  }
+
+  template <std::size_t N, typename T>
+  inline Vector<N, T>&
+  Vector<N, T>::operator-=(const ScaledExpression<Vector, Vector>& rhs)
+  {
+    simdAxpy(m_values, -rhs.lhs(), rhs.rhs().data(), N);
+    return *this;
+  }
+
+  template <std::size_t N, typename T>
+  inline Vector<N, T>&
+  Vector<N, T>::operator*=(typename Vector<N, T>::Scalar rhs)
+  {
+    simdScale(m_values, rhs, N);
+    return *this;
+  }
+
   template <std::size_t N, typename T>
   inline Vector<N, T>&
   Vector<N, T>::operator/=(typename Vector<N, T>::Scalar rhs)
@@ -0,0 +1,83 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_VERLET_HPP
+#define VZ_VERLET_HPP
+
+namespace vZ
+{
+  // The Stormer-Verlet (leapfrog) method
+  //
+  // Second-order, symmetric, and symplectic, with one force evaluation per
+  // step: drift(h/2), kick(h), drift(h/2).  The higher-order compositions
+  // in Yoshida.hpp are built from it.
+  template <typename Q>
+  class VerletTableau
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    static const unsigned int s_stages = 1;
+    static const unsigned int s_order  = 2;
+
+    static const Scalar s_a[s_stages + 1];
+    static const Scalar s_b[s_stages];
+
+  private:
+    VerletTableau();
+  };
+
+  template <typename Q, typename P = Q,
+            typename V = typename PhaseSpace<Q, P>::VelocityFunction,
+            typename A = typename PhaseSpace<Q, P>::ForceFunction>
+  class GenericVerletIntegrator
+    : public GenericSymplecticIntegrator<Q, P, VerletTableau<Q>, V, A>
+  {
+    typedef GenericSymplecticIntegrator<Q, P, VerletTableau<Q>, V, A> Base;
+
+  public:
+    typedef typename Base::VelocityFunction VelocityFunction;
+    typedef typename Base::ForceFunction    ForceFunction;
+
+    GenericVerletIntegrator(VelocityFunction velocity, ForceFunction force)
+      : Base(velocity, force) { }
+    ~GenericVerletIntegrator() { }
+  };
+
+  // Type alias
+  typedef GenericVerletIntegrator<double> VerletIntegrator;
+
+  // Implementation
+
+  template <typename Q>
+  const typename VerletTableau<Q>::Scalar
+  VerletTableau<Q>::s_a[2] = {
+    Scalar(1)/Scalar(2),
+    Scalar(1)/Scalar(2)
+  };
+
+  template <typename Q>
+  const typename VerletTableau<Q>::Scalar
+  VerletTableau<Q>::s_b[1] = {
+    Scalar(1)
+  };
+}
+
+#endif // VZ_VERLET_HPP
@@ -0,0 +1,291 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_VERNER65_HPP
+#define VZ_VERNER65_HPP
+
+namespace vZ
+{
+  // Verner's method
+  //
+  // Sixth-order with embedded fifth-order, from Verner's 1978 pair, as used
+  // in DVERK.  Its tableau is:
+  //
+  //   0     |
+  //   1/6   | 1/6
+  //   4/15  | 4/75         16/75
+  //   2/3   | 5/6         -8/3      5/2
+  //   5/6   | -165/64      55/6    -425/64        85/96
+  //   1     | 12/5        -8        4015/612     -11/36    88/255
+  //   1/15  | -8263/15000  124/75  -643/680      -81/250   2484/10625   0
+  //   1     | 3501/1720   -300/43   297275/52632 -319/2322 24068/84065  0     3850/26703
+  //   ------+---------------------------------------------------------------------------
+  //   b     | 3/40         0        875/2244      23/72    264/1955     0     125/11592  43/616
+  //   b*    | 13/160       0        2375/5984     5/16     12/85        3/44  0          0
+  template <typename Y>
+  class Verner65Tableau
+  {
+  public:
+    typedef typename Traits<Y>::Scalar Scalar;
+
+    static const unsigned int s_stages = 8;
+    static const unsigned int s_order  = 6;
+
+    static const Scalar s_a[s_stages][s_stages];
+    static const Scalar s_b[s_stages];
+    static const Scalar s_bStar[s_stages];
+    static const Scalar s_c[s_stages];
+
+  private:
+    Verner65Tableau();
+  };
+
+  // A fifth-order continuous extension, with one extra stage at the midpoint
+  // of the step.  The extra stage is itself a fifth-order approximation,
+  // which only exists at theta == 1/2 for this tableau.  The interpolant
+  // matches y and y' at both ends of the step, and its weights are
+  //   w[i] == theta*b[i] + theta*(1 - theta)*q[i](theta)
+  // for cubics q[i], with q[8] for the extra stage and q[9] for f1 (whose b
+  // is 0).  At theta == 1 they're exactly b.
+  template <typename Y>
+  class DenseOutput<Verner65Tableau<Y> >
+  {
+  public:
+    typedef typename Verner65Tableau<Y>::Scalar Scalar;
+
+    static const unsigned int s_order = 5;
+    static const unsigned int s_extraStages = 1;
+
+    static const Scalar s_a[1][10];
+    static const Scalar s_c[1];
+
+    static void weights(Scalar theta, Scalar w[], Scalar& wf);
+
+  private:
+    DenseOutput();
+
+    static const Scalar s_q[10][4];
+  };
+
+  template <typename Y, typename F = typename GenericIntegrator<Y>::Function>
+  class GenericVerner65Integrator
+    : public GenericAdaptiveIntegrator<Y, Verner65Tableau<Y>, F>
+  {
+    typedef GenericAdaptiveIntegrator<Y, Verner65Tableau<Y>, F> Base;
+
+  public:
+    typedef typename Base::Scalar   Scalar;
+    typedef typename Base::Function Function;
+
+    GenericVerner65Integrator(Function f) : Base(f) { }
+    ~GenericVerner65Integrator() { }
+  };
+
+  // Type alias
+  typedef GenericVerner65Integrator<double> Verner65Integrator;
+
+  // Implementation
+
+  template <typename Y>
+  const typename Verner65Tableau<Y>::Scalar
+  Verner65Tableau<Y>::s_a[8][8] = {
+    { Scalar(0) },
+    { Scalar(1)/Scalar(6) },
+    { Scalar(4)/Scalar(75), Scalar(16)/Scalar(75) },
+    {
+       Scalar(5)/Scalar(6),
+      -Scalar(8)/Scalar(3),
+       Scalar(5)/Scalar(2)
+    },
+    {
+      -Scalar(165)/Scalar(64),
+       Scalar(55)/Scalar(6),
+      -Scalar(425)/Scalar(64),
+       Scalar(85)/Scalar(96)
+    },
+    {
+       Scalar(12)/Scalar(5),
+      -Scalar(8),
+       Scalar(4015)/Scalar(612),
+      -Scalar(11)/Scalar(36),
+       Scalar(88)/Scalar(255)
+    },
+    {
+      -Scalar(8263)/Scalar(15000),
+       Scalar(124)/Scalar(75),
+      -Scalar(643)/Scalar(680),
+      -Scalar(81)/Scalar(250),
+       Scalar(2484)/Scalar(10625)
+    },
+    {
+       Scalar(3501)/Scalar(1720),
+      -Scalar(300)/Scalar(43),
+       Scalar(297275)/Scalar(52632),
+      -Scalar(319)/Scalar(2322),
+       Scalar(24068)/Scalar(84065),
+       Scalar(0),
+       Scalar(3850)/Scalar(26703)
+    }
+  };
+
+  template <typename Y>
+  const typename Verner65Tableau<Y>::Scalar
+  Verner65Tableau<Y>::s_b[8] = {
+    Scalar(3)/Scalar(40),
+    Scalar(0),
+    Scalar(875)/Scalar(2244),
+    Scalar(23)/Scalar(72),
+    Scalar(264)/Scalar(1955),
+    Scalar(0),
+    Scalar(125)/Scalar(11592),
+    Scalar(43)/Scalar(616)
+  };
+
+  template <typename Y>
+  const typename Verner65Tableau<Y>::Scalar
+  Verner65Tableau<Y>::s_bStar[8] = {
+    Scalar(13)/Scalar(160),
+    Scalar(0),
+    Scalar(2375)/Scalar(5984),
+    Scalar(5)/Scalar(16),
+    Scalar(12)/Scalar(85),
+    Scalar(3)/Scalar(44),
+    Scalar(0),
+    Scalar(0)
+  };
+
+  template <typename Y>
+  const typename Verner65Tableau<Y>::Scalar
+  Verner65Tableau<Y>::s_c[8] = {
+    Scalar(0),
+    Scalar(1)/Scalar(6),
+    Scalar(4)/Scalar(15),
+    Scalar(2)/Scalar(3),
+    Scalar(5)/Scalar(6),
+    Scalar(1),
+    Scalar(1)/Scalar(15),
+    Scalar(1)
+  };
+
+  template <typename Y>
+  const typename DenseOutput<Verner65Tableau<Y> >::Scalar
+  DenseOutput<Verner65Tableau<Y> >::s_a[1][10] = {
+    {
+       Scalar(189)/Scalar(2560),
+       Scalar(0),
+       Scalar(6125)/Scalar(16896),
+       Scalar(145)/Scalar(2304),
+      -Scalar(9)/Scalar(460),
+      -Scalar(21)/Scalar(704),
+       Scalar(125)/Scalar(6624),
+       Scalar(0),
+       Scalar(1)/Scalar(32)
+    }
+  };
+
+  template <typename Y>
+  const typename DenseOutput<Verner65Tableau<Y> >::Scalar
+  DenseOutput<Verner65Tableau<Y> >::s_c[1] = {
+    Scalar(1)/Scalar(2)
+  };
+
+  template <typename Y>
+  const typename DenseOutput<Verner65Tableau<Y> >::Scalar
+  DenseOutput<Verner65Tableau<Y> >::s_q[10][4] = {
+    {
+       Scalar(37)/Scalar(40),
+      -Scalar(107)/Scalar(32),
+       Scalar(727)/Scalar(160),
+      -Scalar(41)/Scalar(20)
+    },
+    { Scalar(0) },
+    {
+      -Scalar(875)/Scalar(2244),
+       Scalar(2875)/Scalar(352),
+      -Scalar(303625)/Scalar(17952),
+       Scalar(7125)/Scalar(748)
+    },
+    {
+      -Scalar(23)/Scalar(72),
+       Scalar(139)/Scalar(48),
+      -Scalar(1405)/Scalar(144),
+       Scalar(15)/Scalar(2)
+    },
+    {
+      -Scalar(264)/Scalar(1955),
+       Scalar(12)/Scalar(23),
+      -Scalar(7116)/Scalar(1955),
+       Scalar(288)/Scalar(85)
+    },
+    {
+       Scalar(0),
+      -Scalar(9)/Scalar(44),
+      -Scalar(63)/Scalar(44),
+       Scalar(18)/Scalar(11)
+    },
+    {
+      -Scalar(125)/Scalar(11592),
+       Scalar(625)/Scalar(1932),
+      -Scalar(125)/Scalar(414),
+       Scalar(0)
+    },
+    {
+      -Scalar(43)/Scalar(616),
+       Scalar(43)/Scalar(308),
+       Scalar(0),
+       Scalar(0)
+    },
+    {
+       Scalar(0),
+      -Scalar(8),
+       Scalar(24),
+      -Scalar(16)
+    },
+    {
+       Scalar(0),
+      -Scalar(1)/Scalar(2),
+       Scalar(7)/Scalar(2),
+      -Scalar(4)
+    }
+  };
+
+  template <typename Y>
+  inline void
+  DenseOutput<Verner65Tableau<Y> >::weights(Scalar theta, Scalar w[],
+                                            Scalar& wf)
+  {
+    typedef Verner65Tableau<Y> Tableau;
+
+    Scalar q[10];
+    for (unsigned int i = 0; i < 10; ++i) {
+      const Scalar* p = s_q[i];
+      q[i] = p[0] + theta*(p[1] + theta*(p[2] + theta*p[3]));
+    }
+
+    Scalar c = theta*(Scalar(1) - theta);
+    for (unsigned int i = 0; i < Tableau::s_stages; ++i) {
+      w[i] = theta*Tableau::s_b[i] + c*q[i];
+    }
+    w[8] = c*q[8];
+    wf   = c*q[9];
+  }
+}
+
+#endif // VZ_VERNER65_HPP
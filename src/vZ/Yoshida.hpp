@@ -0,0 +1,234 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Library.                                  *
+ *                                                                       *
+ * The vZ Library is free software; you can redistribute it and/or       *
+ * modify it under the terms of the GNU Lesser General Public License as *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Library is distributed in the hope that it will be useful, but *
+ * WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * Lesser General Public License for more details.                       *
+ *                                                                       *
+ * You should have received a copy of the GNU Lesser General Public      *
+ * License along with this program.  If not, see                         *
+ * <http://www.gnu.org/licenses/>.                                       *
+ *************************************************************************/
+
+#ifndef VZ_YOSHIDA_HPP
+#define VZ_YOSHIDA_HPP
+
+namespace vZ
+{
+  // Yoshida's symmetric compositions of the Stormer-Verlet method
+  //
+  // A step is a sequence of Verlet steps whose weights w[i] sum to 1; the
+  // weights are chosen so the error terms cancel up to the given order.
+  // Adjacent half-drifts merge, so s_b[i] == w[i] and
+  // s_a[i] == (w[i - 1] + w[i])/2.  The weights are those of Yoshida (1990).
+
+  // Yoshida's fourth-order method
+  //
+  // The "triple jump": three Stormer-Verlet steps of w1*h, w0*h, w1*h, with
+  // w1 == 1/(2 - 2^(1/3)) and w0 == 1 - 2*w1, so three force evaluations per
+  // step.  The middle step goes backwards.
+  template <typename Q>
+  class Yoshida4Tableau
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    static const unsigned int s_stages = 3;
+    static const unsigned int s_order  = 4;
+
+    static const Scalar s_a[s_stages + 1];
+    static const Scalar s_b[s_stages];
+
+  private:
+    Yoshida4Tableau();
+  };
+
+  template <typename Q, typename P = Q,
+            typename V = typename PhaseSpace<Q, P>::VelocityFunction,
+            typename A = typename PhaseSpace<Q, P>::ForceFunction>
+  class GenericYoshida4Integrator
+    : public GenericSymplecticIntegrator<Q, P, Yoshida4Tableau<Q>, V, A>
+  {
+    typedef GenericSymplecticIntegrator<Q, P, Yoshida4Tableau<Q>, V, A> Base;
+
+  public:
+    typedef typename Base::VelocityFunction VelocityFunction;
+    typedef typename Base::ForceFunction    ForceFunction;
+
+    GenericYoshida4Integrator(VelocityFunction velocity, ForceFunction force)
+      : Base(velocity, force) { }
+    ~GenericYoshida4Integrator() { }
+  };
+
+  // Yoshida's sixth-order method
+  //
+  // Seven Stormer-Verlet steps, with the weights of Yoshida's solution A.
+  template <typename Q>
+  class Yoshida6Tableau
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    static const unsigned int s_stages = 7;
+    static const unsigned int s_order  = 6;
+
+    static const Scalar s_a[s_stages + 1];
+    static const Scalar s_b[s_stages];
+
+  private:
+    Yoshida6Tableau();
+  };
+
+  template <typename Q, typename P = Q,
+            typename V = typename PhaseSpace<Q, P>::VelocityFunction,
+            typename A = typename PhaseSpace<Q, P>::ForceFunction>
+  class GenericYoshida6Integrator
+    : public GenericSymplecticIntegrator<Q, P, Yoshida6Tableau<Q>, V, A>
+  {
+    typedef GenericSymplecticIntegrator<Q, P, Yoshida6Tableau<Q>, V, A> Base;
+
+  public:
+    typedef typename Base::VelocityFunction VelocityFunction;
+    typedef typename Base::ForceFunction    ForceFunction;
+
+    GenericYoshida6Integrator(VelocityFunction velocity, ForceFunction force)
+      : Base(velocity, force) { }
+    ~GenericYoshida6Integrator() { }
+  };
+
+  // Yoshida's eighth-order method
+  //
+  // Fifteen Stormer-Verlet steps, with the weights of Yoshida's solution D.
+  template <typename Q>
+  class Yoshida8Tableau
+  {
+  public:
+    typedef typename Traits<Q>::Scalar Scalar;
+
+    static const unsigned int s_stages = 15;
+    static const unsigned int s_order  = 8;
+
+    static const Scalar s_a[s_stages + 1];
+    static const Scalar s_b[s_stages];
+
+  private:
+    Yoshida8Tableau();
+  };
+
+  template <typename Q, typename P = Q,
+            typename V = typename PhaseSpace<Q, P>::VelocityFunction,
+            typename A = typename PhaseSpace<Q, P>::ForceFunction>
+  class GenericYoshida8Integrator
+    : public GenericSymplecticIntegrator<Q, P, Yoshida8Tableau<Q>, V, A>
+  {
+    typedef GenericSymplecticIntegrator<Q, P, Yoshida8Tableau<Q>, V, A> Base;
+
+  public:
+    typedef typename Base::VelocityFunction VelocityFunction;
+    typedef typename Base::ForceFunction    ForceFunction;
+
+    GenericYoshida8Integrator(VelocityFunction velocity, ForceFunction force)
+      : Base(velocity, force) { }
+    ~GenericYoshida8Integrator() { }
+  };
+
+  // Type aliases
+  typedef GenericYoshida4Integrator<double> Yoshida4Integrator;
+  typedef GenericYoshida6Integrator<double> Yoshida6Integrator;
+  typedef GenericYoshida8Integrator<double> Yoshida8Integrator;
+
+  // Implementations
+
+  template <typename Q>
+  const typename Yoshida4Tableau<Q>::Scalar
+  Yoshida4Tableau<Q>::s_a[4] = {
+    Scalar(0.67560359597982881702),
+    Scalar(-0.17560359597982881702),
+    Scalar(-0.17560359597982881702),
+    Scalar(0.67560359597982881702)
+  };
+
+  template <typename Q>
+  const typename Yoshida4Tableau<Q>::Scalar
+  Yoshida4Tableau<Q>::s_b[3] = {
+    Scalar(1.3512071919596576340),
+    Scalar(-1.7024143839193152681),
+    Scalar(1.3512071919596576340)
+  };
+
+  template <typename Q>
+  const typename Yoshida6Tableau<Q>::Scalar
+  Yoshida6Tableau<Q>::s_a[8] = {
+    Scalar(0.39225680523878),
+    Scalar(0.5100434119184585),
+    Scalar(-0.4710533854097565),
+    Scalar(0.068753168252518),
+    Scalar(0.068753168252518),
+    Scalar(-0.4710533854097565),
+    Scalar(0.5100434119184585),
+    Scalar(0.39225680523878)
+  };
+
+  template <typename Q>
+  const typename Yoshida6Tableau<Q>::Scalar
+  Yoshida6Tableau<Q>::s_b[7] = {
+    Scalar(0.78451361047756),
+    Scalar(0.235573213359357),
+    Scalar(-1.17767998417887),
+    Scalar(1.315186320683906),
+    Scalar(-1.17767998417887),
+    Scalar(0.235573213359357),
+    Scalar(0.78451361047756)
+  };
+
+  template <typename Q>
+  const typename Yoshida8Tableau<Q>::Scalar
+  Yoshida8Tableau<Q>::s_a[16] = {
+    Scalar(0.45742212311487),
+    Scalar(0.5842687913979845),
+    Scalar(-0.5955794501471255),
+    Scalar(-0.8015464361143615),
+    Scalar(0.8899492511272585),
+    Scalar(-0.011235547676365),
+    Scalar(-0.9289051917917525),
+    Scalar(0.9056264600894915),
+    Scalar(0.9056264600894915),
+    Scalar(-0.9289051917917525),
+    Scalar(-0.011235547676365),
+    Scalar(0.8899492511272585),
+    Scalar(-0.8015464361143615),
+    Scalar(-0.5955794501471255),
+    Scalar(0.5842687913979845),
+    Scalar(0.45742212311487)
+  };
+
+  template <typename Q>
+  const typename Yoshida8Tableau<Q>::Scalar
+  Yoshida8Tableau<Q>::s_b[15] = {
+    Scalar(0.91484424622974),
+    Scalar(0.253693336566229),
+    Scalar(-1.44485223686048),
+    Scalar(-0.158240635368243),
+    Scalar(1.93813913762276),
+    Scalar(-1.96061023297549),
+    Scalar(0.102799849391985),
+    Scalar(1.708453070786998),
+    Scalar(0.102799849391985),
+    Scalar(-1.96061023297549),
+    Scalar(1.93813913762276),
+    Scalar(-0.158240635368243),
+    Scalar(-1.44485223686048),
+    Scalar(0.253693336566229),
+    Scalar(0.91484424622974)
+  };
+}
+
+#endif // VZ_YOSHIDA_HPP
@@ -0,0 +1,131 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<4> Y;
+typedef vZ::GenericAdamsIntegrator<Y> Integrator;
+
+// The Kepler problem with eccentricity 0.5, whose period is 2*pi
+Y
+kepler(double x, const Y& y)
+{
+  double r = std::sqrt(y[0]*y[0] + y[1]*y[1]);
+  double r3 = r*r*r;
+  Y dydx;
+  dydx[0] = y[2];
+  dydx[1] = y[3];
+  dydx[2] = -y[0]/r3;
+  dydx[3] = -y[1]/r3;
+  return dydx;
+}
+
+// y' = x*y (y == C*exp(x^2/2))
+double
+f(double x, double y)
+{
+  return x*y;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  const double pi = std::acos(-1.0);
+  const double e = 0.5;
+
+  Y y0;
+  y0[0] = 1.0 - e;
+  y0[1] = 0.0;
+  y0[2] = 0.0;
+  y0[3] = std::sqrt((1.0 + e)/(1.0 - e));
+
+  std::cout << std::setprecision(10);
+
+  // After 5 periods, the orbit should be back where it started
+  double tols[] = { 1e-6, 1e-9, 1e-12 };
+  double lastError = 1.0;
+  for (unsigned int i = 0; i < sizeof(tols)/sizeof(tols[0]); ++i) {
+    Integrator integrator(kepler);
+    integrator.tol(tols[i]).y(y0).x(0.0).h(0.0);
+    integrator.integrate(10.0*pi);
+
+    double error = 0.0;
+    for (unsigned int j = 0; j < 4; ++j) {
+      error = std::max(error, std::abs(integrator.y()[j] - y0[j]));
+    }
+    // Two evaluations per accepted step and one per rejected step, after
+    // the steps taken by the RK starter
+    unsigned int starting = integrator.evaluations()
+      - 2*(integrator.iterations() - Integrator::s_startSteps)
+      - integrator.rejections();
+    std::cout << "Kepler, tol = " << tols[i] << ":" << std::endl
+              << "  Error:       " << error << std::endl
+              << "  Iterations:  " << integrator.iterations() << std::endl
+              << "  Evaluations: " << integrator.evaluations() << std::endl
+              << "  Rejections:  " << integrator.rejections() << std::endl
+              << "  Order:       " << integrator.order() << std::endl
+              << "  Starting:    " << starting << std::endl;
+
+    if (error > 1e5*tols[i] || error > lastError || !std::isfinite(error)) {
+      std::cerr << "  Error is too large" << std::endl;
+      ret = false;
+    }
+    if (starting > 50) {
+      std::cerr << "  Too many evaluations" << std::endl;
+      ret = false;
+    }
+    lastError = error;
+  }
+
+  // Integrating to a grid of points in several calls continues the history
+  vZ::AdamsIntegrator integrator(f);
+  integrator.tol(1e-10).y(1.0).x(0.0).h(0.0);
+  for (int i = 1; i <= 20; ++i) {
+    integrator.integrate(0.1*i);
+  }
+  double error = std::abs(integrator.y() - std::exp(2.0))/std::exp(2.0);
+
+  std::cout << "exp(x^2/2):" << std::endl
+            << "  Error:      " << error << std::endl
+            << "  Iterations: " << integrator.iterations() << std::endl;
+
+  if (error > 1e-8) {
+    std::cerr << "  Error is too large" << std::endl;
+    ret = false;
+  }
+
+  // Moving x() back starts the history over
+  integrator.y(1.0).x(0.0);
+  integrator.integrate(2.0);
+  error = std::abs(integrator.y() - std::exp(2.0))/std::exp(2.0);
+
+  std::cout << "  Restarted:  " << error << std::endl;
+
+  if (error > 1e-8) {
+    std::cerr << "  Error is too large after restarting" << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
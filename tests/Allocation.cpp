@@ -0,0 +1,142 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Count every heap allocation made by the program
+static unsigned int allocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+  ++allocations;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void
+operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) throw()
+{
+  std::free(ptr);
+}
+
+typedef vZ::EquationSystem<2>        Y;
+typedef vZ::DynamicEquationSystem<> DY;
+
+// y'' = -y (y == C*cos(x) + D*sin(x))
+Y
+f(double x, Y y)
+{
+  Y r;
+  r[0] = y[1];
+  r[1] = -y[0];
+  return r;
+}
+
+// The same, for many copies of y in a runtime-sized system, written in place
+void
+g(double x, const DY& y, DY& dydx)
+{
+  for (std::size_t i = 0; i < y.size(); i += 2) {
+    dydx[i] = y[i + 1];
+    dydx[i + 1] = -y[i];
+  }
+}
+
+// Count the allocations made while integrating from x to x_final, after an
+// initial step has been taken.  If h isn't 0, the rest of the integration
+// starts with it.
+template <typename Integrator>
+unsigned int
+countAllocations(Integrator& integrator, double x_final, double h = 0.0)
+{
+  integrator.integrate(integrator.x() + integrator.h());
+  if (h != 0.0) {
+    integrator.h(h);
+  }
+
+  unsigned int before = allocations;
+  integrator.integrate(x_final);
+  return allocations - before;
+}
+
+int
+main()
+{
+  Y y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+
+  vZ::GenericRK4Integrator<Y> rk4(f);
+  rk4.y(y).x(0.0).h(0.01);
+
+  vZ::GenericDP45Integrator<Y> dp45(f);
+  dp45.tol(1e-6).y(y).x(0.0).h(0.06);
+
+  // Continue with a huge step after the first, to force some rejections
+  // while allocations are counted
+  vZ::GenericBS23Integrator<Y> bs23(f);
+  bs23.tol(1e-6).y(y).x(0.0).h(0.01);
+
+  DY dy(1000);
+  for (std::size_t i = 0; i < dy.size(); i += 2) {
+    dy[i] = 1.0;
+  }
+
+  vZ::GenericDP45Integrator<DY, void (*)(double, const DY&, DY&)> dynamic(g);
+  dynamic.tol(1e-6).y(dy).x(0.0).h(1.0);
+
+  unsigned int rk4Allocations     = countAllocations(rk4, 10.0);
+  unsigned int dp45Allocations    = countAllocations(dp45, 10.0);
+  unsigned int bs23Before         = bs23.rejections();
+  unsigned int bs23Allocations    = countAllocations(bs23, 10.0, 1.0);
+  unsigned int bs23Rejections     = bs23.rejections() - bs23Before;
+  unsigned int dynamicAllocations = countAllocations(dynamic, 10.0);
+
+  std::cout << "RK4 allocations:     " << rk4Allocations << std::endl
+            << "DP45 allocations:    " << dp45Allocations << std::endl
+            << "BS23 allocations:    " << bs23Allocations << std::endl
+            << "BS23 rejections:     " << bs23Rejections << std::endl
+            << "Dynamic allocations: " << dynamicAllocations << std::endl
+            << "Dynamic rejections:  " << dynamic.rejections() << std::endl;
+
+  if (rk4Allocations != 0 || dp45Allocations != 0 || bs23Allocations != 0
+      || dynamicAllocations != 0) {
+    std::cerr << "Integration allocated memory" << std::endl;
+    return EXIT_FAILURE;
+  } else if (bs23Rejections == 0) {
+    std::cerr << "BS23 rejected no steps" << std::endl;
+    return EXIT_FAILURE;
+  } else {
+    return EXIT_SUCCESS;
+  }
+}
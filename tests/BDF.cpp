@@ -0,0 +1,239 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// y' = -10^6*(y - cos(x)) - sin(x) (y == cos(x) + C*exp(-10^6*x))
+double
+f(double x, double y)
+{
+  return -1.0e6*(y - std::cos(x)) - std::sin(x);
+}
+
+// y' = x*y (y == C*exp(x^2/2)), which is smooth enough for order 5
+double
+smooth(double x, double y)
+{
+  return x*y;
+}
+
+// Robertson's chemical kinetics problem
+typedef vZ::EquationSystem<3> System;
+
+System
+robertson(double x, const System& y)
+{
+  System r;
+  r[0] = -0.04*y[0] + 1.0e4*y[1]*y[2];
+  r[1] =  0.04*y[0] - 1.0e4*y[1]*y[2] - 3.0e7*y[1]*y[1];
+  r[2] =  3.0e7*y[1]*y[1];
+  return r;
+}
+
+void
+robertsonJacobian(double x, const System& y, vZ::Matrix<3>& dfdy,
+                  System& dfdx)
+{
+  dfdy(0, 0) = -0.04;
+  dfdy(0, 1) =  1.0e4*y[2];
+  dfdy(0, 2) =  1.0e4*y[1];
+  dfdy(1, 0) =  0.04;
+  dfdy(1, 1) = -1.0e4*y[2] - 6.0e7*y[1];
+  dfdy(1, 2) = -1.0e4*y[1];
+  dfdy(2, 1) =  6.0e7*y[1];
+}
+
+// n copies of the scalar problem, with stiffness ranging from 1 to 10^4
+typedef vZ::DynamicEquationSystem<> Dynamic;
+
+Dynamic
+g(double x, const Dynamic& y)
+{
+  Dynamic r(y.size());
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    double lambda = std::pow(10.0, 4.0*i/(y.size() - 1));
+    r[i] = -lambda*(y[i] - std::cos(x)) - std::sin(x);
+  }
+  return r;
+}
+
+// Checks the error and the work, and that Jacobians and factorizations are
+// reused across steps
+template <typename Integrator>
+bool
+check(const char* name, const Integrator& integrator, double error,
+      double bound, unsigned int maxIterations)
+{
+  std::cout << std::setprecision(10)
+            << name << ":" << std::endl
+            << "  Error:          " << error << std::endl
+            << "  Iterations:     " << integrator.iterations() << std::endl
+            << "  Rejections:     " << integrator.rejections() << std::endl
+            << "  Jacobians:      " << integrator.jacobians() << std::endl
+            << "  Factorizations: " << integrator.factorizations()
+            << std::endl
+            << "  Order:          " << integrator.order() << std::endl;
+
+  if (error > bound || !std::isfinite(error)) {
+    std::cerr << "  Error is more than " << bound << std::endl;
+    return false;
+  }
+  if (integrator.iterations() > maxIterations) {
+    std::cerr << "  Too many iterations" << std::endl;
+    return false;
+  }
+  if (10*integrator.jacobians() > integrator.iterations()
+      || 3*integrator.factorizations() > integrator.iterations()) {
+    std::cerr << "  Too many Jacobians or factorizations" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool
+testScalar()
+{
+  vZ::BDFIntegrator integrator(f);
+  integrator.tol(1e-6)
+            .y(1.0)
+            .x(0.0)
+            .h(0.0);
+  integrator.integrate(10.0);
+
+  double error = std::abs(integrator.y() - std::cos(10.0));
+  return check("Scalar", integrator, error, 1e-5, 500);
+}
+
+// Reference solution at x == 40
+static const double reference[3] = {
+  0.7158270687193135, 9.185534764557526e-6, 0.2841637457161212
+};
+
+template <typename Integrator>
+bool
+testRobertson(Integrator& integrator, const char* name)
+{
+  System y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+  y[2] = 0.0;
+
+  std::vector<double> atol(3, 1e-8);
+  atol[1] = 1e-12;
+  integrator.rtol(1e-6)
+            .atol(atol)
+            .y(y)
+            .x(0.0)
+            .h(1e-6);
+  integrator.integrate(40.0);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < 3; ++i) {
+    error = std::max(error,
+                     std::abs(integrator.y()[i] - reference[i])/reference[i]);
+  }
+  return check(name, integrator, error, 5e-5, 400);
+}
+
+bool
+testDynamic()
+{
+  Dynamic y(20, 1.0);
+
+  vZ::GenericBDFIntegrator<Dynamic> integrator(g);
+  integrator.tol(1e-6)
+            .y(y)
+            .x(0.0)
+            .h(0.0);
+  integrator.integrate(10.0);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    error = std::max(error, std::abs(integrator.y()[i] - std::cos(10.0)));
+  }
+  return check("Dynamic", integrator, error, 1e-5, 500);
+}
+
+// The order rises to the maximum on a smooth problem, unless it's limited
+bool
+testOrder(unsigned int maxOrder)
+{
+  vZ::BDFIntegrator integrator(smooth);
+  integrator.maxOrder(maxOrder)
+            .tol(1e-10)
+            .y(1.0)
+            .x(0.0)
+            .h(0.0);
+  integrator.integrate(2.0);
+
+  double error = std::abs(integrator.y() - std::exp(2.0))/std::exp(2.0);
+
+  std::cout << "Smooth, maxOrder = " << maxOrder << ":" << std::endl
+            << "  Error:      " << error << std::endl
+            << "  Iterations: " << integrator.iterations() << std::endl
+            << "  Order:      " << integrator.order() << std::endl;
+
+  if (integrator.order() != maxOrder) {
+    std::cerr << "  Wrong order" << std::endl;
+    return false;
+  }
+  if (error > 1e-6 || !std::isfinite(error)) {
+    std::cerr << "  Error is too large" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  ret &= testScalar();
+
+  // The finite-difference Jacobian, and the exact one
+  typedef vZ::GenericBDFIntegrator<System> BDF;
+  BDF bdf(robertson);
+  BDF bdfJ(robertson, robertsonJacobian);
+  ret &= testRobertson(bdf, "Robertson");
+  ret &= testRobertson(bdfJ, "Robertson, Jacobian");
+
+  if (bdfJ.evaluations() >= bdf.evaluations()) {
+    std::cerr << "The Jacobian didn't save any evaluations" << std::endl;
+    ret = false;
+  }
+  // Each Newton iteration evaluates f once, besides the finite differences
+  if (bdfJ.newtonIterations() > bdfJ.evaluations()) {
+    std::cerr << "Wrong Newton iteration count" << std::endl;
+    ret = false;
+  }
+
+  ret &= testDynamic();
+
+  ret &= testOrder(vZ::BDFIntegrator::s_maxOrder);
+  ret &= testOrder(2);
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,141 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -100*y (y == cos(10*x)).  The relative error tolerance follows |y|,
+// which swings by a factor of 10 every period, so the elementary controller
+// keeps overshooting.
+Y
+f(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = -100.0*y[0];
+  return dydx;
+}
+
+typedef Y (*F)(double, const Y&);
+typedef vZ::GenericDP45Integrator<Y, F> DP45;
+
+void
+start(DP45& integrator)
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+  integrator.tol(1e-8).y(y0).x(0.0).h(0.01);
+}
+
+bool
+check(const char* name, const vZ::StepController& controller,
+      unsigned int& rejections)
+{
+  DP45 integrator(f);
+  start(integrator);
+  integrator.controller(controller);
+  integrator.integrate(20.0);
+
+  std::cout << name << ": " << integrator.iterations() << " steps, "
+            << integrator.rejections() << " rejections" << std::endl;
+  rejections = integrator.rejections();
+
+  double error = std::abs(integrator.y()[0] - std::cos(200.0));
+  if (!(error < 1e-6)) {
+    std::cerr << name << ": error " << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  // The default controller is the elementary one
+  {
+    DP45 plain(f), elementary(f);
+    start(plain);
+    start(elementary);
+    elementary.controller(vZ::StepController::elementary());
+    plain.integrate(20.0);
+    elementary.integrate(20.0);
+
+    if (plain.iterations() != elementary.iterations()
+        || plain.rejections() != elementary.rejections()
+        || plain.y()[0] != elementary.y()[0]) {
+      std::cerr << "The default controller isn't elementary()" << std::endl;
+      ret = false;
+    }
+  }
+
+  unsigned int elementary, pi, h211, h312;
+  ret = check("Elementary", vZ::StepController::elementary(), elementary)
+        && ret;
+  ret = check("PI", vZ::StepController::pi(), pi) && ret;
+  ret = check("H211b", vZ::StepController::h211(), h211) && ret;
+  ret = check("H312b", vZ::StepController::h312(), h312) && ret;
+
+  if (!(pi < elementary/10 && h211 < elementary/10 && h312 < elementary)) {
+    std::cerr << "The controllers didn't reduce the rejections" << std::endl;
+    ret = false;
+  }
+
+  // Limits
+  {
+    vZ::StepController controller = vZ::StepController::pi();
+    controller.limits(0.5, 2.0);
+    if (controller.accept(1.0, 1e-12, 5) != 2.0
+        || controller.accept(1.0, 1e12, 5) != 0.5
+        || controller.reject(1.0, 1e12, 5) != 0.5) {
+      std::cerr << "Step size limits not respected" << std::endl;
+      ret = false;
+    }
+  }
+
+  // reset() forgets the history
+  {
+    DP45 reused(f), fresh(f);
+    reused.controller(vZ::StepController::h312());
+    fresh.controller(vZ::StepController::h312());
+
+    start(reused);
+    reused.integrate(5.0);
+    reused.reset();
+    start(reused);
+    reused.integrate(20.0);
+
+    start(fresh);
+    fresh.integrate(20.0);
+
+    if (reused.iterations() != fresh.iterations()
+        || reused.rejections() != fresh.rejections()
+        || reused.y()[0] != fresh.y()[0]) {
+      std::cerr << "reset() didn't reset the controller" << std::endl;
+      ret = false;
+    }
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,134 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::Vector<3> V;
+typedef vZ::EquationSystem<2, V> Split;
+
+static const double pi = 3.14159265358979323846;
+static const double e  = 0.5;
+
+// y'' = y (y == cosh(x)), unsplit
+double
+f(double x, double y)
+{
+  return y;
+}
+
+// The Kepler problem r'' = -r/|r|^3, as a second-order system and split
+// by hand into r' = v, v' = -r/|r|^3
+V
+kepler(double, const V& r)
+{
+  double r2 = dot(r, r);
+  return -r/(r2*std::sqrt(r2));
+}
+
+Split
+split(double x, const Split& y)
+{
+  Split dydx;
+  dydx[0] = y[1];
+  dydx[1] = kepler(x, y[0]);
+  return dydx;
+}
+
+bool
+checkScalar()
+{
+  vZ::DPRKN6Integrator integrator(f);
+  integrator.tol(1e-6)
+            .y(vZ::PhaseSpace<double>(1.0, 0.0))
+            .x(0.0)
+            .h(0.0);
+
+  integrator.integrate(2.0);
+
+  double error = std::max(std::abs(integrator.q() - std::cosh(2.0)),
+                          std::abs(integrator.p() - std::sinh(2.0)))
+                 /std::cosh(2.0);
+
+  std::cout << std::setprecision(10)
+            << "y'' = y:    error " << error << ", "
+            << integrator.iterations() << " steps, "
+            << integrator.evaluations() << " evaluations" << std::endl;
+
+  if (error > 6.0e-7 || !std::isfinite(error)) {
+    std::cerr << "y'' = y:    error too large" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Five periods of a Kepler orbit, against DP45 on the split system at the
+// same tolerance
+bool
+checkKepler(double tol)
+{
+  V r0(1.0 - e, 0.0, 0.0), v0(0.0, std::sqrt((1.0 + e)/(1.0 - e)), 0.0);
+
+  vZ::GenericDPRKN6Integrator<V> integrator(kepler);
+  integrator.tol(tol).y(vZ::PhaseSpace<V>(r0, v0)).x(0.0).h(0.0);
+  integrator.integrate(10.0*pi);
+
+  Split y0;
+  y0[0] = r0;
+  y0[1] = v0;
+  vZ::GenericDP45Integrator<Split> dp45(split);
+  dp45.tol(tol).y(y0).x(0.0).h(0.0);
+  dp45.integrate(10.0*pi);
+
+  V dr = integrator.q() - r0, dv = integrator.p() - v0;
+  double error = std::sqrt(dot(dr, dr) + dot(dv, dv));
+  dr = dp45.y()[0] - r0;
+  dv = dp45.y()[1] - v0;
+  double dp45Error = std::sqrt(dot(dr, dr) + dot(dv, dv));
+
+  std::cout << std::setprecision(4)
+            << "Kepler:     tol " << tol << ", error " << error << " with "
+            << integrator.evaluations() << " evaluations, "
+            << integrator.rejections() << " rejections; DP45: "
+            << dp45Error << " with " << dp45.evaluations() << ", "
+            << dp45.rejections() << std::endl;
+
+  bool ok = true;
+  if (!(error <= 1e4*tol)) {
+    std::cerr << "Kepler:     error too large" << std::endl;
+    ok = false;
+  }
+  if (integrator.evaluations() >= dp45.evaluations()) {
+    std::cerr << "Kepler:     no fewer evaluations than DP45" << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+int
+main()
+{
+  bool ok = checkScalar();
+  ok = checkKepler(1e-6) && ok;
+  ok = checkKepler(1e-9) && ok;
+  ok = checkKepler(1e-12) && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,116 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -y (y == cos(x))
+Y
+f(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = -y[0];
+  return dydx;
+}
+
+typedef Y (*F)(double, const Y&);
+
+// Interpolating must not change the steps taken, and must agree with the
+// exact solution about as well as the steps themselves do
+template <typename Integrator>
+bool
+check(const char* name, double tol, double factor)
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+
+  Integrator dense(f), plain(f);
+  dense.tol(tol).y(y0).x(0.0).h(0.1);
+  plain.tol(tol).y(y0).x(0.0).h(0.1);
+
+  bool ret = true;
+  double stepError = 0.0, denseError = 0.0;
+  unsigned int outputs = 0;
+  while (dense.x() < 10.0) {
+    dense.advance(10.0);
+    plain.advance(10.0);
+
+    if (dense.x() != plain.x() || dense.h() != plain.h()
+        || dense.y()[0] != plain.y()[0] || dense.y()[1] != plain.y()[1]) {
+      std::cerr << name << ": steps differ at x = " << plain.x()
+                << std::endl;
+      return false;
+    }
+
+    Y y = dense.interpolate(dense.x());
+    if (y[0] != dense.y()[0] || y[1] != dense.y()[1]) {
+      std::cerr << name << ": interpolant differs at the end of the step"
+                << std::endl;
+      ret = false;
+    }
+    stepError = std::max(stepError, std::abs(dense.y()[0]
+                                             - std::cos(dense.x())));
+
+    double x0 = dense.xLast(), h = dense.x() - x0;
+    for (int i = 1; i < 4; ++i) {
+      double x = x0 + 0.25*i*h;
+      dense.interpolate(x, y);
+      denseError = std::max(denseError, std::abs(y[0] - std::cos(x)));
+      ++outputs;
+    }
+  }
+
+  std::cout << std::setprecision(4) << name << ":" << std::endl
+            << "  Steps:               " << dense.iterations() << std::endl
+            << "  Step error:          " << stepError << std::endl
+            << "  Interpolation error: " << denseError << " (at "
+            << outputs << " points)" << std::endl;
+
+  if (denseError > factor*stepError || !std::isfinite(denseError)) {
+    std::cerr << name << ": interpolation error too large" << std::endl;
+    ret = false;
+  }
+  return ret;
+}
+
+int
+main()
+{
+  // The Hermite fallback is only third-order, so it can't keep up with the
+  // steps of the fifth-order methods other than DP45.  The interpolants of
+  // Verner65 and DOP853 are one order below their steps.
+  bool ret = true;
+  ret = check<vZ::GenericHE12Integrator<Y, F> >("HE12", 1e-4, 2.0) && ret;
+  ret = check<vZ::GenericBS23Integrator<Y, F> >("BS23", 1e-6, 2.0) && ret;
+  ret = check<vZ::GenericRKF45Integrator<Y, F> >("RKF45", 1e-8, 10.0) && ret;
+  ret = check<vZ::GenericCK45Integrator<Y, F> >("CK45", 1e-8, 50.0) && ret;
+  ret = check<vZ::GenericDP45Integrator<Y, F> >("DP45", 1e-8, 1.5) && ret;
+  ret = check<vZ::GenericVerner65Integrator<Y, F> >("Verner65", 1e-10, 10.0)
+        && ret;
+  ret = check<vZ::GenericDOP853Integrator<Y, F> >("DOP853", 1e-12, 5.0)
+        && ret;
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,157 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+
+// Count every heap allocation made by the program
+static unsigned int allocations = 0;
+
+void*
+operator new(std::size_t size)
+{
+  ++allocations;
+  void* ptr = std::malloc(size ? size : 1);
+  if (!ptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+void
+operator delete(void* ptr) throw()
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t) throw()
+{
+  std::free(ptr);
+}
+
+typedef vZ::DynamicEquationSystem<> Y;
+
+// n/2 copies of y'' = -y (y == C*cos(x) + D*sin(x))
+//
+// Split as:
+//   y' = v
+//   v' = -y
+Y
+f(double x, const Y& y)
+{
+  Y r(y.size());
+  for (std::size_t i = 0; i < y.size(); i += 2) {
+    r[i] = y[i + 1];
+    r[i + 1] = -y[i];
+  }
+  return r;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  // Only known at runtime
+  std::size_t n = 2*(std::rand()%8 + 500);
+
+  Y y(n);
+  for (std::size_t i = 0; i < n; i += 2) {
+    y[i] = 1.0;
+  }
+
+  if (reinterpret_cast<std::size_t>(y.data())%64 != 0) {
+    std::cerr << "Storage is not aligned to a cache line" << std::endl;
+    ret = false;
+  }
+
+  vZ::GenericDP45Integrator<Y, Y (*)(double, const Y&)> dp45(f);
+  dp45.tol(1e-8).y(y).x(0.0).h(0.06);
+  dp45.integrate(10.0);
+
+  double expected = std::cos(10.0);
+  double error = 0.0;
+  for (std::size_t i = 0; i < n; i += 2) {
+    error = std::max(error, std::abs(dp45.y()[i] - expected));
+  }
+
+  std::cout << std::setprecision(10)
+            << "Size:       " << dp45.y().size() << std::endl
+            << "Numerical:  " << dp45.y()[0] << std::endl
+            << "Expected:   " << expected << std::endl
+            << "Iterations: " << dp45.iterations() << std::endl
+            << "Rejections: " << dp45.rejections() << std::endl;
+
+  if (dp45.y().size() != n || error > 1e-7 || !std::isfinite(error)) {
+    std::cerr << "Error:      " << error << std::endl;
+    ret = false;
+  }
+
+  // Once the stage buffers are sized, the only allocations are the results
+  // of f, one per stage
+  vZ::GenericRK4Integrator<Y, Y (*)(double, const Y&)> rk4(f);
+  rk4.y(y).x(0.0).h(0.01);
+  rk4.integrate(0.01);
+
+  unsigned int before = allocations;
+  unsigned int iterations = rk4.iterations();
+  rk4.integrate(1.0);
+  unsigned int rk4Allocations = allocations - before;
+  unsigned int evaluations = 4*(rk4.iterations() - iterations);
+
+  std::cout << "RK4 allocations: " << rk4Allocations << std::endl
+            << "f evaluations:   " << evaluations << std::endl;
+
+  if (rk4Allocations != evaluations) {
+    std::cerr << "Integration allocated memory outside of f" << std::endl;
+    ret = false;
+  }
+
+  // Expressions, and the copy semantics
+  Y z = 2.0*y - y/2.0;
+  z += 0.5*y;
+  z -= y;
+  if (z.size() != n || z[0] != 1.0 || z[1] != 0.0 || abs(z - y) != 0.0) {
+    std::cerr << "Expression error" << std::endl;
+    ret = false;
+  }
+
+  before = allocations;
+  z = y;
+  z = 3.0*y + z;
+  if (allocations != before || z[0] != 4.0) {
+    std::cerr << "Assignment reallocated" << std::endl;
+    ret = false;
+  }
+
+  Y empty;
+  empty = z;
+  if (empty.size() != n || empty[0] != 4.0) {
+    std::cerr << "Resizing assignment failed" << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
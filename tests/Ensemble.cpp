@@ -0,0 +1,159 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -k*y (y == C*cos(sqrt(k)*x) + D*sin(sqrt(k)*x)), with a different k
+// for every trajectory
+class Oscillators
+{
+public:
+  explicit Oscillators(const std::vector<double>& k) : m_k(k), m_i(0) { }
+
+  // One trajectory
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    dydx[0] = y[1];
+    dydx[1] = -m_k[m_i]*y[0];
+    return dydx;
+  }
+
+  // A block of trajectories, starting with i
+  template <typename X, typename Block>
+  void
+  operator()(const X& x, const Block& y, Block& dydx, std::size_t i) const
+  {
+    dydx[0] = y[1];
+    dydx[1] = -X::load(&m_k[i])*y[0];
+  }
+
+  Oscillators& trajectory(std::size_t i) { m_i = i; return *this; }
+
+private:
+  std::vector<double> m_k;
+  std::size_t m_i;
+};
+
+// Every lane must take exactly the same steps as integrating its trajectory
+// alone.  That only holds if the compiler doesn't contract operations into
+// FMAs differently in each case, so this test is built with
+// -ffp-contract=off.
+
+template <typename Tableau, typename Single, std::size_t W>
+bool
+check(const char* name, std::size_t size,
+      const vZ::StepController& controller = vZ::StepController(),
+      double h = 0.5)
+{
+  typedef vZ::GenericEnsembleIntegrator<Y, Tableau, Oscillators, W> Ensemble;
+
+  // Parameters for the padding lanes too
+  std::vector<double> k((size + W - 1)/W*W, 1.0);
+  for (std::size_t i = 0; i < size; ++i) {
+    k[i] = 1.0 + 0.25*i;
+  }
+  Oscillators f(k);
+
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+
+  Ensemble ensemble(f, size);
+  ensemble.controller(controller).tol(1e-8).xAll(0.0).hAll(h);
+  for (std::size_t i = 0; i < size; ++i) {
+    ensemble.y(i, y0);
+  }
+  ensemble.integrate(5.0);
+  ensemble.integrate(10.0);
+
+  bool ret = true;
+  unsigned int iterations = 0, rejections = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    f.trajectory(i);
+    Single single(f);
+    single.controller(controller).tol(1e-8).y(y0).x(0.0).h(h);
+    single.integrate(5.0);
+    single.integrate(10.0);
+
+    Y y = ensemble.y(i);
+    bool steps = ensemble.iterations(i) == single.iterations()
+                 && ensemble.rejections(i) == single.rejections();
+    if (y[0] != single.y()[0] || y[1] != single.y()[1]
+        || ensemble.x(i) != single.x() || !steps
+        || ensemble.h(i) != single.h()) {
+      std::cerr << name << ": trajectory " << i << " differs:" << std::endl
+                << "  Ensemble: " << y[0] << " after "
+                << ensemble.iterations(i) << " steps" << std::endl
+                << "  Single:   " << single.y()[0] << " after "
+                << single.iterations() << " steps" << std::endl;
+      ret = false;
+    }
+
+    iterations += single.iterations();
+    rejections += single.rejections();
+  }
+
+  double expected = std::cos(std::sqrt(k[size - 1])*10.0);
+  std::cout << std::setprecision(10) << name << ":" << std::endl
+            << "  Numerical:  " << ensemble.y(size - 1)[0] << std::endl
+            << "  Expected:   " << expected << std::endl
+            << "  Iterations: " << iterations << std::endl
+            << "  Rejections: " << rejections << std::endl;
+
+  return ret;
+}
+
+int
+main()
+{
+  typedef vZ::DP45Tableau<Y>   DP45;
+  typedef vZ::RKF45Tableau<Y>  RKF45;
+  typedef vZ::DOP853Tableau<Y> DOP853;
+  typedef vZ::GenericDP45Integrator<Y, Oscillators>   DP45Integrator;
+  typedef vZ::GenericRKF45Integrator<Y, Oscillators>  RKF45Integrator;
+  typedef vZ::GenericDOP853Integrator<Y, Oscillators> DOP853Integrator;
+
+  static const std::size_t W = 2*vZ::SIMDLanes<double>::s_lanes;
+
+  bool ret = true;
+  ret = check<DP45, DP45Integrator, W>("DP45", 37) && ret;
+  ret = check<RKF45, RKF45Integrator, W>("RKF45 (not FSAL)", 37) && ret;
+  ret = check<DP45, DP45Integrator, 3>("DP45, 3 lanes", 10) && ret;
+  ret = check<DP45, DP45Integrator, 1>("DP45, 1 lane", 4) && ret;
+  ret = check<DP45, DP45Integrator, W>("DP45, H312b", 37,
+                                       vZ::StepController::h312()) && ret;
+  ret = check<DP45, DP45Integrator, W>("DP45, automatic h", 37,
+                                       vZ::StepController(), 0.0) && ret;
+  ret = check<RKF45, RKF45Integrator, W>("RKF45, automatic h", 37,
+                                         vZ::StepController(), 0.0) && ret;
+  ret = check<DOP853, DOP853Integrator, W>("DOP853 (combined error)", 37)
+        && ret;
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
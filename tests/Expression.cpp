@@ -0,0 +1,99 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<3> Y;
+
+bool
+check(const char* what, double actual, double expected)
+{
+  if (std::abs(actual - expected) > 1.0e-12) {
+    std::cerr << what << ": " << actual << " != " << expected << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ok = true;
+
+  Y a, b, c;
+  for (std::size_t i = 0; i < 3; ++i) {
+    a[i] = i + 1.0;
+    b[i] = 2.0*i;
+    c[i] = 1.0 - i;
+  }
+
+  // Compound expression
+  Y y = a + 2.0*(b - c)/4.0 - (-a);
+  for (std::size_t i = 0; i < 3; ++i) {
+    double expected = a[i] + 2.0*(b[i] - c[i])/4.0 + a[i];
+    ok = check("Compound", y[i], expected) && ok;
+  }
+
+  // Aliasing the result with an operand
+  y = a;
+  y = b + y*3.0;
+  y -= 0.5*a;
+  for (std::size_t i = 0; i < 3; ++i) {
+    ok = check("Aliased", y[i], b[i] + 3.0*a[i] - 0.5*a[i]) && ok;
+  }
+
+  // Max-norm of an expression
+  ok = check("Max-norm", abs(a - b), 1.0) && ok;
+
+  // RK-style linear combination
+  static const double coeffs[3] = { 0.5, 0.0, -0.25 };
+  Y k[3] = { a, b, c };
+  vZ::linearCombination<3>(y, a, 0.1, coeffs, k);
+  for (std::size_t i = 0; i < 3; ++i) {
+    double expected = a[i] + 0.1*0.5*a[i] - 0.1*0.25*c[i];
+    ok = check("Combination", y[i], expected) && ok;
+  }
+
+  // Vector products of expressions
+  vZ::Vector<3> u(1.0, 2.0, 3.0), v(-1.0, 0.5, 2.0);
+  vZ::Vector<3> w = cross(u + v, u - v);
+  vZ::Vector<3> s = u + v, d = u - v;
+  ok = check("Cross x", w.x(), s.y()*d.z() - s.z()*d.y()) && ok;
+  ok = check("Cross y", w.y(), s.z()*d.x() - s.x()*d.z()) && ok;
+  ok = check("Cross z", w.z(), s.x()*d.y() - s.y()*d.x()) && ok;
+  ok = check("Dot", dot(2.0*u, v), 2.0*(-1.0 + 1.0 + 6.0)) && ok;
+  ok = check("Norm", norm(u - u/2.0), std::sqrt(14.0)/2.0) && ok;
+
+  // Nested systems
+  vZ::EquationSystem<2, vZ::Vector<3> > p, q;
+  p[0] = u;
+  p[1] = v;
+  q = p + 2.0*p;
+  ok = check("Nested", q[1].z(), 6.0) && ok;
+
+  std::cout << std::setprecision(10)
+            << "u + v:      " << u + v << std::endl
+            << "u x v:      " << cross(u, v) << std::endl;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -k*y (y == C*cos(sqrt(k)*x) + D*sin(sqrt(k)*x))
+class Oscillator
+{
+public:
+  explicit Oscillator(double k) : m_k(k) { }
+
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y r;
+    r[0] = y[1];
+    r[1] = -m_k*y[0];
+    return r;
+  }
+
+private:
+  double m_k;
+};
+
+// y' = x*y (y == C*exp(x^2/2))
+double
+f(double x, double y)
+{
+  return x*y;
+}
+
+int
+main()
+{
+  Y y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+
+  // Inlined functor
+  vZ::GenericDP45Integrator<Y, Oscillator> functor(Oscillator(4.0));
+  functor.tol(1e-6)
+         .y(y)
+         .x(0.0)
+         .h(0.06);
+  functor.integrate(2.0);
+
+  // Type-erased functor, which should take exactly the same steps
+  vZ::GenericDP45Integrator<Y> erased(Oscillator(4.0));
+  erased.tol(1e-6)
+        .y(y)
+        .x(0.0)
+        .h(0.06);
+  erased.integrate(2.0);
+
+  // Function pointer
+  vZ::GenericRK4Integrator<double, double (*)(double, double)> pointer(f);
+  pointer.y(1.0)
+         .x(0.0)
+         .h(0.01);
+  pointer.integrate(2.0);
+
+#if __cplusplus >= 201103L
+  // Lambda
+  auto g = [](double x, double y) { return x*y; };
+  vZ::GenericRK4Integrator<double, decltype(g)> lambda(g);
+  lambda.y(1.0)
+        .x(0.0)
+        .h(0.01);
+  lambda.integrate(2.0);
+
+  if (lambda.y() != pointer.y()) {
+    std::cerr << "Lambda:     " << lambda.y() << std::endl;
+    return EXIT_FAILURE;
+  }
+#endif
+
+  double functorActual   = functor.y()[0];
+  double functorExpected = std::cos(4.0);
+  double pointerActual   = pointer.y();
+  double pointerExpected = std::exp(2.0);
+
+  std::cout << std::setprecision(10)
+            << "Functor:    " << functorActual << std::endl
+            << "Expected:   " << functorExpected << std::endl
+            << "Iterations: " << functor.iterations() << std::endl
+            << "Type-erased iterations: " << erased.iterations() << std::endl
+            << "Pointer:    " << pointerActual << std::endl
+            << "Expected:   " << pointerExpected << std::endl;
+
+  double functorError
+    = std::abs(functorExpected - functorActual)/std::abs(functorExpected);
+  double pointerError
+    = std::abs(pointerExpected - pointerActual)/std::abs(pointerExpected);
+  if (functorError > 3.0e-6 || !std::isfinite(functorError)
+      || pointerError > 1.0e-8 || !std::isfinite(pointerError)
+      || erased.iterations() != functor.iterations()
+      || erased.y()[0] != functor.y()[0]) {
+    std::cerr << "Functor error: " << 100.0*functorError << "%" << std::endl
+              << "Pointer error: " << 100.0*pointerError << "%" << std::endl;
+    return EXIT_FAILURE;
+  } else {
+    std::cout << "Functor error: " << 100.0*functorError << "%" << std::endl
+              << "Pointer error: " << 100.0*pointerError << "%" << std::endl;
+    return EXIT_SUCCESS;
+  }
+}
@@ -0,0 +1,200 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+typedef vZ::EquationSystem<4> Y;
+
+static const double pi = 3.14159265358979323846;
+static const double e  = 0.5;
+
+// y' = x*y (y == C*exp(x^2/2))
+double
+f(double x, double y)
+{
+  return x*y;
+}
+
+// r'' = -r/|r|^3
+Y
+kepler(double, const Y& y)
+{
+  double r2 = y[0]*y[0] + y[1]*y[1];
+  double r3 = r2*std::sqrt(r2);
+
+  Y dydx;
+  dydx[0] = y[2];
+  dydx[1] = y[3];
+  dydx[2] = -y[0]/r3;
+  dydx[3] = -y[1]/r3;
+  return dydx;
+}
+
+Y
+periapsis()
+{
+  Y y;
+  y[0] = 1.0 - e;
+  y[1] = 0.0;
+  y[2] = 0.0;
+  y[3] = std::sqrt((1.0 + e)/(1.0 - e));
+  return y;
+}
+
+double
+distance(const Y& u, const Y& v)
+{
+  double max = 0.0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    max = std::max(max, std::abs(u[i] - v[i]));
+  }
+  return max;
+}
+
+bool
+checkScalar()
+{
+  vZ::GBSIntegrator integrator(f);
+  integrator.tol(1e-10).y(1.0).x(0.0).h(0.0);
+  integrator.integrate(2.0);
+
+  double error = std::abs(integrator.y() - std::exp(2.0))/std::exp(2.0);
+  std::cout << std::setprecision(4)
+            << "exp(x^2/2): error " << error << ", "
+            << integrator.iterations() << " steps, "
+            << integrator.evaluations() << " evaluations" << std::endl;
+
+  if (!(error <= 1e-9)) {
+    std::cerr << "exp(x^2/2): error too large" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Five periods of a Kepler orbit, which should beat DP45's evaluations at
+// tight tolerances, and give the same solution on any thread pool
+bool
+checkKepler(double tol)
+{
+  vZ::GenericGBSIntegrator<Y> integrator(kepler);
+  integrator.tol(tol).y(periapsis()).x(0.0).h(0.0);
+  integrator.integrate(10.0*pi);
+  double error = distance(integrator.y(), periapsis());
+
+  vZ::GenericDP45Integrator<Y> dp45(kepler);
+  dp45.tol(tol).y(periapsis()).x(0.0).h(0.0);
+  dp45.integrate(10.0*pi);
+
+  std::cout << "Kepler:     tol " << tol << ", error " << error << ", "
+            << integrator.iterations() << " steps, "
+            << integrator.evaluations() << " evaluations, "
+            << integrator.rejections() << " rejections, order "
+            << integrator.order() << "; DP45: " << dp45.evaluations()
+            << std::endl;
+
+  bool ok = true;
+  if (!(error <= 1e4*tol)) {
+    std::cerr << "Kepler:     error too large" << std::endl;
+    ok = false;
+  }
+  if (tol <= 1e-10 && integrator.evaluations() >= dp45.evaluations()) {
+    std::cerr << "Kepler:     no fewer evaluations than DP45" << std::endl;
+    ok = false;
+  }
+
+  static const unsigned int threads[] = { 1, 2, 4 };
+  for (std::size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); ++t) {
+    vZ::ThreadPool pool(threads[t]);
+    vZ::GenericGBSIntegrator<Y> parallel(kepler);
+    parallel.tol(tol).threadPool(&pool).y(periapsis()).x(0.0).h(0.0);
+    parallel.integrate(10.0*pi);
+
+    if (distance(parallel.y(), integrator.y()) != 0.0
+        || parallel.iterations() != integrator.iterations()
+        || parallel.rejections() != integrator.rejections()) {
+      std::cerr << "Kepler:     differs on " << threads[t] << " threads"
+                << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// The order never exceeds 2*rows()
+bool
+checkRows()
+{
+  vZ::GenericGBSIntegrator<Y> integrator(kepler);
+  integrator.rows(3).tol(1e-12).y(periapsis()).x(0.0).h(0.0);
+  integrator.integrate(2.0*pi);
+  double error = distance(integrator.y(), periapsis());
+
+  std::cout << "Three rows: error " << error << ", "
+            << integrator.iterations() << " steps, order "
+            << integrator.order() << std::endl;
+
+  if (integrator.order() > 6 || !(error <= 1e-8)) {
+    std::cerr << "Three rows: wrong order or error too large" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Exceptions thrown by tasks reach the caller of run()
+class Thrower
+{
+public:
+  void operator()(unsigned int i)
+  {
+    if (i == 2) {
+      throw std::runtime_error("task 2");
+    }
+  }
+};
+
+bool
+checkExceptions()
+{
+  vZ::ThreadPool pool(3);
+  Thrower thrower;
+  try {
+    pool.run(5, thrower);
+  } catch (const std::runtime_error&) {
+    return true;
+  }
+
+  std::cerr << "ThreadPool: exception lost" << std::endl;
+  return false;
+}
+
+int
+main()
+{
+  bool ok = checkScalar();
+  ok = checkKepler(1e-6) && ok;
+  ok = checkKepler(1e-10) && ok;
+  ok = checkKepler(1e-13) && ok;
+  ok = checkRows() && ok;
+  ok = checkExceptions() && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
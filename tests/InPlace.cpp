@@ -0,0 +1,146 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<2>        Y;
+typedef vZ::DynamicEquationSystem<> DY;
+
+// y'' = -y (y == C*cos(x) + D*sin(x)), in both forms
+Y
+f(double x, Y y)
+{
+  Y r;
+  r[0] = y[1];
+  r[1] = -y[0];
+  return r;
+}
+
+void
+inPlace(double x, const Y& y, Y& dydx)
+{
+  dydx[0] = y[1];
+  dydx[1] = -y[0];
+}
+
+// n/2 copies, for a runtime-sized system
+void
+dynamicInPlace(double x, const DY& y, DY& dydx)
+{
+  for (std::size_t i = 0; i < y.size(); i += 2) {
+    dydx[i] = y[i + 1];
+    dydx[i + 1] = -y[i];
+  }
+}
+
+#if __cplusplus >= 201103L
+// A functor with the in-place form, which is detected automatically
+class InPlaceFunctor
+{
+public:
+  void
+  operator()(double x, const Y& y, Y& dydx) const
+  {
+    inPlace(x, y, dydx);
+  }
+};
+#endif
+
+// The in-place forms do the same arithmetic, so must agree exactly.  FMA
+// contraction could round the two forms differently, so this test is built
+// with -ffp-contract=off.
+template <typename Integrator>
+bool
+check(const char* name, Integrator& integrator, const Y& expected)
+{
+  Y y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+  integrator.tol(1e-8).y(y).x(0.0).h(0.06);
+  integrator.integrate(10.0);
+
+  std::cout << std::setprecision(10)
+            << name << ": " << integrator.y()[0] << std::endl;
+
+  if (integrator.y()[0] != expected[0] || integrator.y()[1] != expected[1]) {
+    std::cerr << name << " differs from the returning form" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  Y y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+
+  vZ::GenericDP45Integrator<Y, Y (*)(double, Y)> returning(f);
+  returning.tol(1e-8).y(y).x(0.0).h(0.06);
+  returning.integrate(10.0);
+  std::cout << std::setprecision(10)
+            << "Returning: " << returning.y()[0] << std::endl
+            << "Expected:  " << std::cos(10.0) << std::endl;
+
+  vZ::GenericDP45Integrator<Y, void (*)(double, const Y&, Y&)>
+    pointer(inPlace);
+  ret = check("Pointer", pointer, returning.y()) && ret;
+
+  vZ::GenericDP45Integrator<Y, vZ::GenericIntegrator<Y>::InPlaceFunction>
+    erased(inPlace);
+  ret = check("Type-erased", erased, returning.y()) && ret;
+
+#if __cplusplus >= 201103L
+  vZ::GenericDP45Integrator<Y, InPlaceFunctor> functor((InPlaceFunctor()));
+  ret = check("Functor", functor, returning.y()) && ret;
+#endif
+
+  // The stage buffers of runtime-sized systems are sized to match y before
+  // being written to
+  std::size_t n = 1000;
+  DY dy(n);
+  for (std::size_t i = 0; i < n; i += 2) {
+    dy[i] = 1.0;
+  }
+
+  vZ::GenericRK4Integrator<DY, void (*)(double, const DY&, DY&)>
+    dynamic(dynamicInPlace);
+  dynamic.y(dy).x(0.0).h(0.01);
+  dynamic.integrate(10.0);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < n; i += 2) {
+    error = std::max(error, std::abs(dynamic.y()[i] - std::cos(10.0)));
+  }
+  std::cout << "Dynamic:   " << dynamic.y()[0] << std::endl;
+  if (error > 1e-8 || !std::isfinite(error)) {
+    std::cerr << "Dynamic error: " << error << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,151 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -y (y == cos(x))
+Y
+f(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = -y[0];
+  return dydx;
+}
+
+typedef Y (*F)(double, const Y&);
+
+Y
+initial()
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+  return y0;
+}
+
+// Without h, the integrator must choose one which isn't rejected, and count
+// the evaluation of f that cost
+template <typename Integrator>
+bool
+check(const char* name, double tol)
+{
+  Integrator automatic(f), guessed(f);
+  automatic.tol(tol).y(initial()).x(0.0);
+  guessed.tol(tol).y(initial()).x(0.0).h(1.0);
+  automatic.integrate(10.0);
+  guessed.integrate(10.0);
+
+  std::cout << name << ":" << std::endl
+            << "  Automatic h: " << automatic.iterations() << " steps, "
+            << automatic.rejections() << " rejections, "
+            << automatic.evaluations() << " evaluations" << std::endl
+            << "  h = 1.0:     " << guessed.iterations() << " steps, "
+            << guessed.rejections() << " rejections, "
+            << guessed.evaluations() << " evaluations" << std::endl;
+
+  bool ret = true;
+  if (automatic.initialStepEvaluations() != 1
+      || guessed.initialStepEvaluations() != 0) {
+    std::cerr << name << ": wrong initialStepEvaluations()" << std::endl;
+    ret = false;
+  }
+  if (automatic.rejections() >= guessed.rejections()) {
+    std::cerr << name << ": the automatic h was rejected" << std::endl;
+    ret = false;
+  }
+  if (!(std::abs(automatic.y()[0] - std::cos(10.0)) < 100.0*tol)) {
+    std::cerr << name << ": y(10) == " << automatic.y()[0] << std::endl;
+    ret = false;
+  }
+  return ret;
+}
+
+// Fixed-step integrators can't choose h, so they must refuse to start
+// without one instead of taking steps of 0 forever
+template <typename Integrator>
+bool
+checkFixed(const char* name)
+{
+  bool ret = true;
+
+  Integrator integrator(f);
+  integrator.y(initial()).x(0.0);
+  try {
+    integrator.integrate(1.0);
+    std::cerr << name << ": integrate() accepted h == 0" << std::endl;
+    ret = false;
+  } catch (const std::invalid_argument&) { }
+  try {
+    integrator.advance(1.0);
+    std::cerr << name << ": advance() accepted h == 0" << std::endl;
+    ret = false;
+  } catch (const std::invalid_argument&) { }
+
+  vZ::ParallelEnsemble<Integrator> ensemble(integrator);
+  ensemble.x(0.0).threads(2);
+  try {
+    ensemble.integrate(std::vector<Y>(4, initial()), 1.0);
+    std::cerr << name << ": ParallelEnsemble accepted h == 0" << std::endl;
+    ret = false;
+  } catch (const std::invalid_argument&) { }
+
+  return ret;
+}
+
+int
+main()
+{
+  bool ret = true;
+  ret = check<vZ::GenericHE12Integrator<Y, F> >("HE12", 1e-4) && ret;
+  ret = check<vZ::GenericBS23Integrator<Y, F> >("BS23", 1e-6) && ret;
+  ret = check<vZ::GenericRKF45Integrator<Y, F> >("RKF45", 1e-8) && ret;
+  ret = check<vZ::GenericDP45Integrator<Y, F> >("DP45", 1e-8) && ret;
+  ret = checkFixed<vZ::GenericEulerIntegrator<Y, F> >("Euler") && ret;
+  ret = checkFixed<vZ::GenericRK4Integrator<Y, F> >("RK4") && ret;
+
+  // Every evaluation of f is counted: DP45 is FSAL, and the first k1 is
+  // shared with the step size estimate
+  vZ::GenericDP45Integrator<Y, F> dp45(f);
+  dp45.tol(1e-8).y(initial()).x(0.0);
+  dp45.integrate(10.0);
+  if (dp45.evaluations()
+      != 2 + 6*(dp45.iterations() + dp45.rejections())) {
+    std::cerr << "DP45: " << dp45.evaluations() << " evaluations counted"
+              << std::endl;
+    ret = false;
+  }
+
+  vZ::GenericRK4Integrator<Y, F> rk4(f);
+  rk4.y(initial()).x(0.0).h(0.1);
+  rk4.integrate(10.0);
+  if (rk4.evaluations() != 4*rk4.iterations()) {
+    std::cerr << "RK4: " << rk4.evaluations() << " evaluations counted"
+              << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
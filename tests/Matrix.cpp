@@ -0,0 +1,93 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+
+// A matrix which needs pivoting: its leading element is 0
+static const double a[4][4] = {
+  {  0.0,  2.0, -1.0,  4.0 },
+  {  3.0,  1.0,  0.0, -2.0 },
+  { -1.0,  5.0,  2.0,  1.0 },
+  {  2.0, -3.0,  7.0,  0.5 }
+};
+static const double x[4] = { 1.0, -2.0, 0.5, 3.0 };
+
+template <typename Matrix, typename LU>
+bool
+test(const char* name, Matrix& m, LU& lu, double c)
+{
+  // b = (c*I - a)*x, or a*x if c is 0
+  double b[4];
+  for (std::size_t i = 0; i < 4; ++i) {
+    b[i] = c*x[i];
+    for (std::size_t j = 0; j < 4; ++j) {
+      m(i, j) = a[i][j];
+      b[i] += (c == 0.0 ? 1.0 : -1.0)*a[i][j]*x[j];
+    }
+  }
+
+  bool factored = c == 0.0 ? lu.factor(m) : lu.factor(c, m);
+  if (!factored) {
+    std::cerr << name << ": singular" << std::endl;
+    return false;
+  }
+  lu.solve(b);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < 4; ++i) {
+    error = std::max(error, std::abs(b[i] - x[i]));
+  }
+  std::cout << name << ": error " << error << std::endl;
+  if (error > 1e-14) {
+    std::cerr << name << ": wrong solution" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  vZ::Matrix<4> m;
+  vZ::LU<4> lu;
+  ret &= test("Fixed", m, lu, 0.0);
+  ret &= test("Fixed, shifted", m, lu, 3.0);
+
+  vZ::Matrix<0> dm(4);
+  vZ::LU<0> dlu;
+  ret &= test("Dynamic", dm, dlu, 0.0);
+  ret &= test("Dynamic, shifted", dm, dlu, 3.0);
+
+  // Singular matrices are reported
+  vZ::Matrix<3> s;
+  s.fill(1.0);
+  vZ::LU<3> slu;
+  if (slu.factor(s)) {
+    std::cerr << "Singular matrix was factored" << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
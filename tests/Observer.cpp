@@ -0,0 +1,178 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -y (y == cos(x))
+Y
+f(double x, const Y& y)
+{
+  Y dydx;
+  dydx[0] = y[1];
+  dydx[1] = -y[0];
+  return dydx;
+}
+
+typedef Y (*F)(double, const Y&);
+
+// Records every output point
+class Recorder
+{
+public:
+  Recorder(std::vector<double>& x, std::vector<double>& y)
+    : m_x(x), m_y(y) { }
+
+  void operator()(double x, const Y& y)
+  {
+    m_x.push_back(x);
+    m_y.push_back(y[0]);
+  }
+
+private:
+  std::vector<double>& m_x;
+  std::vector<double>& m_y;
+};
+
+Y
+initial()
+{
+  Y y0;
+  y0[0] = 1.0;
+  y0[1] = 0.0;
+  return y0;
+}
+
+// Checks that the recorded points are x[i], and close to cos(x[i])
+bool
+check(const char* name, const std::vector<double>& grid,
+      const std::vector<double>& x, const std::vector<double>& y, double tol)
+{
+  if (x != grid) {
+    std::cerr << name << ": observed " << x.size() << " points, expected "
+              << grid.size() << std::endl;
+    return false;
+  }
+
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (!(std::abs(y[i] - std::cos(x[i])) <= tol)) {
+      std::cerr << name << ": y(" << x[i] << ") = " << y[i]
+                << ", expected " << std::cos(x[i]) << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  std::vector<double> grid;
+  for (int i = 1; i <= 1000; ++i) {
+    grid.push_back(0.01*i);
+  }
+
+  // The adaptive integrator must take exactly the steps it would without
+  // the output grid
+  {
+    vZ::GenericDP45Integrator<Y, F> observed(f), plain(f);
+    observed.tol(1e-8).y(initial()).x(0.0).h(0.1);
+    plain.tol(1e-8).y(initial()).x(0.0).h(0.1);
+
+    std::vector<double> x, y;
+    unsigned int saved
+      = observed.integrate(grid.begin(), grid.end(), Recorder(x, y));
+    plain.integrate(10.0);
+
+    ret = check("DP45", grid, x, y, 1e-6) && ret;
+    if (observed.iterations() != plain.iterations()
+        || observed.y()[0] != plain.y()[0]
+        || observed.y()[1] != plain.y()[1]) {
+      std::cerr << "DP45: output grid changed the steps taken" << std::endl;
+      ret = false;
+    }
+    if (saved != grid.size() - plain.iterations()) {
+      std::cerr << "DP45: " << saved << " steps saved, expected "
+                << grid.size() - plain.iterations() << std::endl;
+      ret = false;
+    }
+  }
+
+  // The stride overload, whose last point isn't a multiple of the stride
+  {
+    vZ::GenericDP45Integrator<Y, F> integrator(f);
+    integrator.tol(1e-8).y(initial()).x(0.0).h(0.1);
+
+    std::vector<double> x, y, expected;
+    for (int i = 1; 0.3*i < 10.0; ++i) {
+      expected.push_back(0.3*i);
+    }
+    expected.push_back(10.0);
+
+    integrator.integrate(10.0, 0.3, Recorder(x, y));
+    ret = check("DP45 stride", expected, x, y, 1e-6) && ret;
+    if (integrator.x() != 10.0) {
+      std::cerr << "DP45 stride: stopped at " << integrator.x() << std::endl;
+      ret = false;
+    }
+  }
+
+  // A stride which never reaches x_final is refused
+  {
+    vZ::GenericDP45Integrator<Y, F> integrator(f);
+    integrator.tol(1e-8).y(initial()).x(0.0).h(0.1);
+
+    std::vector<double> x, y;
+    try {
+      integrator.integrate(10.0, 0.0, Recorder(x, y));
+      std::cerr << "DP45 stride: accepted a stride of 0" << std::endl;
+      ret = false;
+    } catch (const std::invalid_argument&) { }
+    if (!x.empty() || integrator.x() != 0.0) {
+      std::cerr << "DP45 stride: integrated with a stride of 0" << std::endl;
+      ret = false;
+    }
+  }
+
+  // Fixed-step methods shorten a step to hit each point, but must go back to
+  // their own step size afterwards
+  {
+    vZ::GenericRK4Integrator<Y, F> integrator(f);
+    integrator.y(initial()).x(0.0).h(0.004);
+
+    std::vector<double> x, y;
+    integrator.integrate(grid.begin(), grid.end(), Recorder(x, y));
+
+    ret = check("RK4", grid, x, y, 1e-8) && ret;
+    if (integrator.h() != 0.004) {
+      std::cerr << "RK4: h = " << integrator.h() << " after the grid"
+                << std::endl;
+      ret = false;
+    }
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
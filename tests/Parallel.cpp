@@ -0,0 +1,131 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+typedef vZ::EquationSystem<2> Y;
+
+// y'' = -k*y (y == C*cos(sqrt(k)*x) + D*sin(sqrt(k)*x))
+class Oscillator
+{
+public:
+  explicit Oscillator(double k = 1.0) : m_k(k) { }
+
+  Y
+  operator()(double x, const Y& y) const
+  {
+    Y dydx;
+    dydx[0] = y[1];
+    dydx[1] = -m_k*y[0];
+    return dydx;
+  }
+
+private:
+  double m_k;
+};
+
+static const std::size_t size = 50;
+
+// Every trajectory must match integrating it alone, exactly, for any number
+// of threads
+template <typename Integrator>
+bool
+check(const char* name, const Integrator& prototype)
+{
+  // Stiffer oscillators take many more steps, so the work is unbalanced
+  std::vector<Y> y0(size);
+  std::vector<double> k(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    y0[i][0] = 1.0;
+    y0[i][1] = 0.1*i;
+    k[i] = 1.0 + (i%7 == 0 ? 100.0*i : 0.5*i);
+  }
+
+  std::vector<Y> expected(size), same(size);
+  std::vector<unsigned int> iterations(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    Integrator single(prototype);
+    single.f() = Oscillator(k[i]);
+    single.y(y0[i]).x(0.0).h(0.01);
+    single.integrate(5.0);
+    expected[i] = single.y();
+    iterations[i] = single.iterations();
+
+    Integrator unchanged(prototype);
+    unchanged.y(y0[i]).x(0.0).h(0.01);
+    unchanged.integrate(5.0);
+    same[i] = unchanged.y();
+  }
+
+  bool ret = true;
+  static const unsigned int threads[] = { 1, 2, 3, 8 };
+  for (std::size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); ++t) {
+    vZ::ParallelEnsemble<Integrator> ensemble(prototype);
+    ensemble.x(0.0).h(0.01).threads(threads[t]);
+
+    ensemble.integrate(y0, k, 5.0);
+    for (std::size_t i = 0; i < size; ++i) {
+      if (ensemble.y(i)[0] != expected[i][0]
+          || ensemble.y(i)[1] != expected[i][1]
+          || ensemble.iterations(i) != iterations[i]) {
+        std::cerr << name << ", " << threads[t] << " threads: trajectory "
+                  << i << " differs" << std::endl;
+        ret = false;
+      }
+    }
+
+    // Without parameters, the prototype's function is used throughout
+    ensemble.integrate(y0, 5.0);
+    for (std::size_t i = 0; i < size; ++i) {
+      if (ensemble.y(i)[0] != same[i][0] || ensemble.y(i)[1] != same[i][1]) {
+        std::cerr << name << ", " << threads[t] << " threads: trajectory "
+                  << i << " differs without parameters" << std::endl;
+        ret = false;
+      }
+    }
+  }
+
+  std::size_t i = size - 2;
+  double w = std::sqrt(k[i]);
+  double exact = std::cos(w*5.0) + y0[i][1]/w*std::sin(w*5.0);
+  std::cout << std::setprecision(10) << name << ":" << std::endl
+            << "  Numerical: " << expected[i][0] << std::endl
+            << "  Expected:  " << exact << std::endl;
+
+  return ret;
+}
+
+int
+main()
+{
+  vZ::GenericDP45Integrator<Y, Oscillator> dp45((Oscillator()));
+  dp45.tol(1e-8);
+  vZ::GenericRK4Integrator<Y, Oscillator> rk4((Oscillator()));
+
+  bool ret = true;
+  ret = check("DP45", dp45) && ret;
+  ret = check("RK4", rk4) && ret;
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,179 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<2> Y;
+typedef vZ::GenericRK4Integrator<Y>  Coarse;
+typedef vZ::GenericDP45Integrator<Y> Fine;
+
+// The Brusselator, which settles onto a limit cycle
+Y
+brusselator(double, const Y& y)
+{
+  Y dydx;
+  dydx[0] = 1.0 + y[0]*y[0]*y[1] - 4.0*y[0];
+  dydx[1] = 3.0*y[0] - y[0]*y[0]*y[1];
+  return dydx;
+}
+
+Y
+initial()
+{
+  Y y;
+  y[0] = 1.5;
+  y[1] = 3.0;
+  return y;
+}
+
+double
+distance(const Y& u, const Y& v)
+{
+  return std::max(std::abs(u[0] - v[0]), std::abs(u[1] - v[1]));
+}
+
+Coarse
+coarse()
+{
+  Coarse integrator(brusselator);
+  integrator.h(0.25);
+  return integrator;
+}
+
+Fine
+fine()
+{
+  Fine integrator(brusselator);
+  integrator.tol(1e-10);
+  return integrator;
+}
+
+// Integrate each slice with Fine alone, one after another
+Y
+sequential(unsigned int slices, double x_final)
+{
+  Fine integrator = fine();
+  integrator.y(initial());
+  for (unsigned int n = 0; n < slices; ++n) {
+    integrator.reset();
+    integrator.x(x_final*n/slices).h(0.0);
+    integrator.integrate(n + 1 == slices ? x_final : x_final*(n + 1)/slices);
+  }
+  return integrator.y();
+}
+
+// Given as many iterations as slices, Parareal reproduces the sequential
+// fine solution exactly
+bool
+checkExact()
+{
+  vZ::Parareal<Coarse, Fine> parareal(coarse(), fine());
+  parareal.slices(8).tol(0.0).x(0.0);
+  parareal.integrate(initial(), 20.0);
+  double error = distance(parareal.y(), sequential(8, 20.0));
+
+  std::cout << "Exact:       " << parareal.iterations() << " iterations, "
+            << "difference " << error << std::endl;
+
+  if (parareal.iterations() != 8 || error != 0.0) {
+    std::cerr << "Exact:       differs from the sequential solution"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// With a tolerance, it converges in a few iterations, to within about that
+// tolerance, and the same on any thread pool
+bool
+checkConvergence()
+{
+  Y reference = sequential(32, 20.0);
+
+  vZ::Parareal<Coarse, Fine> parareal(coarse(), fine());
+  parareal.slices(32).tol(1e-8).x(0.0);
+  parareal.integrate(initial(), 20.0);
+  double error = distance(parareal.y(), reference);
+
+  std::cout << std::setprecision(4)
+            << "Convergence: " << parareal.iterations() << " iterations, "
+            << "error " << error << ", changes";
+  for (unsigned int k = 0; k < parareal.iterations(); ++k) {
+    std::cout << " " << parareal.change(k);
+  }
+  std::cout << std::endl
+            << "             " << parareal.evaluations() << " evaluations, "
+            << parareal.criticalEvaluations() << " on the critical path"
+            << std::endl;
+
+  bool ok = true;
+  if (parareal.iterations() > 8 || !(error <= 1e-6)) {
+    std::cerr << "Convergence: too slow or error too large" << std::endl;
+    ok = false;
+  }
+  if (parareal.criticalEvaluations() >= parareal.evaluations()) {
+    std::cerr << "Convergence: no shorter critical path" << std::endl;
+    ok = false;
+  }
+
+  static const unsigned int threads[] = { 1, 2, 4 };
+  for (std::size_t t = 0; t < sizeof(threads)/sizeof(threads[0]); ++t) {
+    vZ::ThreadPool pool(threads[t]);
+    vZ::Parareal<Coarse, Fine> parallel(coarse(), fine());
+    parallel.slices(32).tol(1e-8).threadPool(&pool).x(0.0);
+    parallel.integrate(initial(), 20.0);
+
+    if (distance(parallel.y(), parareal.y()) != 0.0
+        || parallel.iterations() != parareal.iterations()) {
+      std::cerr << "Convergence: differs on " << threads[t] << " threads"
+                << std::endl;
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+// maxIterations() bounds the iterations
+bool
+checkMaxIterations()
+{
+  vZ::Parareal<Coarse, Fine> parareal(coarse(), fine());
+  parareal.slices(16).tol(0.0).maxIterations(2).x(0.0);
+  parareal.integrate(initial(), 20.0);
+
+  if (parareal.iterations() != 2) {
+    std::cerr << "Iterations:  ran " << parareal.iterations() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int
+main()
+{
+  bool ok = checkExact();
+  ok = checkConvergence() && ok;
+  ok = checkMaxIterations() && ok;
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
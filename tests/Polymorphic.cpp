@@ -0,0 +1,76 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+// y' = x*y (y == C*exp(x^2/2))
+double
+f(double x, double y)
+{
+  return x*y;
+}
+
+// Integrate through the virtual interface
+void
+integrate(vZ::Integrator& integrator, double x_final)
+{
+  integrator.integrate(x_final);
+}
+
+int
+main()
+{
+  vZ::EulerIntegrator euler(f), eulerStatic(f);
+  euler.y(1.0).x(0.0).h(0.01);
+  eulerStatic.y(1.0).x(0.0).h(0.01);
+
+  vZ::DP45Integrator dp45(f), dp45Static(f);
+  dp45.tol(1e-6).y(1.0).x(0.0).h(0.06);
+  dp45Static.tol(1e-6).y(1.0).x(0.0).h(0.06);
+
+  vZ::Integrator* integrators[] = { &euler, &dp45 };
+  for (std::size_t i = 0; i < sizeof(integrators)/sizeof(*integrators); ++i) {
+    integrate(*integrators[i], 2.0);
+  }
+  eulerStatic.integrate(2.0);
+  dp45Static.integrate(2.0);
+
+  std::cout << std::setprecision(10)
+            << "Euler:      " << euler.y() << std::endl
+            << "Static:     " << eulerStatic.y() << std::endl
+            << "Iterations: " << euler.iterations() << std::endl
+            << "DP45:       " << dp45.y() << std::endl
+            << "Static:     " << dp45Static.y() << std::endl
+            << "Iterations: " << dp45.iterations() << std::endl;
+
+  if (euler.y() != eulerStatic.y()
+      || euler.iterations() != eulerStatic.iterations()
+      || dp45.y() != dp45Static.y()
+      || dp45.iterations() != dp45Static.iterations()
+      || std::abs(dp45.y() - std::exp(2.0)) > 1.0e-5) {
+    std::cerr << "Virtual and static integration differ" << std::endl;
+    return EXIT_FAILURE;
+  } else {
+    return EXIT_SUCCESS;
+  }
+}
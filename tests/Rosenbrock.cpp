@@ -0,0 +1,202 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// y' = -10^6*(y - cos(x)) - sin(x) (y == cos(x) + C*exp(-10^6*x))
+//
+// Explicit methods need h < 3.3e-6 here for stability alone
+double
+f(double x, double y)
+{
+  return -1.0e6*(y - std::cos(x)) - std::sin(x);
+}
+
+// Robertson's chemical kinetics problem
+typedef vZ::EquationSystem<3> System;
+
+System
+robertson(double x, const System& y)
+{
+  System r;
+  r[0] = -0.04*y[0] + 1.0e4*y[1]*y[2];
+  r[1] =  0.04*y[0] - 1.0e4*y[1]*y[2] - 3.0e7*y[1]*y[1];
+  r[2] =  3.0e7*y[1]*y[1];
+  return r;
+}
+
+void
+robertsonJacobian(double x, const System& y, vZ::Matrix<3>& dfdy,
+                  System& dfdx)
+{
+  dfdy(0, 0) = -0.04;
+  dfdy(0, 1) =  1.0e4*y[2];
+  dfdy(0, 2) =  1.0e4*y[1];
+  dfdy(1, 0) =  0.04;
+  dfdy(1, 1) = -1.0e4*y[2] - 6.0e7*y[1];
+  dfdy(1, 2) = -1.0e4*y[1];
+  dfdy(2, 1) =  6.0e7*y[1];
+}
+
+// n copies of the scalar problem, with stiffness ranging from 1 to 10^4
+typedef vZ::DynamicEquationSystem<> Dynamic;
+
+Dynamic
+g(double x, const Dynamic& y)
+{
+  Dynamic r(y.size());
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    double lambda = std::pow(10.0, 4.0*i/(y.size() - 1));
+    r[i] = -lambda*(y[i] - std::cos(x)) - std::sin(x);
+  }
+  return r;
+}
+
+bool
+check(const char* name, double error, double bound, unsigned int iterations,
+      unsigned int maxIterations)
+{
+  std::cout << std::setprecision(10)
+            << name << ":" << std::endl
+            << "  Error:      " << error << std::endl
+            << "  Iterations: " << iterations << std::endl;
+
+  if (error > bound || !std::isfinite(error)) {
+    std::cerr << "  Error is more than " << bound << std::endl;
+    return false;
+  }
+  if (iterations > maxIterations) {
+    std::cerr << "  Too many iterations" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+template <typename Integrator>
+bool
+testScalar(const char* name, double bound, unsigned int maxIterations)
+{
+  Integrator integrator(f);
+  integrator.tol(1e-6)
+            .y(1.0)
+            .x(0.0)
+            .h(0.0);
+  integrator.integrate(10.0);
+
+  double error = std::abs(integrator.y() - std::cos(10.0));
+  return check(name, error, bound, integrator.iterations(), maxIterations);
+}
+
+// Reference solution at x == 40
+static const double reference[3] = {
+  0.7158270687193135, 9.185534764557526e-6, 0.2841637457161212
+};
+
+template <typename Integrator>
+bool
+testRobertson(Integrator& integrator, const char* name, double bound,
+              unsigned int maxIterations)
+{
+  System y;
+  y[0] = 1.0;
+  y[1] = 0.0;
+  y[2] = 0.0;
+
+  std::vector<double> atol(3, 1e-8);
+  atol[1] = 1e-12;
+  integrator.rtol(1e-6)
+            .atol(atol)
+            .y(y)
+            .x(0.0)
+            .h(1e-6);
+  integrator.integrate(40.0);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < 3; ++i) {
+    error = std::max(error,
+                     std::abs(integrator.y()[i] - reference[i])/reference[i]);
+  }
+  return check(name, error, bound, integrator.iterations(), maxIterations);
+}
+
+template <typename Integrator>
+bool
+testDynamic(const char* name, double bound, unsigned int maxIterations)
+{
+  Dynamic y(20, 1.0);
+
+  Integrator integrator(g);
+  integrator.tol(1e-6)
+            .y(y)
+            .x(0.0)
+            .h(0.0);
+  integrator.integrate(10.0);
+
+  double error = 0.0;
+  for (std::size_t i = 0; i < y.size(); ++i) {
+    error = std::max(error, std::abs(integrator.y()[i] - std::cos(10.0)));
+  }
+  return check(name, error, bound, integrator.iterations(), maxIterations);
+}
+
+int
+main()
+{
+  bool ret = true;
+
+  ret &= testScalar<vZ::ROS3PIntegrator>("ROS3P", 1e-6, 3000);
+  ret &= testScalar<vZ::RODAS4Integrator>("RODAS4", 1e-6, 400);
+
+  // The finite-difference Jacobian, and the exact one
+  typedef vZ::GenericROS3PIntegrator<System> ROS3P;
+  typedef vZ::GenericRODAS4Integrator<System> RODAS4;
+  ROS3P ros3p(robertson);
+  ROS3P ros3pJ(robertson, robertsonJacobian);
+  RODAS4 rodas4(robertson);
+  RODAS4 rodas4J(robertson, robertsonJacobian);
+  ret &= testRobertson(ros3p, "ROS3P, Robertson", 1e-5, 800);
+  ret &= testRobertson(ros3pJ, "ROS3P, Robertson, Jacobian", 1e-5, 800);
+  ret &= testRobertson(rodas4, "RODAS4, Robertson", 1e-5, 120);
+  ret &= testRobertson(rodas4J, "RODAS4, Robertson, Jacobian", 1e-5, 120);
+
+  // The exact Jacobian saves the finite differences
+  if (rodas4J.evaluations() >= rodas4.evaluations()) {
+    std::cerr << "The Jacobian didn't save any evaluations" << std::endl;
+    ret = false;
+  }
+  if (rodas4J.jacobians() != rodas4J.iterations()
+      || rodas4J.factorizations()
+         != rodas4J.iterations() + rodas4J.rejections()) {
+    std::cerr << "Wrong Jacobian or factorization count" << std::endl;
+    ret = false;
+  }
+
+  ret &= testDynamic<vZ::GenericROS3PIntegrator<Dynamic> >("ROS3P, dynamic",
+                                                           1e-6, 3500);
+  ret &= testDynamic<vZ::GenericRODAS4Integrator<Dynamic> >("RODAS4, dynamic",
+                                                            1e-6, 600);
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
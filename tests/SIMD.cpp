@@ -0,0 +1,147 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+
+#include "vZ.hpp"
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+// Compare the SIMD kernels for double against the generic loops, for sizes
+// that exercise both the vector and the scalar remainder paths
+
+static const std::size_t N = 19;
+
+int
+main()
+{
+  bool ret = true;
+
+  double x[N], y[N];
+  for (std::size_t i = 0; i < N; ++i) {
+    x[i] = std::sin(i + 1.0);
+    y[i] = std::cos(i + 1.0);
+  }
+  x[N/2] = -2.0; // The largest magnitude, with a negative sign
+
+  for (std::size_t n = 1; n <= N; ++n) {
+    double simd[N], generic[N];
+    vZ::simdCopy(simd, y, n);
+    vZ::simdCopy<double>(generic, y, n);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (simd[i] != y[i] || generic[i] != y[i]) {
+        std::cerr << "copy mismatch: n = " << n << ", i = " << i << std::endl;
+        ret = false;
+      }
+    }
+
+    vZ::simdAxpy(simd, 0.5, x, n);
+    vZ::simdAxpy<double, double>(generic, 0.5, x, n);
+    vZ::simdScale(simd, 3.0, n);
+    vZ::simdScale<double, double>(generic, 3.0, n);
+    for (std::size_t i = 0; i < n; ++i) {
+      if (simd[i] != generic[i]) {
+        std::cerr << "axpy/scale mismatch: n = " << n << ", i = " << i
+                  << std::endl;
+        ret = false;
+      }
+    }
+
+    double dot = vZ::simdDot(x, y, n);
+    double genericDot = vZ::simdDot<double>(x, y, n);
+    if (std::abs(dot - genericDot) > 1e-14) {
+      std::cerr << "dot mismatch: n = " << n << ": " << dot << " != "
+                << genericDot << std::endl;
+      ret = false;
+    }
+
+    if (vZ::simdMaxAbs(x, n) != vZ::simdMaxAbs<double>(x, n)
+        || vZ::simdMaxAbsDifference(x, y, n)
+             != vZ::simdMaxAbsDifference<double>(x, y, n)) {
+      std::cerr << "max-abs mismatch: n = " << n << std::endl;
+      ret = false;
+    }
+
+    double atol[N], rtol[N];
+    for (std::size_t i = 0; i < n; ++i) {
+      atol[i] = 1e-3*(i + 1.0);
+      rtol[i] = 1e-2/(i + 1.0);
+    }
+    double squares = vZ::simdWeightedSquares(x, y, x, atol, rtol, n);
+    double genericSquares
+      = vZ::simdWeightedSquares<double>(x, y, x, atol, rtol, n);
+    if (std::abs(squares - genericSquares) > 1e-14*genericSquares) {
+      std::cerr << "weighted squares mismatch: n = " << n << ": " << squares
+                << " != " << genericSquares << std::endl;
+      ret = false;
+    }
+  }
+
+  // The container operators which use the kernels
+  vZ::EquationSystem<N> es, es2;
+  for (std::size_t i = 0; i < N; ++i) {
+    es[i] = x[i];
+    es2[i] = y[i];
+  }
+  es += 2.0*es2;
+  es -= 0.5*es2;
+  es *= 2.0;
+  for (std::size_t i = 0; i < N; ++i) {
+    double expected = x[i];
+    expected += 2.0*y[i];
+    expected -= 0.5*y[i];
+    expected *= 2.0;
+    if (es[i] != expected) {
+      std::cerr << "EquationSystem mismatch: i = " << i << std::endl;
+      ret = false;
+    }
+  }
+  if (abs(es - es2) != vZ::simdMaxAbsDifference<double>(es.data(),
+                                                         es2.data(), N)) {
+    std::cerr << "EquationSystem max-norm mismatch" << std::endl;
+    ret = false;
+  }
+
+  vZ::Vector<3> v(1.0, 2.0, 3.0), w(4.0, 5.0, 6.0);
+  v += 2.0*w;
+  if (dot(v, w) != 9.0*4.0 + 12.0*5.0 + 15.0*6.0) {
+    std::cerr << "Vector dot mismatch" << std::endl;
+    ret = false;
+  }
+
+#if defined(__cpp_aligned_new)
+  // Storage which is a multiple of the SIMD width is aligned to it
+  std::size_t alignment
+    = vZ::SIMDAlignment<sizeof(vZ::EquationSystem<8>)>::s_alignment;
+  if (alignof(vZ::EquationSystem<8>) < alignment) {
+    std::cerr << "EquationSystem<8> is not aligned to " << alignment
+              << " bytes" << std::endl;
+    ret = false;
+  }
+#endif
+
+  if (ret) {
+    std::cout << "SIMD kernels agree with the generic loops (SIMD width: "
+              << VZ_SIMD_ALIGNMENT << " bytes)" << std::endl;
+    return EXIT_SUCCESS;
+  } else {
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,136 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+
+typedef vZ::EquationSystem<2> Y;
+
+// The Van der Pol oscillator with mu == 1000:
+//   y'' == mu*(1 - y^2)*y' - y
+// It's stiff along its slow branches, but not during the fast transitions
+// between them.
+Y
+vanDerPol(double x, const Y& y)
+{
+  Y r;
+  r[0] = y[1];
+  r[1] = 1000.0*(1.0 - y[0]*y[0])*y[1] - y[0];
+  return r;
+}
+
+// y' = x*y (y == C*exp(x^2/2)), which isn't stiff at all
+double
+f(double x, double y)
+{
+  return x*y;
+}
+
+// Without stiffness, the steps must be exactly DP45's, except that the
+// compiler may contract operations into FMAs differently in each case
+#if defined(__FMA__)
+static const double tolerance = 1e-12;
+#else
+static const double tolerance = 0.0;
+#endif
+
+int
+main()
+{
+  bool ret = true;
+
+  Y y0;
+  y0[0] = 2.0;
+  y0[1] = 0.0;
+
+  vZ::GenericSwitchingIntegrator<Y> integrator(vanDerPol);
+  integrator.tol(1e-6).y(y0).x(0.0).h(0.0);
+  integrator.integrate(3000.0);
+
+  // A tightly integrated reference
+  vZ::GenericRODAS4Integrator<Y> reference(vanDerPol);
+  reference.tol(1e-10).y(y0).x(0.0).h(0.0);
+  reference.integrate(3000.0);
+
+  double error = std::max(std::abs(integrator.y()[0] - reference.y()[0]),
+                          std::abs(integrator.y()[1] - reference.y()[1]));
+
+  std::cout << std::setprecision(10)
+            << "Van der Pol:" << std::endl
+            << "  Error:             " << error << std::endl
+            << "  Iterations:        " << integrator.iterations() << std::endl
+            << "  Evaluations:       " << integrator.evaluations()
+            << std::endl
+            << "  Switches to stiff: " << integrator.stiffSwitches()
+            << std::endl
+            << "  Switches back:     " << integrator.nonstiffSwitches()
+            << std::endl
+            << "  Stiff:             " << integrator.stiffSteps()
+            << " steps over " << integrator.stiffLength() << std::endl
+            << "  Non-stiff:         " << integrator.nonstiffSteps()
+            << " steps over " << integrator.nonstiffLength() << std::endl;
+
+  if (error > 5e-5 || !std::isfinite(error)) {
+    std::cerr << "  Error is too large" << std::endl;
+    ret = false;
+  }
+  // DP45 alone takes over a million steps
+  if (integrator.iterations() > 1000) {
+    std::cerr << "  Too many iterations" << std::endl;
+    ret = false;
+  }
+  // Both slow branches are stiff, and there's a transition between them
+  if (integrator.stiffSwitches() < 2 || integrator.nonstiffSwitches() < 1) {
+    std::cerr << "  Too few switches" << std::endl;
+    ret = false;
+  }
+  if (integrator.stiffSteps() + integrator.nonstiffSteps()
+        != integrator.iterations()
+      || std::abs(integrator.stiffLength() + integrator.nonstiffLength()
+                  - 3000.0) > 1e-9) {
+    std::cerr << "  Regime counters don't add up" << std::endl;
+    ret = false;
+  }
+
+  // Without stiffness, it's just DP45
+  vZ::SwitchingIntegrator nonstiff(f);
+  nonstiff.tol(1e-6).y(1.0).x(0.0).h(0.06);
+  nonstiff.integrate(2.0);
+
+  vZ::DP45Integrator dp45(f);
+  dp45.tol(1e-6).y(1.0).x(0.0).h(0.06);
+  dp45.integrate(2.0);
+
+  std::cout << "exp(x^2/2):" << std::endl
+            << "  Iterations:        " << nonstiff.iterations() << std::endl
+            << "  Switches to stiff: " << nonstiff.stiffSwitches()
+            << std::endl;
+
+  if (nonstiff.stiffSwitches() != 0
+      || std::abs(nonstiff.y() - dp45.y()) > tolerance*std::abs(dp45.y())
+      || nonstiff.evaluations() != dp45.evaluations()) {
+    std::cerr << "  Doesn't match DP45" << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}
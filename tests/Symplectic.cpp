@@ -0,0 +1,220 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+// The Kepler problem in three dimensions, with eccentricity 0.5 and period
+// 2*pi, integrated by the symplectic methods with fixed steps
+typedef vZ::Vector<3> V;
+
+static const double pi = 3.14159265358979323846;
+static const double e  = 0.5;
+
+V
+velocity(double, const V& p)
+{
+  return p;
+}
+
+V
+force(double, const V& q)
+{
+  double r = std::sqrt(dot(q, q));
+  return -q/(r*r*r);
+}
+
+double
+energy(const V& q, const V& p)
+{
+  return dot(p, p)/2.0 - 1.0/std::sqrt(dot(q, q));
+}
+
+// The largest energy error seen on a grid of output points
+class EnergyError
+{
+public:
+  EnergyError(double* max) : m_max(max) { }
+
+  template <typename Y>
+  void operator()(double, const Y& y)
+  {
+    *m_max = std::max(*m_max, std::abs(energy(y.q(), y.p()) + 0.5));
+  }
+
+private:
+  double* m_max;
+};
+
+vZ::PhaseSpace<V>
+initial()
+{
+  return vZ::PhaseSpace<V>(V(1.0 - e, 0.0, 0.0),
+                           V(0.0, std::sqrt((1.0 + e)/(1.0 - e)), 0.0));
+}
+
+// Integrate for one period in n steps, and return the distance from the
+// starting point
+template <typename Integrator>
+double
+periodError(unsigned int n)
+{
+  Integrator integrator(velocity, force);
+  integrator.y(initial()).x(0.0).h(2.0*pi/n);
+  integrator.integrate(2.0*pi);
+
+  V dq = integrator.q() - initial().q(), dp = integrator.p() - initial().p();
+  return std::sqrt(dot(dq, dq) + dot(dp, dp));
+}
+
+// Check that the error falls with the order of the method
+template <typename Integrator>
+bool
+checkOrder(const char* name, unsigned int order, unsigned int n)
+{
+  double coarse = periodError<Integrator>(n);
+  double fine = periodError<Integrator>(2*n);
+  double observed = std::log(coarse/fine)/std::log(2.0);
+
+  std::cout << std::setprecision(4)
+            << name << ": error " << coarse << " with " << n
+            << " steps, " << fine << " with " << 2*n
+            << "; order " << observed << std::endl;
+
+  if (!(observed > order - 0.3 && observed < order + 1.0)) {
+    std::cerr << name << ": expected order " << order << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Check that the energy error stays bounded over 1000 periods, at a step
+// size for which it grows without bound for the non-symplectic methods
+template <typename Integrator>
+bool
+checkEnergy(const char* name, unsigned int n, double tolerance)
+{
+  Integrator integrator(velocity, force);
+  integrator.y(initial()).x(0.0).h(2.0*pi/n);
+
+  double first = 0.0, last = 0.0;
+  integrator.integrate(20.0*pi, 0.1, EnergyError(&first));
+  integrator.integrate(1980.0*pi);
+  integrator.integrate(2000.0*pi, 0.1, EnergyError(&last));
+
+  std::cout << std::setprecision(4)
+            << name << ": energy error " << first
+            << " over the first 10 periods, " << last
+            << " over the last 10; " << integrator.evaluations()
+            << " evaluations" << std::endl;
+
+  bool ok = true;
+  if (!(first <= tolerance && last <= 1.5*first)) {
+    std::cerr << name << ": energy drifted" << std::endl;
+    ok = false;
+  }
+  if (integrator.h() != 2.0*pi/n) {
+    std::cerr << name << ": h changed to " << integrator.h() << std::endl;
+    ok = false;
+  }
+  return ok;
+}
+
+// The harmonic oscillator q' == p, p' == -q, through the scalar aliases
+double
+oscillatorVelocity(double, double p)
+{
+  return p;
+}
+
+double
+oscillatorForce(double, double q)
+{
+  return -q;
+}
+
+bool
+checkScalar()
+{
+  vZ::Yoshida6Integrator integrator(oscillatorVelocity, oscillatorForce);
+  integrator.y(vZ::PhaseSpace<double>(1.0, 0.0)).x(0.0).h(0.1);
+  integrator.integrate(200.0*pi);
+
+  double q = integrator.q(), p = integrator.p();
+  double error = std::abs((q*q + p*p)/2.0 - 0.5);
+  std::cout << "Oscillator: energy error " << error << " after "
+            << integrator.iterations() << " steps" << std::endl;
+
+  if (!(error <= 1e-10)) {
+    std::cerr << "Oscillator: energy drifted" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Without h, integrating must fail rather than take steps of 0 forever
+bool
+checkNoStep()
+{
+  vZ::Yoshida4Integrator integrator(oscillatorVelocity, oscillatorForce);
+  integrator.y(vZ::PhaseSpace<double>(1.0, 0.0)).x(0.0);
+  try {
+    integrator.integrate(1.0);
+  } catch (const std::invalid_argument&) {
+    return true;
+  }
+
+  std::cerr << "Yoshida4: accepted h == 0" << std::endl;
+  return false;
+}
+
+typedef V (*Velocity)(double, const V&);
+typedef V (*Force)(double, const V&);
+
+int
+main()
+{
+  bool ok = true;
+
+  ok = checkOrder<vZ::GenericVerletIntegrator<V> >("Verlet", 2, 1000) && ok;
+  ok = checkOrder<vZ::GenericYoshida4Integrator<V> >("Yoshida4", 4, 400)
+       && ok;
+  ok = checkOrder<vZ::GenericYoshida6Integrator<V> >("Yoshida6", 6, 200)
+       && ok;
+  ok = checkOrder<vZ::GenericYoshida8Integrator<V> >("Yoshida8", 8, 100)
+       && ok;
+  ok = checkOrder<vZ::GenericBlanesMoanIntegrator<V> >("BlanesMoan", 4, 200)
+       && ok;
+
+  ok = checkEnergy<vZ::GenericVerletIntegrator<V, V, Velocity, Force> >(
+         "Verlet", 200, 1e-3) && ok;
+  ok = checkEnergy<vZ::GenericYoshida4Integrator<V, V, Velocity, Force> >(
+         "Yoshida4", 100, 2e-4) && ok;
+  ok = checkEnergy<vZ::GenericBlanesMoanIntegrator<V, V, Velocity, Force> >(
+         "BlanesMoan", 50, 2e-5) && ok;
+
+  ok = checkScalar() && ok;
+  ok = checkNoStep() && ok;
+
+  return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+/*************************************************************************
+ * Copyright (C) 2010 Tavian Barnes <tavianator@gmail.com>               *
+ *                                                                       *
+ * This file is part of The vZ Test Suite.                               *
+ *                                                                       *
+ * The vZ Test Suite is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as        *
+ * published by the Free Software Foundation; either version 3 of the    *
+ * License, or (at your option) any later version.                       *
+ *                                                                       *
+ * The vZ Test Suite is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU     *
+ * General Public License for more details.                              *
+ *                                                                       *
+ * You should have received a copy of the GNU General Public License     *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *************************************************************************/
+#include "vZ.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// y[0]' = -y[0] (y[0] == exp(-x)), and y[1]'' = -400*y[1]
+// (y[1] == cos(20*x)).  y[0] must be accurate, but y[1] only to a few
+// digits, so with a single tolerance the fast component over-resolves the
+// whole system.
+template <typename Y>
+Y
+f(double x, const Y& y)
+{
+  Y dydx(y);
+  dydx[0] = -y[0];
+  dydx[1] = y[2];
+  dydx[2] = -400.0*y[1];
+  return dydx;
+}
+
+template <typename Y>
+Y
+initial(Y y0)
+{
+  y0[0] = 1.0;
+  y0[1] = 1.0;
+  y0[2] = 0.0;
+  return y0;
+}
+
+template <typename Integrator>
+bool
+check(const char* name, const typename Integrator::State& y0)
+{
+  typedef typename Integrator::State Y;
+
+  std::vector<double> atol(3, 1e-4), rtol(3, 1e-4);
+  atol[0] = 1e-10;
+  rtol[0] = 1e-10;
+
+  Integrator single(f<Y>), vector(f<Y>);
+  single.tol(1e-10).y(initial(y0)).x(0.0);
+  vector.atol(atol).rtol(rtol).y(initial(y0)).x(0.0);
+  single.integrate(5.0);
+  vector.integrate(5.0);
+
+  double error0 = std::abs(vector.y()[0] - std::exp(-5.0));
+  double error1 = std::abs(vector.y()[1] - std::cos(100.0));
+
+  std::cout << name << ":" << std::endl
+            << "  Single tolerance:  " << single.iterations() << " steps"
+            << std::endl
+            << "  Per-component:     " << vector.iterations() << " steps"
+            << std::endl
+            << "  Errors:            " << error0 << ", " << error1
+            << std::endl;
+
+  bool ret = true;
+  if (!(vector.iterations() < single.iterations()/4)) {
+    std::cerr << name << ": per-component tolerances didn't save steps"
+              << std::endl;
+    ret = false;
+  }
+  if (!(error0 < 1e-8 && error1 < 1e-2)) {
+    std::cerr << name << ": tolerances not met" << std::endl;
+    ret = false;
+  }
+  if (vector.atols() != atol || vector.rtols() != rtol
+      || !single.atols().empty()) {
+    std::cerr << name << ": atols()/rtols() wrong" << std::endl;
+    ret = false;
+  }
+  return ret;
+}
+
+int
+main()
+{
+  typedef vZ::EquationSystem<3> Y;
+  typedef vZ::DynamicEquationSystem<double> DynamicY;
+  typedef vZ::GenericDP45Integrator<Y, Y (*)(double, const Y&)> DP45;
+  typedef vZ::GenericDP45Integrator<DynamicY,
+                                    DynamicY (*)(double, const DynamicY&)>
+    DynamicDP45;
+
+  Y zero;
+  for (std::size_t i = 0; i < 3; ++i) {
+    zero[i] = 0.0;
+  }
+
+  bool ret = true;
+  ret = check<DP45>("EquationSystem", zero) && ret;
+  ret = check<DynamicDP45>("DynamicEquationSystem", DynamicY(3)) && ret;
+
+  // The fused norm agrees with computing it a component at a time
+  Y x, y, u;
+  double atol[3] = { 1e-6, 1e-3, 1.0 }, rtol[3] = { 1e-6, 1e-2, 0.5 };
+  double sum = 0.0;
+  for (std::size_t i = 0; i < 3; ++i) {
+    x[i] = std::sin(i + 1.0);
+    y[i] = x[i] + 1e-4*(i + 1.0);
+    u[i] = -2.0*x[i];
+
+    double e = std::abs(x[i] - y[i])
+               /(atol[i] + std::max(std::abs(u[i]), std::abs(x[i]))*rtol[i]);
+    sum += e*e;
+  }
+  Y e = x - y;
+  double norm = vZ::weightedRMS(e, u, x, atol, rtol);
+  if (std::abs(norm - std::sqrt(sum/3.0)) > 1e-14*norm) {
+    std::cerr << "weightedRMS() == " << norm << ", expected "
+              << std::sqrt(sum/3.0) << std::endl;
+    ret = false;
+  }
+
+  return ret ? EXIT_SUCCESS : EXIT_FAILURE;
+}